@@ -12,7 +12,7 @@ CREATE TABLE events (
     status event_status DEFAULT 'active',
     start_date TIMESTAMP WITH TIME ZONE,
     end_date TIMESTAMP WITH TIME ZONE,
-    created_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
+    created_at TIMESTAMP WITH TIME ZONE NOT NULL DEFAULT CURRENT_TIMESTAMP,
     updated_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
     
     CONSTRAINT events_name_length CHECK (char_length(name) >= 1),
@@ -25,7 +25,7 @@ CREATE TABLE expenses (
     payer_id UUID NOT NULL REFERENCES users(id) ON DELETE CASCADE,
     amount DECIMAL(10,2) NOT NULL,
     description VARCHAR(255) NOT NULL,
-    expense_date TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
+    expense_date TIMESTAMP WITH TIME ZONE NOT NULL DEFAULT CURRENT_TIMESTAMP,
     split_type expense_split_type DEFAULT 'equal',
     receipt_url TEXT,
     created_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
@@ -42,7 +42,7 @@ CREATE TABLE participants (
     share_percentage DECIMAL(5,2),
     custom_amount DECIMAL(10,2),
     status participant_status DEFAULT 'active',
-    joined_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
+    joined_at TIMESTAMP WITH TIME ZONE NOT NULL DEFAULT CURRENT_TIMESTAMP,
     updated_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
     
     CONSTRAINT participants_unique_event_user UNIQUE (event_id, user_id),
@@ -50,19 +50,42 @@ CREATE TABLE participants (
     CONSTRAINT participants_custom_amount_positive CHECK (custom_amount IS NULL OR custom_amount >= 0)
 );
 
-CREATE INDEX idx_events_creator_id ON events(creator_id);
+-- Net position of every member (creator + active participants) per event,
+-- maintained by the bill service in the same transaction as the write
+CREATE TABLE event_balances (
+    event_id UUID NOT NULL REFERENCES events(id) ON DELETE CASCADE,
+    user_id UUID NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    balance_cents BIGINT NOT NULL DEFAULT 0,
+    version BIGINT NOT NULL DEFAULT 1,
+    updated_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,
+    
+    PRIMARY KEY (event_id, user_id)
+);
+
+-- Change counter per event, bumped in the same transaction as any write that
+-- can change its balances; versions cached settlement responses
+CREATE TABLE event_versions (
+    event_id UUID PRIMARY KEY REFERENCES events(id) ON DELETE CASCADE,
+    version BIGINT NOT NULL DEFAULT 0
+);
+
+-- Listings page by (sort timestamp, id) keysets; see prepared_statements.cpp
+CREATE INDEX idx_events_creator_created ON events(creator_id, created_at DESC, id DESC);
 CREATE INDEX idx_events_status ON events(status);
 CREATE INDEX idx_events_type ON events(event_type);
 CREATE INDEX idx_events_dates ON events(start_date, end_date);
 
-CREATE INDEX idx_expenses_event_id ON expenses(event_id);
+CREATE INDEX idx_expenses_event_date ON expenses(event_id, expense_date DESC, id DESC);
 CREATE INDEX idx_expenses_payer_id ON expenses(payer_id);
 CREATE INDEX idx_expenses_date ON expenses(expense_date);
 
 CREATE INDEX idx_participants_event_id ON participants(event_id);
-CREATE INDEX idx_participants_user_id ON participants(user_id);
+CREATE INDEX idx_participants_active_joined ON participants(event_id, joined_at, id) WHERE status = 'active';
+CREATE INDEX idx_participants_user_event ON participants(user_id, event_id);
 CREATE INDEX idx_participants_status ON participants(status);
 
+CREATE INDEX idx_event_balances_user ON event_balances(user_id);
+
 CREATE TRIGGER update_events_updated_at BEFORE UPDATE ON events 
     FOR EACH ROW EXECUTE FUNCTION update_updated_at_column();
 
@@ -17,6 +17,9 @@ const EventDetailsScreen = ({ navigation, route }) => {
   const [settlements, setSettlements] = useState(null);
   const [loading, setLoading] = useState(!isNew);
   const [refreshing, setRefreshing] = useState(false);
+  const [expensesCursor, setExpensesCursor] = useState(null);
+  const [participantsCursor, setParticipantsCursor] = useState(null);
+  const [loadingMore, setLoadingMore] = useState(false);
   const fadeAnim = new Animated.Value(0);
 
   useEffect(() => {
@@ -38,8 +41,15 @@ const EventDetailsScreen = ({ navigation, route }) => {
         eventsAPI.getSettlements(event.id)
       ]);
 
-      if (expensesRes.success) setExpenses(expensesRes.data.expenses || []);
-      if (participantsRes.success) setParticipants(participantsRes.data.participants || []);
+      // First pages only; further expenses load as the list is scrolled
+      if (expensesRes.success) {
+        setExpenses(expensesRes.data.expenses || []);
+        setExpensesCursor(expensesRes.data.next_cursor || null);
+      }
+      if (participantsRes.success) {
+        setParticipants(participantsRes.data.participants || []);
+        setParticipantsCursor(participantsRes.data.next_cursor || null);
+      }
       if (settlementsRes.success) setSettlements(settlementsRes.data);
     } catch (error) {
       Alert.alert('Error', 'Failed to load event data');
@@ -49,6 +59,31 @@ const EventDetailsScreen = ({ navigation, route }) => {
     }
   };
 
+  const loadMoreExpenses = async () => {
+    if (!expensesCursor || loadingMore || refreshing) {
+      return;
+    }
+
+    setLoadingMore(true);
+    try {
+      const response = await eventsAPI.getExpenses(event.id, expensesCursor);
+      if (response.success) {
+        setExpenses((current) => [...current, ...(response.data.expenses || [])]);
+        setExpensesCursor(response.data.next_cursor || null);
+      }
+    } finally {
+      setLoadingMore(false);
+    }
+  };
+
+  // ScrollView has no onEndReached; fetch the next page near the bottom
+  const handleScroll = ({ nativeEvent }) => {
+    const { layoutMeasurement, contentOffset, contentSize } = nativeEvent;
+    if (layoutMeasurement.height + contentOffset.y >= contentSize.height - layoutMeasurement.height / 2) {
+      loadMoreExpenses();
+    }
+  };
+
   const handleRefresh = () => {
     setRefreshing(true);
     loadEventData();
@@ -147,6 +182,8 @@ const EventDetailsScreen = ({ navigation, route }) => {
         refreshControl={
           <RefreshControl refreshing={refreshing} onRefresh={handleRefresh} />
         }
+        onScroll={handleScroll}
+        scrollEventThrottle={200}
         showsVerticalScrollIndicator={false}
       >
         {/* Summary Card */}
@@ -154,7 +191,9 @@ const EventDetailsScreen = ({ navigation, route }) => {
           <View style={styles.summaryHeader}>
             <View>
               <Text style={styles.totalAmount}>${totalExpenses.toFixed(2)}</Text>
-              <Text style={styles.totalLabel}>Total Spent</Text>
+              <Text style={styles.totalLabel}>
+                {expensesCursor ? 'Spent so far' : 'Total Spent'}
+              </Text>
             </View>
             <View style={styles.balanceInfo}>
               <Text style={[
@@ -172,7 +211,7 @@ const EventDetailsScreen = ({ navigation, route }) => {
           <View style={styles.participantInfo}>
             <Ionicons name="people" size={16} color="#718096" />
             <Text style={styles.participantText}>
-              {participants.length + 1} people
+              {participants.length + 1}{participantsCursor ? '+' : ''} people
             </Text>
           </View>
         </Animated.View>
@@ -183,7 +222,9 @@ const EventDetailsScreen = ({ navigation, route }) => {
         <View style={styles.section}>
           <View style={styles.sectionHeader}>
             <Text style={styles.sectionTitle}>Expenses</Text>
-            <Text style={styles.expenseCount}>{expenses.length}</Text>
+            <Text style={styles.expenseCount}>
+              {expenses.length}{expensesCursor ? '+' : ''}
+            </Text>
           </View>
           
           {expenses.length === 0 ? (
@@ -197,6 +238,7 @@ const EventDetailsScreen = ({ navigation, route }) => {
           ) : (
             expenses.map(renderExpenseItem)
           )}
+          {loadingMore && <Text style={styles.loadingMoreText}>Loading more expenses...</Text>}
         </View>
 
         {/* Settlement Button */}
@@ -395,6 +437,12 @@ const styles = StyleSheet.create({
     color: '#718096',
     marginTop: 12,
   },
+  loadingMoreText: {
+    fontSize: 14,
+    color: '#718096',
+    textAlign: 'center',
+    paddingVertical: 12,
+  },
   emptyState: {
     alignItems: 'center',
     paddingVertical: 32,
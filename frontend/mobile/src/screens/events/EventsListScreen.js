@@ -19,12 +19,16 @@ const EventsListScreen = ({ navigation }) => {
   const [events, setEvents] = useState([]);
   const [loading, setLoading] = useState(true);
   const [refreshing, setRefreshing] = useState(false);
+  const [nextCursor, setNextCursor] = useState(null);
+  const [loadingMore, setLoadingMore] = useState(false);
 
+  // First page only; the rest is fetched by loadMoreEvents as the list scrolls
   const loadEvents = async () => {
     try {
       const response = await eventsAPI.getEvents();
       if (response.success) {
         setEvents(response.data.events || []);
+        setNextCursor(response.data.next_cursor || null);
       } else {
         Alert.alert('Error', response.error);
       }
@@ -49,6 +53,23 @@ const EventsListScreen = ({ navigation }) => {
     }, [loading])
   );
 
+  const loadMoreEvents = async () => {
+    if (!nextCursor || loadingMore || refreshing) {
+      return;
+    }
+
+    setLoadingMore(true);
+    try {
+      const response = await eventsAPI.getEvents(nextCursor);
+      if (response.success) {
+        setEvents((current) => [...current, ...(response.data.events || [])]);
+        setNextCursor(response.data.next_cursor || null);
+      }
+    } finally {
+      setLoadingMore(false);
+    }
+  };
+
   const handleRefresh = () => {
     setRefreshing(true);
     loadEvents();
@@ -126,6 +147,11 @@ const EventsListScreen = ({ navigation }) => {
           />
         }
         ListEmptyComponent={renderEmptyState}
+        onEndReached={loadMoreEvents}
+        onEndReachedThreshold={0.5}
+        ListFooterComponent={
+          loadingMore ? <Text style={styles.loadingMoreText}>Loading more events...</Text> : null
+        }
         showsVerticalScrollIndicator={false}
       />
     </SafeAreaView>
@@ -175,6 +201,12 @@ const styles = StyleSheet.create({
     fontSize: 16,
     color: '#718096',
   },
+  loadingMoreText: {
+    fontSize: 14,
+    color: '#718096',
+    textAlign: 'center',
+    paddingVertical: 12,
+  },
   emptyState: {
     flex: 1,
     justifyContent: 'center',
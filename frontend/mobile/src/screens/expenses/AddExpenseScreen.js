@@ -21,6 +21,8 @@ const AddExpenseScreen = ({ navigation, route }) => {
   const [description, setDescription] = useState('');
   const [amount, setAmount] = useState('');
   const [participants, setParticipants] = useState([]);
+  const [participantsCursor, setParticipantsCursor] = useState(null);
+  const [loadingMore, setLoadingMore] = useState(false);
   const [selectedPayer, setSelectedPayer] = useState(user?.id);
   const [splitType, setSplitType] = useState('equal');
   const [loading, setLoading] = useState(false);
@@ -44,6 +46,32 @@ const AddExpenseScreen = ({ navigation, route }) => {
         ...(result.data.participants || [])
       ];
       setParticipants(allParticipants);
+      setParticipantsCursor(result.data.next_cursor || null);
+    }
+  };
+
+  const loadMoreParticipants = async () => {
+    if (!participantsCursor || loadingMore) {
+      return;
+    }
+
+    setLoadingMore(true);
+    try {
+      const result = await eventsAPI.getParticipants(event.id, participantsCursor);
+      if (result.success) {
+        setParticipants((current) => [...current, ...(result.data.participants || [])]);
+        setParticipantsCursor(result.data.next_cursor || null);
+      }
+    } finally {
+      setLoadingMore(false);
+    }
+  };
+
+  // Large events list more payers than the first page; fetch near the bottom
+  const handleScroll = ({ nativeEvent }) => {
+    const { layoutMeasurement, contentOffset, contentSize } = nativeEvent;
+    if (layoutMeasurement.height + contentOffset.y >= contentSize.height - layoutMeasurement.height / 2) {
+      loadMoreParticipants();
     }
   };
 
@@ -129,7 +157,11 @@ const AddExpenseScreen = ({ navigation, route }) => {
       </View>
 
       <Animated.View style={[styles.content, { transform: [{ translateY: slideAnim }] }]}>
-        <ScrollView showsVerticalScrollIndicator={false}>
+        <ScrollView
+          onScroll={handleScroll}
+          scrollEventThrottle={200}
+          showsVerticalScrollIndicator={false}
+        >
           <View style={styles.inputSection}>
             <TextInput
               label="What was this for?"
@@ -157,7 +189,7 @@ const AddExpenseScreen = ({ navigation, route }) => {
                 disabled={!amount || participants.length === 0}
               >
                 <Text style={styles.splitText}>
-                  {amount && participants.length > 0 
+                  {amount && participants.length > 0 && !participantsCursor
                     ? `$${(parseFloat(amount) / participants.length).toFixed(2)} each`
                     : 'Split preview'
                   }
@@ -34,12 +34,23 @@ apiClient.interceptors.response.use(
   }
 );
 
+// List endpoints return one page per call. Screens show the first page and
+// pass the response's next_cursor to fetch the next one as the user scrolls;
+// next_cursor is null on the last page.
+export const PAGE_SIZE = 50;
+
+const getPage = async (url, cursor) => {
+  const params = cursor ? { limit: PAGE_SIZE, cursor } : { limit: PAGE_SIZE };
+  const response = await apiClient.get(url, { params });
+  return response.data;
+};
+
 export const eventsAPI = {
-  // Get all user events
-  async getEvents() {
+  // Get one page of user events
+  async getEvents(cursor = null) {
     try {
-      const response = await apiClient.get('/bills/events');
-      return { success: true, data: response.data };
+      const data = await getPage('/bills/events', cursor);
+      return { success: true, data };
     } catch (error) {
       return { success: false, error: error.response?.data?.error || 'Network error' };
     }
@@ -65,11 +76,11 @@ export const eventsAPI = {
     }
   },
 
-  // Get event expenses
-  async getExpenses(eventId) {
+  // Get one page of event expenses
+  async getExpenses(eventId, cursor = null) {
     try {
-      const response = await apiClient.get(`/bills/events/${eventId}/expenses`);
-      return { success: true, data: response.data };
+      const data = await getPage(`/bills/events/${eventId}/expenses`, cursor);
+      return { success: true, data };
     } catch (error) {
       return { success: false, error: error.response?.data?.error || 'Network error' };
     }
@@ -85,11 +96,11 @@ export const eventsAPI = {
     }
   },
 
-  // Get participants
-  async getParticipants(eventId) {
+  // Get one page of participants
+  async getParticipants(eventId, cursor = null) {
     try {
-      const response = await apiClient.get(`/bills/events/${eventId}/participants`);
-      return { success: true, data: response.data };
+      const data = await getPage(`/bills/events/${eventId}/participants`, cursor);
+      return { success: true, data };
     } catch (error) {
       return { success: false, error: error.response?.data?.error || 'Network error' };
     }
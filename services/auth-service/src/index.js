@@ -6,7 +6,9 @@ const bcrypt = require('bcryptjs');
 const jwt = require('jsonwebtoken');
 const { Pool } = require('pg');
 const redis = require('redis');
+const crypto = require('crypto');
 const Joi = require('joi');
+const { parseRedisNodes, buildRing } = require('./redis_ring');
 
 const app = express();
 const PORT = process.env.PORT || 8001;
@@ -20,15 +22,21 @@ const pool = new Pool({
   max: parseInt(process.env.DB_MAX_CONNECTIONS) || 20,
 });
 
-const redisClient = redis.createClient({
-  socket: {
-    host: process.env.REDIS_HOST || 'redis',
-    port: process.env.REDIS_PORT || 6379,
-  },
-  password: process.env.REDIS_PASSWORD,
+// REDIS_NODES shards keys across several servers with the same ring as the
+// bill service, so both place every token:* key on one node
+const redisNodes = parseRedisNodes(process.env);
+const nodeFor = buildRing(redisNodes);
+
+const redisClients = redisNodes.map((node) => {
+  const client = redis.createClient({
+    socket: { host: node.host, port: node.port },
+    password: process.env.REDIS_PASSWORD,
+  });
+  client.connect().catch(console.error);
+  return client;
 });
 
-redisClient.connect().catch(console.error);
+const redisFor = (key) => redisClients[nodeFor(key)];
 
 app.use(helmet());
 app.use(cors());
@@ -90,7 +98,7 @@ app.post('/register', async (req, res) => {
       { expiresIn: process.env.JWT_EXPIRY || '24h' }
     );
 
-    await redisClient.setEx(`token:${token}`, 86400, JSON.stringify({
+    await redisFor(`token:${token}`).setEx(`token:${token}`, 86400, JSON.stringify({
       userId: user.id,
       email: user.email
     }));
@@ -147,7 +155,7 @@ app.post('/login', async (req, res) => {
       { expiresIn: process.env.JWT_EXPIRY || '24h' }
     );
 
-    await redisClient.setEx(`token:${token}`, 86400, JSON.stringify({
+    await redisFor(`token:${token}`).setEx(`token:${token}`, 86400, JSON.stringify({
       userId: user.id,
       email: user.email
     }));
@@ -177,7 +185,7 @@ app.post('/verify', async (req, res) => {
 
     const token = authHeader.substring(7);
 
-    const cachedData = await redisClient.get(`token:${token}`);
+    const cachedData = await redisFor(`token:${token}`).get(`token:${token}`);
     if (!cachedData) {
       return res.status(401).json({ error: 'Token expired or invalid' });
     }
@@ -212,7 +220,19 @@ app.post('/logout', async (req, res) => {
     }
 
     const token = authHeader.substring(7);
-    await redisClient.del(`token:${token}`);
+    await redisFor(`token:${token}`).del(`token:${token}`);
+
+    // Services in stateless mode sync this set instead of reading the session;
+    // entries are scored by exp so lapsed tokens can be pruned
+    const decoded = jwt.decode(token);
+    const now = Math.floor(Date.now() / 1000);
+    const expiresAt = decoded && decoded.exp ? decoded.exp : now + 86400;
+    const revoked = redisFor('revoked_tokens');
+    await revoked.zAdd('revoked_tokens', {
+      score: expiresAt,
+      value: crypto.createHash('sha256').update(token).digest('hex'),
+    });
+    await revoked.zRemRangeByScore('revoked_tokens', '-inf', now);
 
     res.json({ success: true, message: 'Logged out successfully' });
   } catch (err) {
@@ -0,0 +1,70 @@
+// Client-side consistent hashing over independent Redis servers. The ring
+// must match the bill service's RedisHashRing (src/redis_nodes.cpp) so both
+// place every token:* key on one node; test/redis_ring.test.js checks the two
+// against a shared key -> node table.
+
+// REDIS_NODES as a comma-separated host:port list, or REDIS_HOST:REDIS_PORT
+// when unset
+const parseRedisNodes = (env) => {
+  const nodes = (env.REDIS_NODES || '')
+    .split(',')
+    .map((entry) => entry.trim())
+    .filter(Boolean)
+    .map((entry) => {
+      const colon = entry.lastIndexOf(':');
+      return colon < 0
+        ? { host: entry, port: 6379 }
+        : { host: entry.substring(0, colon), port: parseInt(entry.substring(colon + 1)) };
+    });
+  if (nodes.length === 0) {
+    nodes.push({ host: env.REDIS_HOST || 'redis', port: parseInt(env.REDIS_PORT) || 6379 });
+  }
+  return nodes;
+};
+
+const MASK64 = (1n << 64n) - 1n;
+
+// FNV-1a 64 followed by the MurmurHash3 finalizer
+const hashKey = (text) => {
+  let h = 14695981039346656037n;
+  for (const byte of Buffer.from(text)) {
+    h ^= BigInt(byte);
+    h = (h * 1099511628211n) & MASK64;
+  }
+  h ^= h >> 33n;
+  h = (h * 0xff51afd7ed558ccdn) & MASK64;
+  h ^= h >> 33n;
+  h = (h * 0xc4ceb9a34e2e4bb3n) & MASK64;
+  h ^= h >> 33n;
+  return h;
+};
+
+// Returns key => index into nodes
+const buildRing = (nodes, pointsPerNode = 160) => {
+  const points = nodes
+    .flatMap((node, index) => Array.from({ length: pointsPerNode }, (_, i) => ({
+      hash: hashKey(`${node.host}:${node.port}-${i}`),
+      index,
+    })))
+    .sort((a, b) => (a.hash < b.hash ? -1 : a.hash > b.hash ? 1 : a.index - b.index));
+
+  return (key) => {
+    if (nodes.length <= 1) {
+      return 0;
+    }
+    // A non-empty {tag} places the key by the tag alone
+    const open = key.indexOf('{');
+    const close = open < 0 ? -1 : key.indexOf('}', open + 1);
+    const hash = hashKey(close > open + 1 ? key.substring(open + 1, close) : key);
+
+    let low = 0;
+    let high = points.length;
+    while (low < high) {
+      const mid = (low + high) >> 1;
+      if (points[mid].hash < hash) low = mid + 1; else high = mid;
+    }
+    return points[low % points.length].index;
+  };
+};
+
+module.exports = { parseRedisNodes, hashKey, buildRing };
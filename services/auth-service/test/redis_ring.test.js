@@ -0,0 +1,32 @@
+// The auth service's ring against the key -> node table the bill service's
+// RedisHashRing is tested against (services/bill-service/tests/redis_ring_test.cpp),
+// so both services place every token:* key on the same node.
+
+const test = require('node:test');
+const assert = require('node:assert');
+const path = require('path');
+const { parseRedisNodes, buildRing } = require('../src/redis_ring');
+
+const rings = require(path.join(__dirname, '../../bill-service/tests/fixtures/redis_ring.json'));
+
+test('places every fixture key on the same node as the bill service', () => {
+  assert.ok(rings.length > 0);
+  for (const ring of rings) {
+    const nodeFor = buildRing(parseRedisNodes({ REDIS_NODES: ring.nodes.join(',') }));
+    for (const [key, node] of Object.entries(ring.keys)) {
+      assert.strictEqual(nodeFor(key), node, `key "${key}" on ${ring.nodes.join(',')}`);
+    }
+  }
+});
+
+test('places a {tag} key by its tag', () => {
+  const nodeFor = buildRing(parseRedisNodes({ REDIS_NODES: 'redis-a:6379,redis-b:6379,redis-c:6379' }));
+  assert.strictEqual(nodeFor('{event-1}:balances'), nodeFor('event-1'));
+  assert.strictEqual(nodeFor('{a}{b}'), nodeFor('a'));
+});
+
+test('falls back to REDIS_HOST and REDIS_PORT', () => {
+  assert.deepStrictEqual(parseRedisNodes({ REDIS_HOST: 'cache', REDIS_PORT: '6400' }), [{ host: 'cache', port: 6400 }]);
+  assert.deepStrictEqual(parseRedisNodes({ REDIS_NODES: ' a:1, b ,' }), [{ host: 'a', port: 1 }, { host: 'b', port: 6379 }]);
+  assert.strictEqual(buildRing(parseRedisNodes({}))('token:x'), 0);
+});
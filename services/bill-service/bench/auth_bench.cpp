@@ -0,0 +1,105 @@
+// Per-request cost of AuthMiddleware::requireAuth in nanoseconds and heap
+// allocations, for a token served from the token cache and for one that is
+// fully verified (signature plus session lookup, or signature plus
+// revocation check in stateless mode). Sessions live in the in-memory Redis
+// backend, so the numbers exclude network time. Only figures from a build
+// against the jwt-cpp release CMakeLists.txt fetches (0.6.0) are meaningful
+// for the verified rows: jwt::decode and verify are most of their cost.
+//
+//   cmake -S . -B build -DBILL_SERVICE_BENCHMARKS=ON && cmake --build build --target auth-bench
+//   ./build/auth-bench [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <jwt-cpp/jwt.h>
+#include "auth_middleware.h"
+#include "memory_backend.h"
+#include "redis_client.h"
+#include "utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+static void run(const char* name, AuthMiddleware& auth, const httplib::Request& req, int iterations) {
+    httplib::Response res;
+    RequestContext context;
+
+    // Warms the token cache, the thread's buffers and the allocator
+    for (int i = 0; i < 1000; ++i) {
+        if (!auth.requireAuth(req, res, context)) {
+            std::fprintf(stderr, "%s: authentication failed: %s\n", name, res.body.c_str());
+            std::exit(1);
+        }
+    }
+
+    uint64_t allocationsBefore = allocations.load();
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        auth.requireAuth(req, res, context);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+    uint64_t allocated = allocations.load() - allocationsBefore;
+
+    std::printf("%-20s %12.0f %14.2f\n", name, elapsed.count() / iterations,
+                static_cast<double>(allocated) / iterations);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    std::string userId = "6f1c2f0e-3b7a-4c2e-9f5d-2a8b7c6d5e4f";
+    std::string email = "alex.rossi@example.com";
+    std::string token = jwt::create()
+        .set_type("JWT")
+        .set_payload_claim("userId", jwt::claim(userId))
+        .set_payload_claim("email", jwt::claim(email))
+        .set_expires_at(std::chrono::system_clock::now() + std::chrono::hours(1))
+        .sign(jwt::algorithm::hs256{getEnvVar("JWT_SECRET", "your_super_secure_jwt_secret_key_min_32_chars")});
+
+    auto redis = std::make_shared<RedisClient>(std::make_shared<MemoryBackend>());
+    redis->connect();
+    redis->setToken(token, json{{"userId", userId}, {"email", email}}.dump(), 3600);
+
+    httplib::Request req;
+    req.headers.emplace("Authorization", "Bearer " + token);
+
+    std::printf("%-20s %12s %14s\n", "path", "ns_per_call", "allocs_per_call");
+
+    setenv("AUTH_MODE", "session", 1);
+    AuthMiddleware cachedAuth(redis);
+    run("cached", cachedAuth, req, iterations);
+
+    // An empty token cache sends every call down the full check
+    setenv("TOKEN_CACHE_CAPACITY", "0", 1);
+    AuthMiddleware sessionAuth(redis);
+    run("verified (session)", sessionAuth, req, iterations / 10);
+
+    setenv("AUTH_MODE", "stateless", 1);
+    AuthMiddleware statelessAuth(redis);
+    statelessAuth.startTokenInvalidation();
+    run("verified (stateless)", statelessAuth, req, iterations / 10);
+
+    return 0;
+}
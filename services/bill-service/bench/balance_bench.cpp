@@ -0,0 +1,161 @@
+// Times /users/balance for a user with 10, 100 and 1000 events, computed
+// both the old way (list the user's events, then load expenses and
+// participants per event and split in C++) and from the event_balances
+// ledger in one query. Seeds its own users, events, participants and
+// expenses through the DB_* settings the service uses, and deletes them
+// again on exit.
+//
+//   cmake -S . -B build -DBILL_SERVICE_BENCHMARKS=ON && cmake --build build --target balance-bench
+//   DB_HOST=localhost DB_PASSWORD=... ./build/balance-bench [iterations]
+//
+// or, in the service's build image against the compose Postgres:
+//
+//   make bench-bill
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+#include "database.h"
+#include "split_calculator.h"
+#include "utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::string connectionString() {
+    return "host=" + getEnvVar("DB_HOST", "postgres") +
+           " port=" + getEnvVar("DB_PORT", "5432") +
+           " dbname=" + getEnvVar("DB_NAME", "bill_splitter_db") +
+           " user=" + getEnvVar("DB_USER", "billsplitter_user") +
+           " password=" + getEnvVar("DB_PASSWORD", "");
+}
+
+// Creates a user who created `events` events, each shared with three other
+// users and holding one expense paid by each member. Returns the user's id.
+static std::string seedUser(pqxx::connection& conn, Database& db, const std::string& tag, int events) {
+    std::string creatorId;
+    {
+        pqxx::work txn(conn);
+        for (int i = 0; i < 4; ++i) {
+            pqxx::result user = txn.exec_params(
+                "INSERT INTO users (name, family_name, email, password_hash) "
+                "VALUES ('Bench', 'User', $1, 'x') RETURNING id",
+                tag + "-" + std::to_string(i) + "@example.com");
+            if (i == 0) {
+                creatorId = user[0][0].c_str();
+            }
+        }
+
+        txn.exec_params(
+            "INSERT INTO events (creator_id, name, created_at) "
+            "SELECT $1, 'Bench event ' || g, CURRENT_TIMESTAMP - g * INTERVAL '1 minute' "
+            "FROM generate_series(1, $2) g",
+            creatorId, events);
+        txn.exec_params(
+            "INSERT INTO participants (event_id, user_id) "
+            "SELECT e.id, u.id FROM events e JOIN users u ON u.email LIKE $2 AND u.id <> $1 "
+            "WHERE e.creator_id = $1",
+            creatorId, tag + "-%");
+        txn.exec_params(
+            "INSERT INTO expenses (event_id, payer_id, amount, description) "
+            "SELECT m.event_id, m.user_id, (abs(hashtext(m.event_id::text || m.user_id::text)) % 9900 + 100) / 100.0, "
+            "'Bench expense' "
+            "FROM (SELECT id AS event_id, creator_id AS user_id FROM events WHERE creator_id = $1 "
+            "UNION ALL SELECT p.event_id, p.user_id FROM participants p "
+            "JOIN events e ON e.id = p.event_id WHERE e.creator_id = $1) m",
+            creatorId);
+        txn.commit();
+    }
+
+    // The rows above bypassed the service, so derive their ledger entries
+    for (const auto& event : db.getEventsByUser(creatorId)) {
+        db.rebuildEventBalances(event.id);
+    }
+    return creatorId;
+}
+
+// The handler before the ledger: 1 + 2 * events round trips
+static int64_t perEventBalance(Database& db, const std::string& userId) {
+    int64_t totalCents = 0;
+    for (const auto& event : db.getEventsByUser(userId)) {
+        auto expenses = db.getExpensesByEvent(event.id);
+        auto participants = db.getParticipantsByEvent(event.id);
+
+        if (event.creatorId == userId) {
+            Participant creatorParticipant;
+            creatorParticipant.userId = userId;
+            creatorParticipant.status = "active";
+            participants.push_back(creatorParticipant);
+        }
+
+        auto balances = SplitCalculator::calculateUserBalances(expenses, participants);
+        auto balance = balances.find(userId);
+        if (balance != balances.end()) {
+            totalCents += balance->second;
+        }
+    }
+    return totalCents;
+}
+
+template <typename Run>
+static double millisPerCall(int iterations, int64_t& totalCents, Run run) {
+    totalCents = run();  // warm the plans and buffers
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        totalCents = run();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start);
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    Database db;
+    if (!db.connect()) {
+        std::fprintf(stderr, "Could not connect to PostgreSQL\n");
+        return 1;
+    }
+    pqxx::connection conn(connectionString());
+
+    std::string runTag = "bench-" + std::to_string(
+        std::chrono::system_clock::now().time_since_epoch().count());
+
+    std::printf("%-8s %12s %12s %14s %14s %9s\n",
+                "events", "old_queries", "new_queries", "per_event_ms", "ledger_ms", "speedup");
+
+    int status = 0;
+    try {
+        for (int events : {10, 100, 1000}) {
+            std::string userId = seedUser(conn, db, runTag + "-" + std::to_string(events), events);
+            int runs = std::max(3, iterations * 10 / events);
+
+            int64_t oldTotal = 0;
+            int64_t newTotal = 0;
+            double oldMs = millisPerCall(runs, oldTotal, [&] { return perEventBalance(db, userId); });
+            double newMs = millisPerCall(runs, newTotal, [&] { return db.getUserBalances(userId).totalCents; });
+
+            std::printf("%-8d %12d %12d %14.2f %14.2f %8.1fx %s\n",
+                        events, 1 + 2 * events, 1, oldMs, newMs, oldMs / newMs,
+                        oldTotal == newTotal ? "" : "(total mismatch)");
+            if (oldTotal != newTotal) {
+                status = 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+        status = 1;
+    }
+
+    // Events, participants, expenses and ledger rows cascade from the users
+    pqxx::work txn(conn);
+    txn.exec_params("DELETE FROM users WHERE email LIKE $1", runTag + "-%");
+    txn.commit();
+
+    db.disconnect();
+    return status;
+}
@@ -0,0 +1,193 @@
+// Serializes representative expenses-list and settlements responses both as
+// a json DOM dumped to a string (the pre-JsonWriter path) and with
+// JsonWriter, and prints the time per response for each.
+//
+//   cmake -S . -B build -DBILL_SERVICE_BENCHMARKS=ON && cmake --build build --target json-bench
+//   ./build/json-bench [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "json_writer.h"
+#include "models.h"
+#include "split_calculator.h"
+#include "utils.h"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+static std::string fakeId(size_t n) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%08zx-0000-4000-8000-%012zx", n, n * 7919);
+    return buffer;
+}
+
+static std::vector<Expense> makeExpenses(size_t count) {
+    std::vector<Expense> expenses;
+    expenses.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Expense expense;
+        expense.id = fakeId(i);
+        expense.eventId = fakeId(1000000);
+        expense.payerId = fakeId(2000000 + i % 8);
+        expense.amountCents = 1999 + static_cast<int64_t>(i) * 37;
+        expense.description = "Dinner at \"La Trattoria\" #" + std::to_string(i);
+        expense.splitType = "equal";
+        expense.expenseDate = 1700000000000 + static_cast<int64_t>(i) * 3600000;
+        expense.createdAt = expense.expenseDate + 1000;
+        expense.payer = UserSummary{"Alex", "Rossi", ""};
+        expenses.push_back(std::move(expense));
+    }
+    return expenses;
+}
+
+static std::map<std::string, int64_t> makeBalances(size_t members) {
+    std::map<std::string, int64_t> balances;
+    int64_t total = 0;
+    for (size_t i = 0; i + 1 < members; ++i) {
+        int64_t cents = (i % 2 == 0 ? 1 : -1) * static_cast<int64_t>(1234 + i * 101);
+        balances[fakeId(3000000 + i)] = cents;
+        total += cents;
+    }
+    balances[fakeId(3000000 + members)] = -total;
+    return balances;
+}
+
+static std::string expensesDom(const std::vector<Expense>& expenses) {
+    json response = {
+        {"success", true},
+        {"timestamp", getCurrentTimestamp()}
+    };
+    response["expenses"] = toJson(expenses);
+    return response.dump();
+}
+
+static std::string expensesWriter(const std::vector<Expense>& expenses) {
+    JsonWriter out;
+    out.reserve(expenses.size() * 384 + 2);
+    out.beginObject();
+    out.key("expenses").beginArray();
+    for (const auto& expense : expenses) {
+        writeJson(out, expense);
+    }
+    out.endArray();
+    writeSuccessFields(out);
+    out.endObject();
+    return out.release();
+}
+
+static std::string settlementsDom(const std::map<std::string, int64_t>& balances,
+                                  const std::vector<Settlement>& settlements) {
+    json balancesJson = json::object();
+    for (const auto& [userId, balanceCents] : balances) {
+        balancesJson[userId] = centsToAmount(balanceCents);
+    }
+
+    json settlementsJson = json::array();
+    for (const auto& settlement : settlements) {
+        settlementsJson.push_back({
+            {"from_user_id", settlement.fromUserId},
+            {"to_user_id", settlement.toUserId},
+            {"amount", centsToAmount(settlement.amountCents)}
+        });
+    }
+
+    json response = {
+        {"success", true},
+        {"timestamp", getCurrentTimestamp()}
+    };
+    response["balances"] = balancesJson;
+    response["settlements"] = settlementsJson;
+    return response.dump();
+}
+
+// Same shape as SettlementsController::getEventSettlements writes
+static std::string settlementsWriter(const std::map<std::string, int64_t>& balances,
+                                     const std::vector<Settlement>& settlements) {
+    JsonWriter out(64 * (balances.size() + settlements.size()) + 128);
+    out.beginObject();
+    out.key("balances").beginObject();
+    for (const auto& [userId, balanceCents] : balances) {
+        out.key(userId).amount(balanceCents);
+    }
+    out.endObject();
+
+    out.key("settlements").beginArray();
+    for (const auto& settlement : settlements) {
+        out.beginObject();
+        out.key("amount").amount(settlement.amountCents);
+        out.key("from_user_id").string(settlement.fromUserId);
+        out.key("to_user_id").string(settlement.toUserId);
+        out.endObject();
+    }
+    out.endArray();
+    writeSuccessFields(out);
+    out.endObject();
+    return out.release();
+}
+
+template <typename Serialize>
+static double microsPerCall(int iterations, size_t& bytes, Serialize serialize) {
+    // Warm up allocator and caches
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        bytes = serialize().size();
+    }
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        bytes = serialize().size();
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / iterations;
+}
+
+// The timestamp differs between calls, so only the payload is compared
+static bool samePayload(const std::string& a, const std::string& b) {
+    json left = json::parse(a);
+    json right = json::parse(b);
+    left.erase("timestamp");
+    right.erase("timestamp");
+    return left == right;
+}
+
+static void report(const char* name, const std::string& domSample,
+                   const std::string& writerSample, double domUs, double writerUs, size_t bytes) {
+    std::printf("%-22s %8zu %10.2f %10.2f %8.2fx %s\n", name, bytes, domUs, writerUs, domUs / writerUs,
+                samePayload(domSample, writerSample) ? "" : "(payload mismatch)");
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    std::printf("%-22s %8s %10s %10s %9s\n", "payload", "bytes", "dom_us", "writer_us", "speedup");
+
+    for (size_t count : {10, 100, 1000}) {
+        auto expenses = makeExpenses(count);
+        int runs = std::max(1, iterations * 10 / static_cast<int>(count));
+        size_t bytes = 0;
+        double dom = microsPerCall(runs, bytes, [&] { return expensesDom(expenses); });
+        double writer = microsPerCall(runs, bytes, [&] { return expensesWriter(expenses); });
+
+        std::string name = "expenses x" + std::to_string(count);
+        report(name.c_str(), expensesDom(expenses), expensesWriter(expenses), dom, writer, bytes);
+    }
+
+    for (size_t members : {5, 20, 50}) {
+        auto balances = makeBalances(members);
+        auto settlements = SplitCalculator::optimizeSettlements(balances);
+        size_t bytes = 0;
+        double dom = microsPerCall(iterations, bytes, [&] { return settlementsDom(balances, settlements); });
+        double writer = microsPerCall(iterations, bytes, [&] { return settlementsWriter(balances, settlements); });
+
+        std::string name = "settlements x" + std::to_string(members);
+        report(name.c_str(), settlementsDom(balances, settlements),
+               settlementsWriter(balances, settlements), dom, writer, bytes);
+    }
+
+    return 0;
+}
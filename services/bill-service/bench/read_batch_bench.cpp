@@ -0,0 +1,205 @@
+// Times the batched reads behind GET /events/:id/settlements and
+// GET /events/:id three ways on one connection:
+//   sequential  one exec_prepared round trip per read
+//   text        one pipeline of statement SQL with quoted literals bound
+//               in, parsed and planned on every call (the first readBatch)
+//   execute     one pipeline of EXECUTEs of the prepared statements
+//               (Database::readBatch)
+// Seeds a user, an event with three participants and a few expenses through
+// the DB_* settings the service uses, and deletes them again on exit.
+// If execute does not beat sequential for these two-read batches, set DB_PIPELINE_MIN_READS=3 so the service runs it one by one;
+// DB_PIPELINE_READS=false gives the sequential baseline in the service.
+//
+//   cmake -S . -B build -DBILL_SERVICE_BENCHMARKS=ON && cmake --build build --target read-batch-bench
+//   DB_HOST=localhost DB_PASSWORD=... ./build/read-batch-bench [iterations]
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+#include "prepared_statements.h"
+#include "utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Read {
+    const char* statement;
+    std::vector<std::string> params;
+};
+
+static std::string connectionString() {
+    return "host=" + getEnvVar("DB_HOST", "postgres") +
+           " port=" + getEnvVar("DB_PORT", "5432") +
+           " dbname=" + getEnvVar("DB_NAME", "bill_splitter_db") +
+           " user=" + getEnvVar("DB_USER", "billsplitter_user") +
+           " password=" + getEnvVar("DB_PASSWORD", "");
+}
+
+static const char* statementText(const char* name) {
+    for (const auto& statement : preparedStatements()) {
+        if (std::strcmp(statement.name, name) == 0) {
+            return statement.sql;
+        }
+    }
+    return nullptr;
+}
+
+static void sequential(pqxx::transaction_base& txn, const std::vector<Read>& reads) {
+    for (const auto& read : reads) {
+        txn.exec_prepared(read.statement, pqxx::prepare::make_dynamic_params(read.params));
+    }
+}
+
+static void pipelined(pqxx::transaction_base& txn, const std::vector<Read>& reads,
+                      const std::function<std::string(const Read&)>& render) {
+    pqxx::pipeline pipe(txn);
+    std::vector<pqxx::pipeline::query_id> ids;
+    for (const auto& read : reads) {
+        ids.push_back(pipe.insert(render(read)));
+    }
+    pipe.complete();
+    for (auto id : ids) {
+        pipe.retrieve(id);
+    }
+}
+
+// Registry SQL with every $n replaced by a quoted literal
+static std::string boundText(pqxx::transaction_base& txn, const Read& read) {
+    std::string bound;
+    for (const char* p = statementText(read.statement); *p; ++p) {
+        if (*p != '$' || !std::isdigit(static_cast<unsigned char>(p[1]))) {
+            bound += *p;
+            continue;
+        }
+        size_t index = 0;
+        while (std::isdigit(static_cast<unsigned char>(p[1]))) {
+            index = index * 10 + (*++p - '0');
+        }
+        bound += txn.quote(read.params.at(index - 1));
+    }
+    return bound;
+}
+
+static std::string executeText(pqxx::transaction_base& txn, const Read& read) {
+    std::string query = "EXECUTE " + txn.quote_name(read.statement);
+    for (size_t i = 0; i < read.params.size(); ++i) {
+        query += i == 0 ? "(" : ", ";
+        query += txn.quote(read.params[i]);
+    }
+    if (!read.params.empty()) {
+        query += ")";
+    }
+    return query;
+}
+
+struct Timing {
+    double p50;
+    double p99;
+};
+
+static double percentile(std::vector<double>& values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1) + 0.5)];
+}
+
+// Each call runs in its own transaction, as the handlers do
+static Timing microsPerCall(pqxx::connection& conn, int iterations,
+                            const std::function<void(pqxx::transaction_base&)>& run) {
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        pqxx::work txn(conn);
+        run(txn);
+    }
+
+    std::vector<double> micros;
+    micros.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto start = Clock::now();
+        pqxx::work txn(conn);
+        run(txn);
+        txn.commit();
+        micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    return {percentile(micros, 0.50), percentile(micros, 0.99)};
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = std::max(1, argc > 1 ? std::atoi(argv[1]) : 2000);
+
+    pqxx::connection conn(connectionString());
+    prepareStatements(conn);
+
+    std::string runTag = "bench-" + std::to_string(
+        std::chrono::system_clock::now().time_since_epoch().count());
+    std::string userId;
+    std::string eventId;
+
+    {
+        pqxx::work txn(conn);
+        for (int i = 0; i < 4; ++i) {
+            pqxx::result user = txn.exec_params(
+                "INSERT INTO users (name, family_name, email, password_hash) "
+                "VALUES ('Bench', 'User', $1, 'x') RETURNING id",
+                runTag + "-" + std::to_string(i) + "@example.com");
+            if (i == 0) {
+                userId = user[0][0].c_str();
+            }
+        }
+        eventId = txn.exec_params(
+            "INSERT INTO events (creator_id, name) VALUES ($1, 'Bench event') RETURNING id",
+            userId)[0][0].c_str();
+        txn.exec_params(
+            "INSERT INTO participants (event_id, user_id) "
+            "SELECT $1, id FROM users WHERE email LIKE $2 AND id <> $3",
+            eventId, runTag + "-%", userId);
+        txn.exec_params(
+            "INSERT INTO expenses (event_id, payer_id, amount, description) "
+            "SELECT $1, user_id, 12.34 * g, 'Bench expense' "
+            "FROM participants, generate_series(1, 5) g WHERE event_id = $1",
+            eventId);
+        txn.exec_prepared(Statements::LedgerRebuild, eventId);
+        txn.commit();
+    }
+
+    // The two handlers' read sets with the access check not yet cached; once
+    // it is, each is a single read and nothing is pipelined
+    std::vector<std::pair<const char*, std::vector<Read>>> batches = {
+        {"settlements", {{Statements::VersionedBalancesByEvent, {eventId}},
+                         {Statements::ResolveEventAccess, {eventId, userId}}}},
+        {"event detail", {{Statements::EventById, {eventId}},
+                          {Statements::ResolveEventAccess, {eventId, userId}}}}
+    };
+
+    std::printf("%-15s %19s %19s %19s\n", "reads (p50/p99)", "sequential_us", "text_us", "execute_us");
+
+    int status = 0;
+    try {
+        for (const auto& [name, reads] : batches) {
+            Timing seq = microsPerCall(conn, iterations, [&](pqxx::transaction_base& txn) {
+                sequential(txn, reads);
+            });
+            Timing text = microsPerCall(conn, iterations, [&](pqxx::transaction_base& txn) {
+                pipelined(txn, reads, [&](const Read& read) { return boundText(txn, read); });
+            });
+            Timing execute = microsPerCall(conn, iterations, [&](pqxx::transaction_base& txn) {
+                pipelined(txn, reads, [&](const Read& read) { return executeText(txn, read); });
+            });
+            std::printf("%-15s %9.1f/%9.1f %9.1f/%9.1f %9.1f/%9.1f\n", name,
+                        seq.p50, seq.p99, text.p50, text.p99, execute.p50, execute.p99);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+        status = 1;
+    }
+
+    // The event and its rows cascade from the users
+    pqxx::work txn(conn);
+    txn.exec_params("DELETE FROM users WHERE email LIKE $1", runTag + "-%");
+    txn.commit();
+    return status;
+}
@@ -0,0 +1,418 @@
+#include "async_redis_client.h"
+#include "utils.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+AsyncRedisClient::AsyncRedisClient()
+    : nodes_(loadRedisNodes()), ring_(nodes_) {
+    password_ = getEnvVar("REDIS_PASSWORD", "");
+    backoffInitial_ = std::chrono::milliseconds(std::stol(getEnvVar("REDIS_RECONNECT_BACKOFF_MS", "100")));
+    backoffMax_ = std::max(backoffInitial_,
+        std::chrono::milliseconds(std::stol(getEnvVar("REDIS_RECONNECT_BACKOFF_MAX_MS", "5000"))));
+
+    connectionsPerNode_ = std::max<size_t>(1, std::stoul(getEnvVar("REDIS_ASYNC_CONNECTIONS", "2")));
+    nextConnection_.assign(nodes_.size(), 0);
+    for (size_t node = 0; node < nodes_.size(); ++node) {
+        for (size_t i = 0; i < connectionsPerNode_; ++i) {
+            auto conn = std::make_unique<Connection>();
+            conn->client = this;
+            conn->node = node;
+            connections_.push_back(std::move(conn));
+        }
+    }
+}
+
+AsyncRedisClient::~AsyncRedisClient() {
+    disconnect();
+}
+
+bool AsyncRedisClient::connect() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return connectedCount_ > 0;
+        }
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        LOG_ERROR("Async Redis: failed to create wake pipe: " << strerror(errno));
+        return false;
+    }
+    wakeRead_ = fds[0];
+    wakeWrite_ = fds[1];
+    fcntl(wakeRead_, F_SETFL, O_NONBLOCK);
+    fcntl(wakeWrite_, F_SETFL, O_NONBLOCK);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+    }
+    ioThread_ = std::thread(&AsyncRedisClient::run, this);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    return connectedChanged_.wait_for(lock, std::chrono::milliseconds(1500),
+                                      [this] { return connectedCount_ > 0; });
+}
+
+void AsyncRedisClient::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake();
+
+    if (ioThread_.joinable()) {
+        ioThread_.join();
+    }
+
+    close(wakeRead_);
+    close(wakeWrite_);
+    wakeRead_ = wakeWrite_ = -1;
+}
+
+bool AsyncRedisClient::isConnected() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_ && connectedCount_ > 0;
+}
+
+std::future<AsyncRedisClient::Reply> AsyncRedisClient::command(std::vector<std::string> args) {
+    PendingCommand pending{std::move(args), {}};
+    std::future<Reply> future = pending.promise.get_future();
+    ++submitted_;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            ++failed_;
+            pending.promise.set_value(errorReply("Async Redis client is not running"));
+            return future;
+        }
+        queue_.push_back(std::move(pending));
+        // Under the lock so disconnect() cannot close the pipe underneath us
+        wake();
+    }
+
+    return future;
+}
+
+json AsyncRedisClient::getStats() const {
+    size_t connected, queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connected = connectedCount_;
+        queued = queue_.size();
+    }
+
+    return json{
+        {"nodes", nodes_.size()},
+        {"connections", connections_.size()},
+        {"connected", connected},
+        {"queued", queued},
+        {"in_flight", inFlight_.load()},
+        {"submitted", submitted_.load()},
+        {"completed", completed_.load()},
+        {"failed", failed_.load()},
+        {"reconnects", reconnects_.load()}
+    };
+}
+
+void AsyncRedisClient::wake() {
+    char byte = 1;
+    // A full pipe already guarantees a wake-up
+    ssize_t written = write(wakeWrite_, &byte, 1);
+    (void)written;
+}
+
+void AsyncRedisClient::run() {
+    std::vector<pollfd> fds;
+    std::vector<Connection*> polled;
+
+    while (true) {
+        std::deque<PendingCommand> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                break;
+            }
+            batch.swap(queue_);
+        }
+
+        auto now = Clock::now();
+        for (auto& conn : connections_) {
+            if (!conn->context && now >= conn->retryAt) {
+                open(*conn);
+            }
+        }
+
+        // Commands queued on the same connection go out in one write, flushed
+        // right away rather than after another trip through poll()
+        for (auto& pending : batch) {
+            dispatch(std::move(pending));
+        }
+        if (!batch.empty()) {
+            for (auto& conn : connections_) {
+                if (conn->context && conn->connected && conn->wantWrite) {
+                    redisAsyncHandleWrite(conn->context);
+                }
+            }
+        }
+
+        fds.clear();
+        polled.clear();
+        fds.push_back(pollfd{wakeRead_, POLLIN, 0});
+
+        int timeoutMs = -1;
+        for (auto& conn : connections_) {
+            if (conn->context) {
+                short events = (conn->wantRead ? POLLIN : 0) | (conn->wantWrite ? POLLOUT : 0);
+                fds.push_back(pollfd{conn->context->c.fd, events, 0});
+                polled.push_back(conn.get());
+            } else {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(conn->retryAt - now);
+                int waitMs = static_cast<int>(std::max<long long>(wait.count(), 0));
+                timeoutMs = timeoutMs < 0 ? waitMs : std::min(timeoutMs, waitMs);
+            }
+        }
+
+        if (poll(fds.data(), fds.size(), timeoutMs) < 0) {
+            if (errno != EINTR) {
+                LOG_ERROR("Async Redis: poll failed: " << strerror(errno));
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wakeRead_, buffer, sizeof(buffer)) > 0) {
+            }
+        }
+
+        for (size_t i = 0; i < polled.size(); ++i) {
+            Connection* conn = polled[i];
+            short revents = fds[i + 1].revents;
+
+            // A read can drop the connection, which frees its context
+            if (conn->context && (revents & (POLLIN | POLLERR | POLLHUP))) {
+                redisAsyncHandleRead(conn->context);
+            }
+            if (conn->context && (revents & POLLOUT)) {
+                redisAsyncHandleWrite(conn->context);
+            }
+        }
+    }
+
+    // Freeing a context completes its outstanding callbacks with a NULL reply
+    for (auto& conn : connections_) {
+        if (conn->context) {
+            redisAsyncContext* context = conn->context;
+            conn->context = nullptr;
+            setConnected(*conn, false);
+            redisAsyncFree(context);
+        }
+    }
+
+    std::deque<PendingCommand> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        abandoned.swap(queue_);
+    }
+    for (auto& pending : abandoned) {
+        ++failed_;
+        pending.promise.set_value(errorReply("Async Redis client is shutting down"));
+    }
+}
+
+void AsyncRedisClient::open(Connection& conn) {
+    const RedisNode& address = nodes_[conn.node];
+    redisAsyncContext* context = redisAsyncConnect(address.host.c_str(), address.port);
+    if (!context || context->err) {
+        LOG_ERROR("Async Redis connection error (" << address.address() << "): "
+                  << (context ? context->errstr : "can't allocate redis context"));
+        if (context) {
+            redisAsyncFree(context);
+        }
+        scheduleRetry(conn);
+        return;
+    }
+
+    context->data = &conn;
+    context->ev.data = &conn;
+    context->ev.addRead = [](void* data) { static_cast<Connection*>(data)->wantRead = true; };
+    context->ev.delRead = [](void* data) { static_cast<Connection*>(data)->wantRead = false; };
+    context->ev.addWrite = [](void* data) { static_cast<Connection*>(data)->wantWrite = true; };
+    context->ev.delWrite = [](void* data) { static_cast<Connection*>(data)->wantWrite = false; };
+    context->ev.cleanup = [](void* data) {
+        auto* conn = static_cast<Connection*>(data);
+        conn->wantRead = false;
+        conn->wantWrite = false;
+    };
+
+    redisAsyncSetConnectCallback(context, &AsyncRedisClient::onConnect);
+    redisAsyncSetDisconnectCallback(context, &AsyncRedisClient::onDisconnect);
+
+    conn.context = context;
+    // The non-blocking connect completes once the socket is writable
+    conn.wantWrite = true;
+
+    if (!password_.empty()) {
+        redisAsyncCommand(context, &AsyncRedisClient::onAuth, nullptr, "AUTH %b",
+                          password_.data(), password_.size());
+    }
+}
+
+void AsyncRedisClient::scheduleRetry(Connection& conn) {
+    conn.backoff = conn.backoff.count() == 0 ? backoffInitial_ : std::min(conn.backoff * 2, backoffMax_);
+    conn.retryAt = Clock::now() + conn.backoff;
+    ++reconnects_;
+}
+
+void AsyncRedisClient::setConnected(Connection& conn, bool connected) {
+    if (conn.connected == connected) {
+        return;
+    }
+    conn.connected = connected;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connected ? ++connectedCount_ : --connectedCount_;
+    }
+    connectedChanged_.notify_all();
+}
+
+void AsyncRedisClient::dispatch(PendingCommand pending) {
+    size_t node = pending.args.size() > 1 ? ring_.nodeFor(pending.args[1]) : 0;
+    size_t& next = nextConnection_[node];
+    size_t first = node * connectionsPerNode_;
+
+    Connection* target = nullptr;
+    for (size_t i = 0; i < connectionsPerNode_ && !target; ++i) {
+        Connection* conn = connections_[first + (next + i) % connectionsPerNode_].get();
+        if (conn->context && conn->connected) {
+            target = conn;
+            next = (next + i + 1) % connectionsPerNode_;
+        }
+    }
+
+    if (!target) {
+        ++failed_;
+        pending.promise.set_value(errorReply("Async Redis node " + nodes_[node].address() + " is not connected"));
+        return;
+    }
+
+    std::vector<const char*> argv;
+    std::vector<size_t> argvLen;
+    argv.reserve(pending.args.size());
+    argvLen.reserve(pending.args.size());
+    for (const auto& arg : pending.args) {
+        argv.push_back(arg.data());
+        argvLen.push_back(arg.size());
+    }
+
+    auto promise = std::make_unique<std::promise<Reply>>(std::move(pending.promise));
+    if (redisAsyncCommandArgv(target->context, &AsyncRedisClient::onReply, promise.get(),
+                              static_cast<int>(argv.size()), argv.data(), argvLen.data()) != REDIS_OK) {
+        ++failed_;
+        promise->set_value(errorReply("Failed to queue Redis command"));
+        return;
+    }
+
+    // Owned by hiredis until onReply runs
+    promise.release();
+    ++inFlight_;
+}
+
+AsyncRedisClient::Reply AsyncRedisClient::fromRedisReply(const redisReply* reply) {
+    Reply result;
+    result.type = reply->type;
+
+    switch (reply->type) {
+        case REDIS_REPLY_STRING:
+        case REDIS_REPLY_STATUS:
+        case REDIS_REPLY_ERROR:
+            result.str.assign(reply->str, reply->len);
+            break;
+        case REDIS_REPLY_INTEGER:
+            result.integer = reply->integer;
+            break;
+        case REDIS_REPLY_ARRAY:
+            result.elements.reserve(reply->elements);
+            for (size_t i = 0; i < reply->elements; ++i) {
+                result.elements.push_back(fromRedisReply(reply->element[i]));
+            }
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+
+AsyncRedisClient::Reply AsyncRedisClient::errorReply(const std::string& message) {
+    Reply reply;
+    reply.type = REDIS_REPLY_ERROR;
+    reply.str = message;
+    return reply;
+}
+
+void AsyncRedisClient::onConnect(const redisAsyncContext* context, int status) {
+    auto* conn = static_cast<Connection*>(context->data);
+
+    if (status != REDIS_OK) {
+        // hiredis frees the context after this callback
+        LOG_ERROR("Async Redis connection error: " << context->errstr);
+        conn->context = nullptr;
+        conn->wantRead = conn->wantWrite = false;
+        conn->client->scheduleRetry(*conn);
+        return;
+    }
+
+    conn->backoff = std::chrono::milliseconds(0);
+    conn->client->setConnected(*conn, true);
+}
+
+void AsyncRedisClient::onDisconnect(const redisAsyncContext* context, int status) {
+    auto* conn = static_cast<Connection*>(context->data);
+
+    if (status != REDIS_OK) {
+        LOG_WARN("Async Redis disconnected: " << context->errstr);
+    }
+
+    conn->context = nullptr;
+    conn->wantRead = conn->wantWrite = false;
+    conn->client->setConnected(*conn, false);
+    conn->client->scheduleRetry(*conn);
+}
+
+void AsyncRedisClient::onReply(redisAsyncContext* context, void* reply, void* privdata) {
+    std::unique_ptr<std::promise<Reply>> promise(static_cast<std::promise<Reply>*>(privdata));
+    auto* conn = static_cast<Connection*>(context->data);
+    AsyncRedisClient* client = conn->client;
+
+    --client->inFlight_;
+
+    // A NULL reply means the connection went away before the answer arrived
+    if (!reply) {
+        ++client->failed_;
+        promise->set_value(errorReply(context->err ? context->errstr : "Redis connection closed"));
+        return;
+    }
+
+    ++client->completed_;
+    promise->set_value(fromRedisReply(static_cast<redisReply*>(reply)));
+}
+
+void AsyncRedisClient::onAuth(redisAsyncContext* context, void* reply, void*) {
+    auto* result = static_cast<redisReply*>(reply);
+    if (result && result->type == REDIS_REPLY_ERROR) {
+        LOG_ERROR("Async Redis authentication failed: " << std::string(result->str, result->len));
+        redisAsyncDisconnect(context);
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef ASYNC_REDIS_CLIENT_H
+#define ASYNC_REDIS_CLIENT_H
+
+#include <hiredis/async.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "redis_nodes.h"
+
+using json = nlohmann::json;
+
+// Non-blocking Redis access. Commands are handed to a dedicated I/O thread
+// that pipelines them over a few hiredis async connections and completes one
+// future per command, so request threads can overlap Redis with other work
+// instead of each holding a blocking socket. Each node in REDIS_NODES gets
+// its own connections, and commands go to the node that owns their key.
+class AsyncRedisClient {
+public:
+    struct Reply {
+        int type = REDIS_REPLY_NIL;
+        std::string str;  // string, status or error text
+        long long integer = 0;
+        std::vector<Reply> elements;
+
+        bool isError() const { return type == REDIS_REPLY_ERROR; }
+    };
+
+    AsyncRedisClient();
+    ~AsyncRedisClient();
+
+    AsyncRedisClient(const AsyncRedisClient&) = delete;
+    AsyncRedisClient& operator=(const AsyncRedisClient&) = delete;
+
+    // Starts the I/O thread and waits briefly for a first connection
+    bool connect();
+    void disconnect();
+    bool isConnected() const;
+
+    // Never throws; transport failures complete the future with an error reply.
+    // Routed by args[1], the key of every single-key command (GET, SET, DEL...).
+    std::future<Reply> command(std::vector<std::string> args);
+
+    json getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        AsyncRedisClient* client = nullptr;
+        size_t node = 0;
+        redisAsyncContext* context = nullptr;
+        bool connected = false;
+        bool wantRead = false;
+        bool wantWrite = false;
+        std::chrono::milliseconds backoff{0};
+        Clock::time_point retryAt{};
+    };
+
+    struct PendingCommand {
+        std::vector<std::string> args;
+        std::promise<Reply> promise;
+    };
+
+    std::vector<RedisNode> nodes_;
+    RedisHashRing ring_;
+    std::string password_;
+    std::chrono::milliseconds backoffInitial_;
+    std::chrono::milliseconds backoffMax_;
+
+    // Only touched by the I/O thread once it is running. Node n owns
+    // connections_[n * connectionsPerNode_ ...] and its own round-robin cursor.
+    std::vector<std::unique_ptr<Connection>> connections_;
+    size_t connectionsPerNode_;
+    std::vector<size_t> nextConnection_;
+
+    std::thread ioThread_;
+    int wakeRead_ = -1;
+    int wakeWrite_ = -1;
+
+    mutable std::mutex mutex_;
+    std::condition_variable connectedChanged_;
+    std::deque<PendingCommand> queue_;
+    bool running_ = false;
+    size_t connectedCount_ = 0;
+
+    // Counters
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> inFlight_{0};
+    std::atomic<uint64_t> reconnects_{0};
+
+    void run();
+    void open(Connection& conn);
+    void scheduleRetry(Connection& conn);
+    void setConnected(Connection& conn, bool connected);
+    void dispatch(PendingCommand command);
+    void wake();
+
+    static Reply fromRedisReply(const redisReply* reply);
+    static Reply errorReply(const std::string& message);
+
+    static void onConnect(const redisAsyncContext* context, int status);
+    static void onDisconnect(const redisAsyncContext* context, int status);
+    static void onReply(redisAsyncContext* context, void* reply, void* privdata);
+    static void onAuth(redisAsyncContext* context, void* reply, void* privdata);
+};
+
+#endif
@@ -1,50 +1,169 @@
 #include "auth_middleware.h"
 #include "utils.h"
+#include "logger.h"
 #include <jwt-cpp/jwt.h>
-#include <iostream>
-#include <regex>
+#include <openssl/sha.h>
+#include <array>
 #include <algorithm>
 
-AuthMiddleware::AuthMiddleware(std::shared_ptr<RedisClient> redis) 
-    : redis_(redis) {
+namespace {
+
+constexpr std::array<bool, 256> makeBase64UrlTable() {
+    std::array<bool, 256> table{};
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = true;
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = true;
+    for (int c = '0'; c <= '9'; ++c) table[c] = true;
+    table['-'] = true;
+    table['_'] = true;
+    return table;
+}
+
+constexpr std::array<bool, 256> kBase64UrlChars = makeBase64UrlTable();
+
+}
+
+struct AuthMiddleware::TokenVerifier {
+    decltype(jwt::verify()) verifier;
+};
+
+AuthMiddleware::AuthMiddleware(std::shared_ptr<RedisClient> redis,
+                               std::shared_ptr<AsyncRedisClient> asyncRedis)
+    : redis_(redis),
+      asyncRedis_(asyncRedis),
+      asyncRedisTimeout_(std::stol(getEnvVar("REDIS_ASYNC_TIMEOUT_MS", "1000"))),
+      tokenCacheTtl_(std::stol(getEnvVar("TOKEN_CACHE_TTL_MS", "30000"))),
+      tokenCache_(std::stoul(getEnvVar("TOKEN_CACHE_CAPACITY", "10000")),
+                  std::stoul(getEnvVar("TOKEN_CACHE_SHARDS", "16")),
+                  tokenCacheTtl_),
+      statelessMode_(getEnvVar("AUTH_MODE", "session") == "stateless") {
     jwtSecret_ = getEnvVar("JWT_SECRET", "your_super_secure_jwt_secret_key_min_32_chars");
+    tokenSlidingTtl_ = std::stoi(getEnvVar("REDIS_TOKEN_SLIDING_TTL", "0"));
+    
+    // verify() is const, so one verifier serves every request thread
+    verifier_ = std::make_unique<TokenVerifier>(TokenVerifier{
+        jwt::verify().allow_algorithm(jwt::algorithm::hs256{jwtSecret_})});
+    
+    if (statelessMode_) {
+        revocations_ = std::make_unique<RevocationFilter>(
+            redis_,
+            std::chrono::milliseconds(std::stol(getEnvVar("REVOCATION_SYNC_INTERVAL_MS", "5000"))),
+            std::stod(getEnvVar("REVOCATION_FILTER_FP_RATE", "0.001")));
+    }
+}
+
+AuthMiddleware::~AuthMiddleware() {
+    // The subscriber and the revocation sync call back into tokenCache_
+    redis_->stopTokenInvalidation();
+    if (revocations_) {
+        revocations_->stop();
+    }
+}
+
+void AuthMiddleware::startTokenInvalidation() {
+    if (revocations_) {
+        // The cache is keyed by the same digest the filter reports
+        revocations_->start([this](const std::string& digest) {
+            tokenCache_.erase(digest);
+        });
+    }
+    
+    if (!tokenCache_.enabled() || getEnvVar("TOKEN_CACHE_INVALIDATION", "true") != "true") {
+        return;
+    }
+
+    redis_->startTokenInvalidation(
+        [this](const std::string& token) {
+            tokenCache_.erase(tokenDigest(token));
+        },
+        [this]() {
+            tokenCache_.clear();
+        });
 }
 
 AuthMiddleware::AuthResult AuthMiddleware::authenticate(const httplib::Request& req) {
     AuthResult result;
+    authenticate(req, result);
+    return result;
+}
+
+bool AuthMiddleware::authenticate(const httplib::Request& req, AuthResult& result) {
+    auto start = std::chrono::steady_clock::now();
+    bool cached = false;
+    
     result.success = false;
+    result.userId.clear();
+    result.email.clear();
+    result.error.clear();
+    authenticateToken(req, result, cached);
     
-    // Extract Authorization header
-    auto authHeader = req.get_header_value("Authorization");
-    if (authHeader.empty()) {
+    uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    (cached ? cachedLatency_ : verifiedLatency_).record(nanos);
+    return result.success;
+}
+
+void AuthMiddleware::authenticateToken(const httplib::Request& req, AuthResult& result, bool& cached) {
+    // Extract Authorization header, by reference rather than get_header_value's copy
+    auto header = req.headers.find("Authorization");
+    if (header == req.headers.end() || header->second.empty()) {
         result.error = "Missing Authorization header";
-        return result;
+        return;
     }
     
     // Extract token
-    std::string token = extractToken(authHeader);
-    if (token.empty()) {
+    std::string_view tokenView = extractToken(header->second);
+    if (tokenView.empty()) {
         result.error = "Invalid Authorization header format";
-        return result;
+        return;
+    }
+    
+    // Tokens verified recently skip the structure check, signature and Redis.
+    // The key buffer is per thread and the entry is shared, so a hit copies
+    // no strings until they are assigned into the caller's result.
+    static thread_local std::string cacheKey;
+    tokenDigest(tokenView, cacheKey);
+    std::shared_ptr<const VerifiedToken> verified;
+    if (tokenCache_.get(cacheKey, verified)) {
+        cached = true;
+        result.success = true;
+        result.userId.assign(verified->userId);
+        result.email.assign(verified->email);
+        return;
     }
+    uint64_t cacheGeneration = tokenCache_.generation(cacheKey);
     
     // Verify JWT structure
-    if (!isValidJWTStructure(token)) {
+    if (!isValidJWTStructure(tokenView)) {
         result.error = "Invalid token format";
-        return result;
+        return;
     }
     
-    // Check token in Redis
-    if (!redis_->tokenExists(token)) {
-        result.error = "Token expired or invalid";
-        return result;
+    // jwt-cpp and the Redis key need an owned copy from here on
+    std::string token(tokenView);
+    
+    if (statelessMode_) {
+        authenticateStateless(token, cacheKey, cacheGeneration, result);
+        return;
+    }
+    
+    // The sliding-TTL script needs the blocking client; a plain GET can be in
+    // flight while the signature is checked
+    std::future<AsyncRedisClient::Reply> pendingLookup;
+    bool asyncLookup = asyncRedis_ && tokenSlidingTtl_ <= 0 && asyncRedis_->isConnected();
+    if (asyncLookup) {
+        pendingLookup = asyncRedis_->command({"GET", "token:" + token});
     }
     
-    // Get token data from Redis
-    std::string tokenData = redis_->getToken(token);
+    std::string userId, email;
+    std::optional<std::chrono::system_clock::time_point> expiresAt;
+    bool signatureValid = verifyJWT(token, userId, email, expiresAt);
+    
+    // Check token and get its session data from Redis in one round trip
+    std::string tokenData = asyncLookup ? awaitTokenLookup(pendingLookup, token)
+                                        : redis_->lookupToken(token, tokenSlidingTtl_);
     if (tokenData.empty()) {
-        result.error = "Token not found";
-        return result;
+        result.error = "Token expired or invalid";
+        return;
     }
     
     try {
@@ -52,57 +171,100 @@ AuthMiddleware::AuthResult AuthMiddleware::authenticate(const httplib::Request&
         json cachedData = json::parse(tokenData);
         
         // Verify JWT signature
-        std::string userId, email;
-        if (!verifyJWT(token, userId, email)) {
+        if (!signatureValid) {
             result.error = "Invalid token signature";
-            return result;
+            return;
         }
         
-        // Cross-check with cached data
-        if (cachedData.contains("userId") && cachedData.contains("email")) {
-            if (cachedData["userId"] != userId || cachedData["email"] != email) {
+        // Cross-check with cached data, comparing the stored strings in place
+        // rather than building a json value from each claim
+        auto sessionUserId = cachedData.find("userId");
+        auto sessionEmail = cachedData.find("email");
+        if (sessionUserId != cachedData.end() && sessionEmail != cachedData.end()) {
+            if (!sessionUserId->is_string() || !sessionEmail->is_string() ||
+                sessionUserId->get_ref<const std::string&>() != userId ||
+                sessionEmail->get_ref<const std::string&>() != email) {
                 result.error = "Token data mismatch";
-                return result;
+                return;
             }
         }
         
         result.success = true;
-        result.userId = userId;
-        result.email = email;
+        result.userId.assign(userId);
+        result.email.assign(email);
+        cacheVerifiedToken(cacheKey, std::move(userId), std::move(email), expiresAt, cacheGeneration);
         
     } catch (const std::exception& e) {
         result.error = "Token verification failed: " + std::string(e.what());
     }
+}
+
+void AuthMiddleware::authenticateStateless(const std::string& token, const std::string& cacheKey,
+                                           uint64_t cacheGeneration, AuthResult& result) {
+    std::string userId, email;
+    std::optional<std::chrono::system_clock::time_point> expiresAt;
+    if (!verifyJWT(token, userId, email, expiresAt)) {
+        result.error = "Invalid token signature";
+        return;
+    }
     
-    return result;
+    // With no session to expire, exp is all that bounds the token's lifetime
+    if (!expiresAt) {
+        result.error = "Token has no expiry";
+        return;
+    }
+    
+    if (revocations_->isRevoked(cacheKey)) {
+        result.error = "Token expired or invalid";
+        return;
+    }
+    
+    result.success = true;
+    result.userId.assign(userId);
+    result.email.assign(email);
+    cacheVerifiedToken(cacheKey, std::move(userId), std::move(email), expiresAt, cacheGeneration);
+}
+
+void AuthMiddleware::cacheVerifiedToken(const std::string& cacheKey, std::string userId, std::string email,
+                                        const std::optional<std::chrono::system_clock::time_point>& expiresAt,
+                                        uint64_t cacheGeneration) {
+    // Never cache past the token's own expiry
+    auto cacheExpiry = TokenCache::Clock::now() + tokenCacheTtl_;
+    if (expiresAt) {
+        cacheExpiry = std::min(cacheExpiry, TokenCache::Clock::now() +
+            std::chrono::duration_cast<TokenCache::Clock::duration>(
+                *expiresAt - std::chrono::system_clock::now()));
+    }
+    tokenCache_.put(cacheKey, std::make_shared<const VerifiedToken>(VerifiedToken{std::move(userId), std::move(email)}),
+                    cacheExpiry, cacheGeneration);
 }
 
-bool AuthMiddleware::requireAuth(const httplib::Request& req, httplib::Response& res) {
-    AuthResult authResult = authenticate(req);
+bool AuthMiddleware::requireAuth(const httplib::Request& req, httplib::Response& res, RequestContext& context) {
+    // Reused across this thread's requests so a cache hit allocates nothing
+    static thread_local AuthResult authResult;
     
-    if (!authResult.success) {
+    if (!authenticate(req, authResult)) {
         json errorResponse = createAuthErrorResponse(authResult.error);
         res.status = 401;
         res.set_content(errorResponse.dump(), "application/json");
         return false;
     }
     
-    // Store user info in request for use by controllers
-    // Note: cpp-httplib doesn't have built-in way to store data in request
-    // We'll pass userId through other means in the controllers
+    context.userId.assign(authResult.userId);
+    context.email.assign(authResult.email);
     
     return true;
 }
 
-std::string AuthMiddleware::extractToken(const std::string& authHeader) {
-    const std::string bearerPrefix = "Bearer ";
+std::string_view AuthMiddleware::extractToken(std::string_view authHeader) {
+    constexpr std::string_view bearerPrefix = "Bearer ";
     
     if (authHeader.length() <= bearerPrefix.length()) {
-        return "";
+        return {};
     }
     
-    if (authHeader.substr(0, bearerPrefix.length()) != bearerPrefix) {
-        return "";
+    if (authHeader.compare(0, bearerPrefix.length(), bearerPrefix) != 0) {
+        return {};
     }
     
     return authHeader.substr(bearerPrefix.length());
@@ -116,95 +278,114 @@ json AuthMiddleware::createAuthErrorResponse(const std::string& message, int sta
     };
 }
 
-bool AuthMiddleware::verifyJWT(const std::string& token, std::string& userId, std::string& email) {
+std::string AuthMiddleware::awaitTokenLookup(std::future<AsyncRedisClient::Reply>& pending,
+                                             const std::string& token) {
+    if (pending.wait_for(asyncRedisTimeout_) == std::future_status::ready) {
+        AsyncRedisClient::Reply reply = pending.get();
+        if (reply.type == REDIS_REPLY_STRING) {
+            return reply.str;
+        }
+        if (!reply.isError()) {
+            return "";
+        }
+    }
+    
+    // Transport error or timeout: retry on the blocking client rather than reject
+    return redis_->lookupToken(token, tokenSlidingTtl_);
+}
+
+json AuthMiddleware::getTokenCacheStats() const {
+    return tokenCache_.getStats();
+}
+
+json AuthMiddleware::getAuthStats() const {
+    return json{
+        {"mode", statelessMode_ ? "stateless" : "session"},
+        {"cached", cachedLatency_.toJson()},
+        {"verified", verifiedLatency_.toJson()},
+        {"revocation", revocations_ ? revocations_->getStats() : json(nullptr)}
+    };
+}
+
+void AuthMiddleware::LatencyCounter::record(uint64_t nanos) {
+    ++count;
+    nanosTotal += nanos;
+    
+    uint64_t currentMax = nanosMax.load();
+    while (nanos > currentMax && !nanosMax.compare_exchange_weak(currentMax, nanos)) {
+    }
+}
+
+json AuthMiddleware::LatencyCounter::toJson() const {
+    uint64_t calls = count.load();
+    return json{
+        {"count", calls},
+        {"ns_total", nanosTotal.load()},
+        {"ns_avg", calls > 0 ? nanosTotal.load() / calls : 0},
+        {"ns_max", nanosMax.load()}
+    };
+}
+
+std::string AuthMiddleware::tokenDigest(std::string_view token) {
+    std::string digest;
+    tokenDigest(token, digest);
+    return digest;
+}
+
+void AuthMiddleware::tokenDigest(std::string_view token, std::string& out) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(token.data()), token.size(), digest);
+    out.assign(reinterpret_cast<const char*>(digest), sizeof(digest));
+}
+
+bool AuthMiddleware::verifyJWT(const std::string& token, std::string& userId, std::string& email,
+                               std::optional<std::chrono::system_clock::time_point>& expiresAt) {
     try {
-        std::cout << "Verifying JWT with secret: " << jwtSecret_.substr(0, 10) << "..." << std::endl;
-        
-        // Decode and verify JWT
         auto decoded = jwt::decode(token);
-        std::cout << "JWT decoded successfully" << std::endl;
-        
-        // Verify signature
-        auto verifier = jwt::verify()
-            .allow_algorithm(jwt::algorithm::hs256{jwtSecret_});
-        
-        std::cout << "About to verify signature..." << std::endl;
-        verifier.verify(decoded);
-        std::cout << "Signature verified successfully" << std::endl;
+        verifier_->verifier.verify(decoded);
         
         // Extract claims
         if (decoded.has_payload_claim("userId")) {
             userId = decoded.get_payload_claim("userId").as_string();
-            std::cout << "Extracted userId: " << userId << std::endl;
         } else {
-            std::cout << "No userId claim found" << std::endl;
             return false;
         }
         
         if (decoded.has_payload_claim("email")) {
             email = decoded.get_payload_claim("email").as_string();
-            std::cout << "Extracted email: " << email << std::endl;
         } else {
-            std::cout << "No email claim found" << std::endl;
             return false;
         }
         
-        return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "JWT verification detailed error: " << e.what() << std::endl;
-        return false;
-    }
-}
-
-json AuthMiddleware::parseJWTPayload(const std::string& token) {
-    try {
-        // Split token into parts
-        std::vector<std::string> parts;
-        std::stringstream ss(token);
-        std::string part;
-        
-        while (std::getline(ss, part, '.')) {
-            parts.push_back(part);
-        }
-        
-        if (parts.size() != 3) {
-            return json{};
+        if (decoded.has_expires_at()) {
+            expiresAt = decoded.get_expires_at();
         }
         
-        // Decode payload (second part)
-        std::string payload = base64Decode(parts[1]);
-        return json::parse(payload);
+        return true;
         
     } catch (const std::exception& e) {
-        return json{};
+        LOG_WARN("JWT verification detailed error: " << e.what());
+        return false;
     }
 }
 
-std::string AuthMiddleware::base64Decode(const std::string& input) {
-    // Simple base64 decode implementation
-    // Note: This is a basic implementation, you might want to use a proper library
-    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    
-    std::string decoded;
-    std::vector<int> T(128, -1);
-    for (int i = 0; i < 64; i++) T[chars[i]] = i;
+bool AuthMiddleware::isValidJWTStructure(std::string_view token) {
+    // Three non-empty base64url segments separated by dots
+    size_t segments = 1;
+    size_t segmentLength = 0;
     
-    int val = 0, valb = -8;
-    for (unsigned char c : input) {
-        if (T[c] == -1) break;
-        val = (val << 6) + T[c];
-        valb += 6;
-        if (valb >= 0) {
-            decoded.push_back(char((val >> valb) & 0xFF));
-            valb -= 8;
+    for (unsigned char c : token) {
+        if (c == '.') {
+            if (segmentLength == 0 || ++segments > 3) {
+                return false;
+            }
+            segmentLength = 0;
+        } else if (!kBase64UrlChars[c]) {
+            return false;
+        } else {
+            ++segmentLength;
         }
     }
-    return decoded;
+    
+    return segments == 3 && segmentLength > 0;
 }
-
-bool AuthMiddleware::isValidJWTStructure(const std::string& token) {
-    // Check if token has the correct JWT structure (3 parts separated by dots)
-    std::regex jwtPattern("^[A-Za-z0-9_-]+\\.[A-Za-z0-9_-]+\\.[A-Za-z0-9_-]+$");
-    return std::regex_match(token, jwtPattern);
-}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "balance_tool.h"
+#include "split_calculator.h"
+#include <iostream>
+
+static int rebuildAll(Database& db) {
+    auto eventIds = db.getEventIds();
+    
+    for (const auto& eventId : eventIds) {
+        db.rebuildEventBalances(eventId);
+    }
+    
+    std::cout << "Rebuilt balances for " << eventIds.size() << " events" << std::endl;
+    return 0;
+}
+
+static int verifyAll(Database& db) {
+    auto eventIds = db.getEventIds();
+    size_t mismatched = 0;
+    
+    for (const auto& eventId : eventIds) {
+        auto event = db.getEvent(eventId);
+        if (!event) {
+            continue;  // Deleted since the id list was read
+        }
+        
+        auto expenses = db.getExpensesByEvent(eventId);
+        auto participants = db.getParticipantsByEvent(eventId);
+        
+        Participant creator;
+        creator.userId = event->creatorId;
+        creator.status = "active";
+        participants.push_back(creator);
+        
+        auto expected = SplitCalculator::calculateUserBalances(expenses, participants);
+        auto actual = db.getEventBalances(eventId);
+        
+        if (expected == actual) {
+            continue;
+        }
+        
+        ++mismatched;
+        std::cerr << "Balance mismatch for event " << eventId << std::endl;
+        for (const auto& [userId, cents] : expected) {
+            auto it = actual.find(userId);
+            if (it == actual.end() || it->second != cents) {
+                std::cerr << "  " << userId << ": expected " << cents << " cents, ledger "
+                          << (it == actual.end() ? std::string("missing") : std::to_string(it->second))
+                          << std::endl;
+            }
+        }
+        for (const auto& [userId, cents] : actual) {
+            if (expected.find(userId) == expected.end()) {
+                std::cerr << "  " << userId << ": not a member, ledger " << cents << std::endl;
+            }
+        }
+    }
+    
+    std::cout << "Verified " << eventIds.size() << " events, " << mismatched << " mismatched" << std::endl;
+    return mismatched == 0 ? 0 : 1;
+}
+
+bool isBalanceToolCommand(const std::string& arg) {
+    return arg == "--rebuild-balances" || arg == "--verify-balances";
+}
+
+int runBalanceTool(Database& db, const std::string& command) {
+    try {
+        if (command == "--rebuild-balances") {
+            return rebuildAll(db);
+        }
+        return verifyAll(db);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Balance tool failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
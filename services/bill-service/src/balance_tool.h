@@ -0,0 +1,14 @@
+#ifndef BALANCE_TOOL_H
+#define BALANCE_TOOL_H
+
+#include <string>
+#include "database.h"
+
+// Maintenance commands for the event_balances ledger:
+//   bill-service --rebuild-balances   recompute every event's ledger in SQL
+//   bill-service --verify-balances    compare the ledger with SplitCalculator
+//                                     over the raw expenses (exit 1 on drift)
+bool isBalanceToolCommand(const std::string& arg);
+int runBalanceTool(Database& db, const std::string& command);
+
+#endif
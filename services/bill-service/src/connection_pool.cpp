@@ -0,0 +1,250 @@
+#include "connection_pool.h"
+#include "logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, PooledConnection entry)
+    : pool_(pool), entry_(std::move(entry)) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), entry_(std::move(other.entry_)) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool_ && entry_.conn) {
+        pool_->release(std::move(entry_));
+    }
+}
+
+ConnectionPool::ConnectionPool(Config config) : config_(std::move(config)) {
+    if (config_.maxSize == 0) {
+        config_.maxSize = 1;
+    }
+    if (config_.minIdle > config_.maxSize) {
+        config_.minIdle = config_.maxSize;
+    }
+}
+
+ConnectionPool::~ConnectionPool() {
+    shutdown();
+}
+
+bool ConnectionPool::warmUp() {
+    size_t target = std::max<size_t>(config_.minIdle, 1);
+
+    for (size_t i = 0; i < target; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (shutdown_ || total_ >= target) {
+                break;
+            }
+            ++total_;
+        }
+
+        try {
+            PooledConnection entry = openConnection();
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.push_back(std::move(entry));
+        } catch (const std::exception& e) {
+            LOG_ERROR("Database connection failed: " << e.what());
+            std::lock_guard<std::mutex> lock(mutex_);
+            --total_;
+            return false;
+        }
+    }
+
+    available_.notify_all();
+    return true;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    auto start = Clock::now();
+    auto deadline = start + config_.acquireTimeout;
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        if (shutdown_) {
+            throw std::runtime_error("Connection pool is shut down");
+        }
+
+        // Reuse the most recently returned connection so that rarely used ones age out
+        while (!idle_.empty()) {
+            PooledConnection entry = std::move(idle_.back());
+            idle_.pop_back();
+            ++inUse_;
+            lock.unlock();
+
+            if (isHealthy(entry, Clock::now())) {
+                ++acquired_;
+                if (waited) recordWait(start);
+                return Lease(this, std::move(entry));
+            }
+
+            // Destroy the dead connection outside the lock
+            entry.conn.reset();
+            ++evictedBroken_;
+
+            lock.lock();
+            --inUse_;
+            --total_;
+        }
+
+        if (total_ < config_.maxSize) {
+            ++total_;
+            ++inUse_;
+            lock.unlock();
+
+            try {
+                PooledConnection entry = openConnection();
+                ++acquired_;
+                if (waited) recordWait(start);
+                return Lease(this, std::move(entry));
+            } catch (...) {
+                lock.lock();
+                --total_;
+                --inUse_;
+                lock.unlock();
+                available_.notify_one();
+                throw;
+            }
+        }
+
+        // Every connection is checked out
+        if (!waited) {
+            waited = true;
+            ++saturated_;
+            ++waits_;
+        }
+
+        if (available_.wait_until(lock, deadline) == std::cv_status::timeout &&
+            idle_.empty() && total_ >= config_.maxSize) {
+            ++timeouts_;
+            recordWait(start);
+            throw std::runtime_error("Timed out waiting for a database connection");
+        }
+    }
+}
+
+void ConnectionPool::shutdown() {
+    std::deque<PooledConnection> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+        closing.swap(idle_);
+        total_ -= closing.size();
+    }
+    available_.notify_all();
+}
+
+json ConnectionPool::getStats() const {
+    size_t total, inUse, idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        total = total_;
+        inUse = inUse_;
+        idle = idle_.size();
+    }
+
+    uint64_t waits = waits_.load();
+
+    return json{
+        {"max_size", config_.maxSize},
+        {"size", total},
+        {"in_use", inUse},
+        {"idle", idle},
+        {"acquired", acquired_.load()},
+        {"saturated", saturated_.load()},
+        {"timeouts", timeouts_.load()},
+        {"waits", waits},
+        {"wait_us_total", waitMicrosTotal_.load()},
+        {"wait_us_avg", waits > 0 ? waitMicrosTotal_.load() / waits : 0},
+        {"wait_us_max", waitMicrosMax_.load()},
+        {"created", created_.load()},
+        {"evicted_idle", evictedIdle_.load()},
+        {"evicted_broken", evictedBroken_.load()}
+    };
+}
+
+ConnectionPool::PooledConnection ConnectionPool::openConnection() {
+    auto conn = std::make_unique<pqxx::connection>(config_.connectionString);
+    if (!conn->is_open()) {
+        throw std::runtime_error("Database connection failed");
+    }
+
+    if (config_.onConnect) {
+        config_.onConnect(*conn);
+    }
+
+    ++created_;
+    auto now = Clock::now();
+    return PooledConnection{std::move(conn), now, now};
+}
+
+bool ConnectionPool::isHealthy(PooledConnection& entry, Clock::time_point now) {
+    if (!entry.conn || !entry.conn->is_open() || isExpired(entry, now)) {
+        return false;
+    }
+
+    if (now - entry.lastUsed < config_.validationInterval) {
+        return true;
+    }
+
+    try {
+        pqxx::nontransaction txn(*entry.conn);
+        txn.exec("SELECT 1");
+        return true;
+    } catch (const std::exception& e) {
+        LOG_WARN("Discarding unhealthy database connection: " << e.what());
+        return false;
+    }
+}
+
+bool ConnectionPool::isExpired(const PooledConnection& entry, Clock::time_point now) const {
+    return config_.maxLifetime.count() > 0 && now - entry.createdAt >= config_.maxLifetime;
+}
+
+void ConnectionPool::release(PooledConnection entry) {
+    std::vector<PooledConnection> closing;
+    auto now = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --inUse_;
+
+        // A connection that failed mid-query reports !is_open() and is dropped here
+        if (shutdown_ || !entry.conn->is_open() || isExpired(entry, now)) {
+            --total_;
+            ++evictedBroken_;
+            closing.push_back(std::move(entry));
+        } else {
+            entry.lastUsed = now;
+            idle_.push_back(std::move(entry));
+        }
+
+        // Trim connections that have sat unused for too long
+        while (idle_.size() > config_.minIdle &&
+               now - idle_.front().lastUsed >= config_.idleTimeout) {
+            closing.push_back(std::move(idle_.front()));
+            idle_.pop_front();
+            --total_;
+            ++evictedIdle_;
+        }
+    }
+
+    available_.notify_one();
+}
+
+void ConnectionPool::recordWait(Clock::time_point start) {
+    uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+
+    waitMicrosTotal_ += micros;
+
+    uint64_t currentMax = waitMicrosMax_.load();
+    while (micros > currentMax && !waitMicrosMax_.compare_exchange_weak(currentMax, micros)) {
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+class ConnectionPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        std::string connectionString;
+        size_t maxSize = 20;
+        size_t minIdle = 2;
+        std::chrono::milliseconds acquireTimeout{5000};
+        std::chrono::seconds idleTimeout{300};
+        std::chrono::seconds maxLifetime{1800};
+        // Connections idle longer than this are pinged before being handed out
+        std::chrono::seconds validationInterval{30};
+        // Runs once on every new connection, e.g. to prepare statements
+        std::function<void(pqxx::connection&)> onConnect;
+    };
+
+private:
+    struct PooledConnection {
+        std::unique_ptr<pqxx::connection> conn;
+        Clock::time_point createdAt;
+        Clock::time_point lastUsed;
+    };
+
+public:
+    // RAII checkout: the connection goes back to the pool when the lease is destroyed
+    class Lease {
+    public:
+        Lease(ConnectionPool* pool, PooledConnection entry);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        pqxx::connection& operator*() { return *entry_.conn; }
+        pqxx::connection* operator->() { return entry_.conn.get(); }
+
+    private:
+        ConnectionPool* pool_;
+        PooledConnection entry_;
+    };
+
+    explicit ConnectionPool(Config config);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    bool warmUp();
+    Lease acquire();
+    void shutdown();
+
+    json getStats() const;
+
+private:
+    Config config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<PooledConnection> idle_;  // front = least recently used
+    size_t total_ = 0;
+    size_t inUse_ = 0;
+    bool shutdown_ = false;
+
+    // Counters
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> waitMicrosTotal_{0};
+    std::atomic<uint64_t> waitMicrosMax_{0};
+    std::atomic<uint64_t> saturated_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> created_{0};
+    std::atomic<uint64_t> evictedIdle_{0};
+    std::atomic<uint64_t> evictedBroken_{0};
+
+    PooledConnection openConnection();
+    bool isHealthy(PooledConnection& entry, Clock::time_point now);
+    bool isExpired(const PooledConnection& entry, Clock::time_point now) const;
+    void release(PooledConnection entry);
+    void recordWait(Clock::time_point start);
+};
+
+#endif
@@ -1,9 +1,214 @@
 #include "database.h"
+#include "prepared_statements.h"
 #include "utils.h"
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <string_view>
 
-Database::Database() {
+// Optional text parameters are passed as SQL NULL when empty
+static const char* nullIfEmpty(const std::string& value) {
+    return value.empty() ? nullptr : value.c_str();
+}
+
+static const char* optionalField(const json& updates, const char* key) {
+    if (!updates.contains(key) || !updates[key].is_string()) {
+        return nullptr;
+    }
+    return updates[key].get_ref<const std::string&>().c_str();
+}
+
+static std::string accessCacheKey(const std::string& eventId, const std::string& userId) {
+    return eventId + ":" + userId;
+}
+
+// Row decoders; column order matches the statements in prepared_statements.cpp
+
+static std::optional<int64_t> optionalInt64(const pqxx::field& field) {
+    if (field.is_null()) {
+        return std::nullopt;
+    }
+    return field.as<int64_t>();
+}
+
+static int64_t int64OrZero(const pqxx::field& field) {
+    return field.is_null() ? 0 : field.as<int64_t>();
+}
+
+static Event eventFromRow(const pqxx::row& row) {
+    Event event;
+    event.id = row[0].c_str();
+    event.creatorId = row[1].c_str();
+    event.name = row[2].c_str();
+    event.description = row[3].c_str();
+    event.eventType = row[4].c_str();
+    event.status = row[5].c_str();
+    event.startDate = optionalInt64(row[6]);
+    event.endDate = optionalInt64(row[7]);
+    event.createdAt = int64OrZero(row[8]);
+    event.updatedAt = int64OrZero(row[9]);
+    
+    if (row.size() > 11) {
+        event.creator = UserSummary{row[10].c_str(), row[11].c_str(), ""};
+    }
+    
+    return event;
+}
+
+static Expense expenseFromRow(const pqxx::row& row) {
+    Expense expense;
+    expense.id = row[0].c_str();
+    expense.eventId = row[1].c_str();
+    expense.payerId = row[2].c_str();
+    expense.amountCents = row[3].as<int64_t>();
+    expense.description = row[4].c_str();
+    expense.splitType = row[5].c_str();
+    expense.expenseDate = int64OrZero(row[6]);
+    expense.createdAt = int64OrZero(row[7]);
+    
+    if (row.size() > 9) {
+        expense.payer = UserSummary{row[8].c_str(), row[9].c_str(), ""};
+    }
+    
+    return expense;
+}
+
+static Participant participantFromRow(const pqxx::row& row) {
+    Participant participant;
+    participant.id = row[0].c_str();
+    participant.eventId = row[1].c_str();
+    participant.userId = row[2].c_str();
+    if (!row[3].is_null()) participant.sharePercentage = row[3].as<double>();
+    participant.customAmountCents = optionalInt64(row[4]);
+    participant.status = row[5].c_str();
+    participant.joinedAt = int64OrZero(row[6]);
+    
+    if (row.size() > 9) {
+        participant.user = UserSummary{row[7].c_str(), row[8].c_str(), row[9].c_str()};
+    }
+    
+    return participant;
+}
+
+// Row writers for list pages: the same fields, in the same sorted order, as
+// writeJson() in models.cpp, copied from the result buffer straight into the
+// response without building an Event/Expense/Participant first
+
+static std::string_view text(const pqxx::field& field) {
+    return {field.c_str(), field.size()};
+}
+
+static void writeEventRow(JsonWriter& out, const pqxx::row& row) {
+    out.beginObject();
+    out.key("created_at").timestamp(int64OrZero(row[8]));
+    if (row.size() > 11) {
+        out.key("creator").beginObject();
+        out.key("family_name").string(text(row[11]));
+        out.key("name").string(text(row[10]));
+        out.endObject();
+    }
+    if (row[1].size() > 0) out.key("creator_id").string(text(row[1]));
+    out.key("description").string(text(row[3]));
+    if (!row[7].is_null()) out.key("end_date").timestamp(row[7].as<int64_t>());
+    out.key("event_type").string(text(row[4]));
+    out.key("id").string(text(row[0]));
+    out.key("name").string(text(row[2]));
+    if (!row[6].is_null()) out.key("start_date").timestamp(row[6].as<int64_t>());
+    out.key("status").string(text(row[5]));
+    out.key("updated_at").timestamp(int64OrZero(row[9]));
+    out.endObject();
+}
+
+static void writeExpenseRow(JsonWriter& out, const pqxx::row& row) {
+    out.beginObject();
+    out.key("amount").amount(row[3].as<int64_t>());
+    out.key("created_at").timestamp(int64OrZero(row[7]));
+    out.key("description").string(text(row[4]));
+    out.key("event_id").string(text(row[1]));
+    out.key("expense_date").timestamp(int64OrZero(row[6]));
+    out.key("id").string(text(row[0]));
+    if (row.size() > 9) {
+        out.key("payer").beginObject();
+        out.key("family_name").string(text(row[9]));
+        out.key("name").string(text(row[8]));
+        out.endObject();
+    }
+    out.key("payer_id").string(text(row[2]));
+    out.key("split_type").string(text(row[5]));
+    out.endObject();
+}
+
+static void writeParticipantRow(JsonWriter& out, const pqxx::row& row) {
+    out.beginObject();
+    if (!row[4].is_null()) out.key("custom_amount").amount(row[4].as<int64_t>());
+    out.key("event_id").string(text(row[1]));
+    out.key("id").string(text(row[0]));
+    out.key("joined_at").timestamp(int64OrZero(row[6]));
+    if (!row[3].is_null()) out.key("share_percentage").number(row[3].as<double>());
+    out.key("status").string(text(row[5]));
+    if (row.size() > 9) {
+        out.key("user").beginObject();
+        out.key("email").string(text(row[9]));
+        out.key("family_name").string(text(row[8]));
+        out.key("name").string(text(row[7]));
+        out.endObject();
+    }
+    out.key("user_id").string(text(row[2]));
+    out.endObject();
+}
+
+// Keyset listings select the row's sort key (microseconds) after the regular columns
+static constexpr int kCursorColumn = 10;
+
+// Serialize one page of a result set as a JSON array without materializing
+// the rows. Queries fetch limit + 1 rows; the extra row only signals that
+// another page exists, and the cursor points at the last row written.
+template <typename WriteRow>
+static std::optional<PageCursor> writePage(const pqxx::result& result, const PageRequest& page,
+                                           JsonWriter& out, size_t bytesPerRow, WriteRow writeRow) {
+    size_t count = std::min<size_t>(result.size(), page.limit);
+    
+    out.reserve(count * bytesPerRow + 2);
+    out.beginArray();
+    for (size_t i = 0; i < count; ++i) {
+        writeRow(out, result[i]);
+    }
+    out.endArray();
+    
+    if (result.size() <= page.limit) {
+        return std::nullopt;
+    }
+    
+    auto last = result[count - 1];
+    return PageCursor{last[kCursorColumn].as<int64_t>(), last[0].c_str()};
+}
+
+static EventAccess accessFromResult(const pqxx::result& result) {
+    EventAccess access;
+    if (result.size() > 0) {
+        auto row = result[0];
+        access.exists = true;
+        access.eventStatus = row[0].c_str();
+        access.isCreator = row[1].as<bool>();
+        access.isParticipant = row[2].as<bool>();
+    }
+    return access;
+}
+
+static std::map<std::string, int64_t> balancesFromResult(const pqxx::result& result) {
+    std::map<std::string, int64_t> balances;
+    for (const auto& row : result) {
+        balances[row[0].c_str()] = row[1].as<int64_t>();
+    }
+    return balances;
+}
+
+Database::Database()
+    : pipelineReads_(getEnvVar("DB_PIPELINE_READS", "true") == "true"),
+      pipelineMinReads_(std::max<size_t>(2, std::stoul(getEnvVar("DB_PIPELINE_MIN_READS", "2")))),
+      accessCache_(std::stoul(getEnvVar("ACL_CACHE_CAPACITY", "10000")),
+                   std::stoul(getEnvVar("ACL_CACHE_SHARDS", "16")),
+                   std::chrono::milliseconds(std::stol(getEnvVar("ACL_CACHE_TTL_MS", "5000")))) {
     initializeConnection();
 }
 
@@ -18,171 +223,122 @@ void Database::initializeConnection() {
     std::string user = getEnvVar("DB_USER", "billsplitter_user");
     std::string password = getEnvVar("DB_PASSWORD", "");
     
-    connectionString_ = "host=" + host + " port=" + port + " dbname=" + dbname + 
-                       " user=" + user + " password=" + password;
+    poolConfig_.connectionString = "host=" + host + " port=" + port + " dbname=" + dbname + 
+                                   " user=" + user + " password=" + password;
+    poolConfig_.maxSize = std::stoul(getEnvVar("DB_MAX_CONNECTIONS", "20"));
+    poolConfig_.minIdle = std::stoul(getEnvVar("DB_POOL_MIN_IDLE", "2"));
+    poolConfig_.acquireTimeout = std::chrono::milliseconds(
+        std::stol(getEnvVar("DB_POOL_ACQUIRE_TIMEOUT_MS", "5000")));
+    poolConfig_.idleTimeout = std::chrono::seconds(
+        std::stol(getEnvVar("DB_POOL_IDLE_TIMEOUT", "300")));
+    poolConfig_.maxLifetime = std::chrono::seconds(
+        std::stol(getEnvVar("DB_POOL_MAX_LIFETIME", "1800")));
+    poolConfig_.onConnect = prepareStatements;
 }
 
 bool Database::connect() {
-    try {
-        conn_ = std::make_unique<pqxx::connection>(connectionString_);
-        return conn_->is_open();
-    } catch (const std::exception& e) {
-        std::cerr << "Database connection failed: " << e.what() << std::endl;
-        return false;
+    // Leases point at the pool, so it is created once and never replaced
+    if (pool_) {
+        return pool_->warmUp();
     }
+    
+    pool_ = std::make_unique<ConnectionPool>(poolConfig_);
+    return pool_->warmUp();
 }
 
 void Database::disconnect() {
-    if (conn_) {
-        conn_.reset();  // Just reset the pointer, connection closes automatically
+    if (pool_) {
+        pool_->shutdown();  // Idle connections close now, leased ones on return
     }
 }
 
-json Database::createEvent(const std::string& creatorId, const std::string& name,
-                          const std::string& description, const std::string& eventType,
-                          const std::string& startDate, const std::string& endDate) {
+json Database::getPoolStats() const {
+    return pool_ ? pool_->getStats() : json::object();
+}
+
+json Database::getAccessCacheStats() const {
+    return accessCache_.getStats();
+}
+
+json Database::getPipelineStats() const {
+    return json{
+        {"enabled", pipelineReads_},
+        {"min_reads", pipelineMinReads_},
+        {"pipelined_batches", pipelinedBatches_.load()},
+        {"sequential_batches", sequentialBatches_.load()}
+    };
+}
+
+void Database::invalidateAccess(const std::string& eventId, const std::string& userId) {
+    accessCache_.erase(accessCacheKey(eventId, userId));
+}
+
+void Database::invalidateEventAccess(const std::string& eventId) {
+    std::string prefix = eventId + ":";
+    accessCache_.eraseIf([&prefix](const std::string& key) {
+        return key.compare(0, prefix.size(), prefix) == 0;
+    });
+}
+
+
+Event Database::createEvent(const std::string& creatorId, const std::string& name,
+                           const std::string& description, const std::string& eventType,
+                           const std::string& startDate, const std::string& endDate) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        pqxx::result result = txn.exec_prepared(Statements::EventInsert,
+            creatorId, name, description, eventType,
+            nullIfEmpty(startDate), nullIfEmpty(endDate));
         
-        std::string query = "INSERT INTO events (creator_id, name, description, event_type";
-        std::string values = "VALUES ($1, $2, $3, $4";
-        
-        if (!startDate.empty()) {
-            query += ", start_date";
-            values += ", $5";
-        }
-        if (!endDate.empty()) {
-            query += ", end_date";
-            values += (!startDate.empty() ? ", $6" : ", $5");
+        if (result.size() == 0) {
+            throw std::runtime_error("Failed to create event");
         }
         
-        query += ") " + values + ") RETURNING id, created_at";
-        
-        pqxx::result result;
-        if (!startDate.empty() && !endDate.empty()) {
-            result = txn.exec_params(query, creatorId, name, description, eventType, startDate, endDate);
-        } else if (!startDate.empty()) {
-            result = txn.exec_params(query, creatorId, name, description, eventType, startDate);
-        } else {
-            result = txn.exec_params(query, creatorId, name, description, eventType);
-        }
+        Event event = eventFromRow(result[0]);
         
+        // Seed the ledger with the creator's zero balance
+        txn.exec_prepared(Statements::LedgerRebuild, event.id);
         txn.commit();
         
-        if (result.size() > 0) {
-            json event = {
-                {"id", result[0][0].c_str()},
-                {"creator_id", creatorId},
-                {"name", name},
-                {"description", description},
-                {"event_type", eventType},
-                {"status", "active"},
-                {"created_at", result[0][1].c_str()}
-            };
-            
-            if (!startDate.empty()) event["start_date"] = startDate;
-            if (!endDate.empty()) event["end_date"] = endDate;
-            
-            return event;
-        }
-        
-        throw std::runtime_error("Failed to create event");
+        return event;
         
     } catch (const std::exception& e) {
         throw std::runtime_error("Database error: " + std::string(e.what()));
     }
 }
 
-json Database::getEvent(const std::string& eventId) {
+std::optional<Event> Database::getEvent(const std::string& eventId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
-        
-        pqxx::work txn(*conn_);
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT e.id, e.payer_id, e.amount, e.description, e.split_type, e.expense_date, "
-            "e.created_at, u.name as payer_name, u.family_name as payer_family_name "
-            "FROM expenses e "
-            "JOIN users u ON e.payer_id = u.id "
-            "WHERE e.event_id = $1 "
-            "ORDER BY e.expense_date DESC", eventId
-        );
+        pqxx::result result = txn.exec_prepared(Statements::EventById, eventId);
         
         if (result.size() == 0) {
-            return json{};
+            return std::nullopt;
         }
         
-        auto row = result[0];
-        json event = {
-            {"id", row[0].c_str()},
-            {"creator_id", row[1].c_str()},
-            {"name", row[2].c_str()},
-            {"description", row[3].c_str()},
-            {"event_type", row[4].c_str()},
-            {"status", row[5].c_str()},
-            {"created_at", row[8].c_str()},
-            {"updated_at", row[9].c_str()},
-            {"creator", {
-                {"name", row[10].c_str()},
-                {"family_name", row[11].c_str()}
-            }}
-        };
-        
-        if (!row[6].is_null()) event["start_date"] = row[6].c_str();
-        if (!row[7].is_null()) event["end_date"] = row[7].c_str();
-        
-        return event;
+        return eventFromRow(result[0]);
         
     } catch (const std::exception& e) {
         throw std::runtime_error("Database error: " + std::string(e.what()));
     }
 }
 
-json Database::getEventsByUser(const std::string& userId) {
+std::vector<Event> Database::getEventsByUser(const std::string& userId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
-        
-        pqxx::work txn(*conn_);
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT DISTINCT e.id, e.name, e.description, e.event_type, e.status, "
-            "e.start_date, e.end_date, e.created_at "
-            "FROM events e "
-            "LEFT JOIN participants p ON e.id = p.event_id "
-            "WHERE e.creator_id = $1 OR p.user_id = $1 "
-            "ORDER BY e.created_at DESC", userId
-        );
+        pqxx::result result = txn.exec_prepared(Statements::EventsByUser, userId);
         
-        json events = json::array();
+        std::vector<Event> events;
+        events.reserve(result.size());
         
         for (const auto& row : result) {
-            json event = {
-                {"id", row[0].c_str()},
-                {"name", row[1].c_str()},
-                {"description", row[2].c_str()},
-                {"event_type", row[3].c_str()},
-                {"status", row[4].c_str()},
-                {"created_at", row[7].c_str()}
-            };
-            
-            if (!row[5].is_null()) event["start_date"] = row[5].c_str();
-            if (!row[6].is_null()) event["end_date"] = row[6].c_str();
-            
-            events.push_back(event);
+            events.push_back(eventFromRow(row));
         }
         
         return events;
@@ -192,63 +348,49 @@ json Database::getEventsByUser(const std::string& userId) {
     }
 }
 
-json Database::updateEvent(const std::string& eventId, const json& updates) {
+std::optional<PageCursor> Database::writeEventsByUser(const std::string& userId, const PageRequest& page,
+                                                      JsonWriter& out) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
-        
-        if (updates.empty()) {
-            throw std::runtime_error("No updates provided");
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        pqxx::result result = page.after
+            ? txn.exec_prepared(Statements::EventsByUserAfter,
+                  userId, page.after->sortKey, page.after->id, page.limit + 1)
+            : txn.exec_prepared(Statements::EventsByUserPage, userId, page.limit + 1);
         
-        std::string query = "UPDATE events SET ";
-        std::vector<std::string> setClauses;
+        return writePage(result, page, out, 384, writeEventRow);
         
-        for (auto& [key, value] : updates.items()) {
-            std::string clause = key + " = ";
-            if (value.is_string()) {
-                clause += txn.quote(value.get<std::string>());
-            } else if (value.is_null()) {
-                clause += "NULL";
-            } else {
-                clause += txn.quote(value.dump());
-            }
-            setClauses.push_back(clause);
-        }
-        
-        for (size_t i = 0; i < setClauses.size(); ++i) {
-            if (i > 0) query += ", ";
-            query += setClauses[i];
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
+Event Database::updateEvent(const std::string& eventId, const json& updates) {
+    try {
+        if (updates.empty()) {
+            throw std::runtime_error("No updates provided");
         }
         
-        query += ", updated_at = CURRENT_TIMESTAMP";
-        query += " WHERE id = " + txn.quote(eventId);
-        query += " RETURNING id, name, description, event_type, status, start_date, end_date, created_at, updated_at";
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec(query);
+        // Fields missing from the update are passed as NULL and keep their value
+        pqxx::result result = txn.exec_prepared(Statements::EventUpdate,
+            eventId,
+            optionalField(updates, "name"),
+            optionalField(updates, "description"),
+            optionalField(updates, "event_type"),
+            optionalField(updates, "status"),
+            optionalField(updates, "start_date"),
+            optionalField(updates, "end_date"));
         txn.commit();
         
+        // Cached decisions carry the event status
+        invalidateEventAccess(eventId);
+        
         if (result.size() > 0) {
-            auto row = result[0];
-            json event = {
-                {"id", row[0].c_str()},
-                {"name", row[1].c_str()},
-                {"description", row[2].c_str()},
-                {"event_type", row[3].c_str()},
-                {"status", row[4].c_str()},
-                {"created_at", row[7].c_str()},
-                {"updated_at", row[8].c_str()}
-            };
-            
-            if (!row[5].is_null()) event["start_date"] = row[5].c_str();
-            if (!row[6].is_null()) event["end_date"] = row[6].c_str();
-            
-            return event;
+            return eventFromRow(result[0]);
         }
         
         throw std::runtime_error("Event not found");
@@ -260,20 +402,15 @@ json Database::updateEvent(const std::string& eventId, const json& updates) {
 
 bool Database::deleteEvent(const std::string& eventId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
-        
-        pqxx::result result = txn.exec_params(
-            "DELETE FROM events WHERE id = $1", eventId
-        );
+        pqxx::result result = txn.exec_prepared(Statements::EventDelete, eventId);
         
         txn.commit();
         
+        invalidateEventAccess(eventId);
+        
         return result.affected_rows() > 0;
         
     } catch (const std::exception& e) {
@@ -281,84 +418,45 @@ bool Database::deleteEvent(const std::string& eventId) {
     }
 }
 
-json Database::createExpense(const std::string& eventId, const std::string& payerId,
-                            double amount, const std::string& description,
-                            const std::string& splitType) {
+Expense Database::createExpense(const std::string& eventId, const std::string& payerId,
+                               int64_t amountCents, const std::string& description,
+                               const std::string& splitType) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        txn.exec_prepared(Statements::LockEventLedger, eventId);
+        txn.exec_prepared(Statements::EventVersionBump, eventId);
         
-        pqxx::result result = txn.exec_params(
-            "INSERT INTO expenses (event_id, payer_id, amount, description, split_type) "
-            "VALUES ($1, $2, $3, $4, $5) "
-            "RETURNING id, expense_date, created_at",
-            eventId, payerId, amount, description, splitType
-        );
-        
-        txn.commit();
+        pqxx::result result = txn.exec_prepared(Statements::ExpenseInsert,
+            eventId, payerId, amountCents, description, splitType);
         
-        if (result.size() > 0) {
-            return json{
-                {"id", result[0][0].c_str()},
-                {"event_id", eventId},
-                {"payer_id", payerId},
-                {"amount", amount},
-                {"description", description},
-                {"split_type", splitType},
-                {"expense_date", result[0][1].c_str()},
-                {"created_at", result[0][2].c_str()}
-            };
+        if (result.size() == 0) {
+            throw std::runtime_error("Failed to create expense");
         }
         
-        throw std::runtime_error("Failed to create expense");
+        txn.exec_prepared(Statements::LedgerApplyExpense, eventId, payerId, amountCents, 1);
+        txn.commit();
+        
+        return expenseFromRow(result[0]);
         
     } catch (const std::exception& e) {
         throw std::runtime_error("Database error: " + std::string(e.what()));
     }
 }
 
-json Database::getExpensesByEvent(const std::string& eventId) {
+std::vector<Expense> Database::getExpensesByEvent(const std::string& eventId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        pqxx::result result = txn.exec_prepared(Statements::ExpensesByEvent, eventId);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT e.id, e.payer_id, e.amount, e.description, e.split_type, e.expense_date, "
-            "e.created_at, u.name as payer_name, u.family_name as payer_family_name "
-            "FROM expenses e "
-            "JOIN users u ON e.payer_id = u.id "
-            "WHERE e.event_id = $1 "
-            "ORDER BY e.expense_date DESC", eventId
-        );
-        
-        json expenses = json::array();
+        std::vector<Expense> expenses;
+        expenses.reserve(result.size());
         
         for (const auto& row : result) {
-            json expense = {
-                {"id", row[0].c_str()},
-                {"payer_id", row[1].c_str()},         // NEW: payer_id
-                {"amount", row[2].as<double>()},      // FIXED: was row[1], now row[2]
-                {"description", row[3].c_str()},      // FIXED: was row[2], now row[3]
-                {"split_type", row[4].c_str()},       // FIXED: was row[3], now row[4]
-                {"expense_date", row[5].c_str()},     // FIXED: was row[4], now row[5]
-                {"created_at", row[6].c_str()},       // FIXED: was row[5], now row[6]
-                {"payer", {
-                    {"name", row[7].c_str()},         // FIXED: was row[6], now row[7]
-                    {"family_name", row[8].c_str()}   // FIXED: was row[7], now row[8]
-                }}
-            };
-            
-            expenses.push_back(expense);
+            expenses.push_back(expenseFromRow(row));
         }
         
         return expenses;
@@ -368,44 +466,36 @@ json Database::getExpensesByEvent(const std::string& eventId) {
     }
 }
 
-json Database::getExpense(const std::string& expenseId) {
+std::optional<PageCursor> Database::writeExpensesByEvent(const std::string& eventId, const PageRequest& page,
+                                                         JsonWriter& out) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        pqxx::result result = page.after
+            ? txn.exec_prepared(Statements::ExpensesByEventAfter,
+                  eventId, page.after->sortKey, page.after->id, page.limit + 1)
+            : txn.exec_prepared(Statements::ExpensesByEventPage, eventId, page.limit + 1);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT e.id, e.event_id, e.payer_id, e.amount, e.description, "
-            "e.split_type, e.expense_date, e.created_at, "
-            "u.name as payer_name, u.family_name as payer_family_name "
-            "FROM expenses e "
-            "JOIN users u ON e.payer_id = u.id "
-            "WHERE e.id = $1", expenseId
-        );
+        return writePage(result, page, out, 384, writeExpenseRow);
+        
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
+std::optional<Expense> Database::getExpense(const std::string& expenseId) {
+    try {
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        pqxx::result result = txn.exec_prepared(Statements::ExpenseById, expenseId);
         
         if (result.size() == 0) {
-            return json{};
+            return std::nullopt;
         }
         
-        auto row = result[0];
-        return json{
-            {"id", row[0].c_str()},
-            {"event_id", row[1].c_str()},
-            {"payer_id", row[2].c_str()},
-            {"amount", row[3].as<double>()},
-            {"description", row[4].c_str()},
-            {"split_type", row[5].c_str()},
-            {"expense_date", row[6].c_str()},
-            {"created_at", row[7].c_str()},
-            {"payer", {
-                {"name", row[8].c_str()},
-                {"family_name", row[9].c_str()}
-            }}
-        };
+        return expenseFromRow(result[0]);
         
     } catch (const std::exception& e) {
         throw std::runtime_error("Database error: " + std::string(e.what()));
@@ -414,64 +504,63 @@ json Database::getExpense(const std::string& expenseId) {
 
 bool Database::deleteExpense(const std::string& expenseId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        // The event row is locked before the expense row, the same order
+        // as every other ledger writer
+        pqxx::result owner = txn.exec_prepared(Statements::ExpenseEventId, expenseId);
+        
+        if (owner.size() == 0) {
+            return false;
         }
         
-        pqxx::work txn(*conn_);
+        std::string eventId = owner[0][0].c_str();
+        txn.exec_prepared(Statements::LockEventLedger, eventId);
         
-        pqxx::result result = txn.exec_params(
-            "DELETE FROM expenses WHERE id = $1", expenseId
-        );
+        // A concurrent delete may have won the lock first
+        pqxx::result result = txn.exec_prepared(Statements::ExpenseDelete, expenseId);
+        
+        if (result.size() == 0) {
+            return false;
+        }
         
+        // Reverse the expense's effect on the ledger
+        auto row = result[0];
+        txn.exec_prepared(Statements::EventVersionBump, eventId);
+        txn.exec_prepared(Statements::LedgerApplyExpense,
+            eventId, row[1].c_str(), row[2].as<int64_t>(), -1);
         txn.commit();
         
-        return result.affected_rows() > 0;
+        return true;
         
     } catch (const std::exception& e) {
         return false;
     }
 }
 
-json Database::addParticipant(const std::string& eventId, const std::string& userId,
-                             double sharePercentage, double customAmount) {
+Participant Database::addParticipant(const std::string& eventId, const std::string& userId,
+                                     double sharePercentage, int64_t customAmountCents) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
-        
-        pqxx::work txn(*conn_);
-        
-        std::string query = "INSERT INTO participants (event_id, user_id";
-        std::string values = "VALUES (" + txn.quote(eventId) + ", " + txn.quote(userId);
-        
-        if (sharePercentage > 0) {
-            query += ", share_percentage";
-            values += ", " + std::to_string(sharePercentage);
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        if (customAmount > 0) {
-            query += ", custom_amount";
-            values += ", " + std::to_string(customAmount);
-        }
+        txn.exec_prepared(Statements::LockEventLedger, eventId);
+        txn.exec_prepared(Statements::EventVersionBump, eventId);
         
-        query += ") " + values + ") RETURNING id, joined_at";
+        pqxx::result result = txn.exec_prepared(Statements::ParticipantInsert,
+            eventId, userId,
+            sharePercentage > 0 ? sharePercentage : 0.0,
+            customAmountCents > 0 ? customAmountCents : int64_t{0});
         
-        pqxx::result result = txn.exec(query);
+        // Membership changed, so every expense is re-split
+        txn.exec_prepared(Statements::LedgerRebuild, eventId);
         txn.commit();
         
+        invalidateAccess(eventId, userId);
+        
         if (result.size() > 0) {
-            return json{
-                {"id", result[0][0].c_str()},
-                {"event_id", eventId},
-                {"user_id", userId},
-                {"status", "active"},
-                {"joined_at", result[0][1].c_str()}
-            };
+            return participantFromRow(result[0]);
         }
         
         throw std::runtime_error("Failed to add participant");
@@ -481,44 +570,18 @@ json Database::addParticipant(const std::string& eventId, const std::string& use
     }
 }
 
-json Database::getParticipantsByEvent(const std::string& eventId) {
+std::vector<Participant> Database::getParticipantsByEvent(const std::string& eventId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                throw std::runtime_error("Database connection failed");
-            }
-        }
-        
-        pqxx::work txn(*conn_);
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT p.id, p.user_id, p.share_percentage, p.custom_amount, "
-            "p.status, p.joined_at, u.name, u.family_name, u.email "
-            "FROM participants p "
-            "JOIN users u ON p.user_id = u.id "
-            "WHERE p.event_id = $1 AND p.status = 'active' "
-            "ORDER BY p.joined_at", eventId
-        );
+        pqxx::result result = txn.exec_prepared(Statements::ParticipantsByEvent, eventId);
         
-        json participants = json::array();
+        std::vector<Participant> participants;
+        participants.reserve(result.size());
         
         for (const auto& row : result) {
-            json participant = {
-                {"id", row[0].c_str()},
-                {"user_id", row[1].c_str()},
-                {"status", row[4].c_str()},
-                {"joined_at", row[5].c_str()},
-                {"user", {
-                    {"name", row[6].c_str()},
-                    {"family_name", row[7].c_str()},
-                    {"email", row[8].c_str()}
-                }}
-            };
-            
-            if (!row[2].is_null()) participant["share_percentage"] = row[2].as<double>();
-            if (!row[3].is_null()) participant["custom_amount"] = row[3].as<double>();
-            
-            participants.push_back(participant);
+            participants.push_back(participantFromRow(row));
         }
         
         return participants;
@@ -528,23 +591,41 @@ json Database::getParticipantsByEvent(const std::string& eventId) {
     }
 }
 
+std::optional<PageCursor> Database::writeParticipantsByEvent(const std::string& eventId, const PageRequest& page,
+                                                             JsonWriter& out) {
+    try {
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        pqxx::result result = page.after
+            ? txn.exec_prepared(Statements::ParticipantsByEventAfter,
+                  eventId, page.after->sortKey, page.after->id, page.limit + 1)
+            : txn.exec_prepared(Statements::ParticipantsByEventPage, eventId, page.limit + 1);
+        
+        return writePage(result, page, out, 320, writeParticipantRow);
+        
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
 bool Database::removeParticipant(const std::string& eventId, const std::string& userId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
-        }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        txn.exec_prepared(Statements::LockEventLedger, eventId);
+        txn.exec_prepared(Statements::EventVersionBump, eventId);
         
-        pqxx::result result = txn.exec_params(
-            "DELETE FROM participants WHERE event_id = $1 AND user_id = $2", 
-            eventId, userId
-        );
+        pqxx::result result = txn.exec_prepared(Statements::ParticipantDelete, eventId, userId);
         
+        if (result.affected_rows() > 0) {
+            txn.exec_prepared(Statements::LedgerRebuild, eventId);
+        }
         txn.commit();
         
+        invalidateAccess(eventId, userId);
+        
         return result.affected_rows() > 0;
         
     } catch (const std::exception& e) {
@@ -553,35 +634,24 @@ bool Database::removeParticipant(const std::string& eventId, const std::string&
 }
 
 bool Database::updateParticipant(const std::string& eventId, const std::string& userId,
-                                double sharePercentage, double customAmount) {
+                                double sharePercentage, int64_t customAmountCents) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
-        }
-        
-        pqxx::work txn(*conn_);
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        std::string query = "UPDATE participants SET ";
+        // Same lock order as the other event writers
+        txn.exec_prepared(Statements::LockEventLedger, eventId);
+        txn.exec_prepared(Statements::EventVersionBump, eventId);
         
-        if (sharePercentage > 0) {
-            query += "share_percentage = " + std::to_string(sharePercentage);
-        } else {
-            query += "share_percentage = NULL";
-        }
+        pqxx::result result = txn.exec_prepared(Statements::ParticipantUpdate,
+            eventId, userId,
+            sharePercentage > 0 ? sharePercentage : 0.0,
+            customAmountCents > 0 ? customAmountCents : int64_t{0});
         
-        if (customAmount > 0) {
-            query += ", custom_amount = " + std::to_string(customAmount);
-        } else {
-            query += ", custom_amount = NULL";
+        // Keep the ledger derived from the current participant rows
+        if (result.affected_rows() > 0) {
+            txn.exec_prepared(Statements::LedgerRebuild, eventId);
         }
-        
-        query += ", updated_at = CURRENT_TIMESTAMP";
-        query += " WHERE event_id = " + txn.quote(eventId);
-        query += " AND user_id = " + txn.quote(userId);
-        
-        pqxx::result result = txn.exec(query);
         txn.commit();
         
         return result.affected_rows() > 0;
@@ -591,40 +661,81 @@ bool Database::updateParticipant(const std::string& eventId, const std::string&
     }
 }
 
-bool Database::userExists(const std::string& userId) {
+std::map<std::string, int64_t> Database::getEventBalances(const std::string& eventId) {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        return balancesFromResult(txn.exec_prepared(Statements::BalancesByEvent, eventId));
+        
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
+UserBalanceSummary Database::getUserBalances(const std::string& userId) {
+    try {
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        pqxx::result result = txn.exec_prepared(Statements::BalancesByUser, userId);
+        
+        UserBalanceSummary summary;
+        summary.events.reserve(result.size());
+        
+        for (const auto& row : result) {
+            summary.events.push_back({row[0].c_str(), row[1].c_str(), row[2].as<int64_t>()});
+            summary.totalCents = row[3].as<int64_t>();
         }
         
-        pqxx::work txn(*conn_);
+        return summary;
         
-        pqxx::result result = txn.exec_params(
-            "SELECT 1 FROM users WHERE id = $1 AND is_active = true", userId
-        );
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
+void Database::rebuildEventBalances(const std::string& eventId) {
+    try {
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        return result.size() > 0;
+        txn.exec_prepared(Statements::LockEventLedger, eventId);
+        txn.exec_prepared(Statements::EventVersionBump, eventId);
+        txn.exec_prepared(Statements::LedgerRebuild, eventId);
+        txn.commit();
         
     } catch (const std::exception& e) {
-        return false;
+        throw std::runtime_error("Database error: " + std::string(e.what()));
     }
 }
 
-bool Database::eventExists(const std::string& eventId) {
+std::vector<std::string> Database::getEventIds() {
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        pqxx::result result = txn.exec_prepared(Statements::EventIds);
+        
+        std::vector<std::string> ids;
+        ids.reserve(result.size());
+        for (const auto& row : result) {
+            ids.emplace_back(row[0].c_str());
         }
         
-        pqxx::work txn(*conn_);
+        return ids;
+        
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
+bool Database::userExists(const std::string& userId) {
+    try {
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT 1 FROM events WHERE id = $1", eventId
-        );
+        pqxx::result result = txn.exec_prepared(Statements::UserExists, userId);
         
         return result.size() > 0;
         
@@ -633,45 +744,138 @@ bool Database::eventExists(const std::string& eventId) {
     }
 }
 
-bool Database::isEventCreator(const std::string& eventId, const std::string& userId) {
+EventAccess Database::resolveEventAccess(const std::string& eventId, const std::string& userId) {
+    std::string cacheKey = accessCacheKey(eventId, userId);
+    
+    EventAccess cached;
+    if (accessCache_.get(cacheKey, cached)) {
+        return cached;
+    }
+    
+    // Taken before the query so a concurrent invalidation keeps the result out of the cache
+    uint64_t generation = accessCache_.generation(cacheKey);
+    
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        EventAccess access = accessFromResult(
+            txn.exec_prepared(Statements::ResolveEventAccess, eventId, userId));
+        
+        accessCache_.put(cacheKey, access, generation);
+        return access;
+        
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error: " + std::string(e.what()));
+    }
+}
+
+std::vector<pqxx::result> Database::readBatch(pqxx::transaction_base& txn,
+                                              const std::vector<BatchedRead>& reads) {
+    std::vector<pqxx::result> results;
+    results.reserve(reads.size());
+    
+    if (!pipelineReads_ || reads.size() < pipelineMinReads_) {
+        ++sequentialBatches_;
+        for (const auto& read : reads) {
+            results.push_back(txn.exec_prepared(read.statement,
+                pqxx::prepare::make_dynamic_params(read.params)));
         }
+        return results;
+    }
+    
+    // A pipeline only takes plain queries, so each read is an EXECUTE of the
+    // statement prepareStatements() created on this connection. The server
+    // reuses the prepared plan and all results come back in one round trip.
+    ++pipelinedBatches_;
+    pqxx::pipeline pipe(txn);
+    std::vector<pqxx::pipeline::query_id> ids;
+    ids.reserve(reads.size());
+    
+    for (const auto& read : reads) {
+        std::string query = "EXECUTE " + txn.quote_name(read.statement);
+        for (size_t i = 0; i < read.params.size(); ++i) {
+            query += i == 0 ? "(" : ", ";
+            query += txn.quote(read.params[i]);
+        }
+        if (!read.params.empty()) {
+            query += ")";
+        }
+        ids.push_back(pipe.insert(query));
+    }
+    pipe.complete();
+    
+    for (auto id : ids) {
+        results.push_back(pipe.retrieve(id));
+    }
+    return results;
+}
+
+EventSettlementData Database::loadEventSettlements(const std::string& eventId, const std::string& userId) {
+    std::string cacheKey = accessCacheKey(eventId, userId);
+    
+    EventSettlementData data;
+    bool cached = accessCache_.get(cacheKey, data.access);
+    uint64_t generation = accessCache_.generation(cacheKey);
+    
+    try {
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::work txn(*conn_);
+        std::vector<BatchedRead> reads = {{Statements::VersionedBalancesByEvent, {eventId}}};
+        if (!cached) {
+            reads.push_back({Statements::ResolveEventAccess, {eventId, userId}});
+        }
         
-        pqxx::result result = txn.exec_params(
-            "SELECT 1 FROM events WHERE id = $1 AND creator_id = $2", eventId, userId
-        );
+        auto results = readBatch(txn, reads);
         
-        return result.size() > 0;
+        data.version = results[0][0][0].as<int64_t>();
+        for (const auto& row : results[0]) {
+            if (!row[1].is_null()) {
+                data.balances[row[1].c_str()] = row[2].as<int64_t>();
+            }
+        }
+        if (!cached) {
+            data.access = accessFromResult(results.back());
+            accessCache_.put(cacheKey, data.access, generation);
+        }
+        
+        return data;
         
     } catch (const std::exception& e) {
-        return false;
+        throw std::runtime_error("Database error: " + std::string(e.what()));
     }
 }
 
-bool Database::isParticipant(const std::string& eventId, const std::string& userId) {
+EventDetailData Database::loadEventDetail(const std::string& eventId, const std::string& userId) {
+    std::string cacheKey = accessCacheKey(eventId, userId);
+    
+    EventDetailData data;
+    bool cached = accessCache_.get(cacheKey, data.access);
+    uint64_t generation = accessCache_.generation(cacheKey);
+    
     try {
-        if (!conn_ || !conn_->is_open()) {
-            if (!connect()) {
-                return false;
-            }
+        auto conn = pool_->acquire();
+        pqxx::work txn(*conn);
+        
+        std::vector<BatchedRead> reads = {{Statements::EventById, {eventId}}};
+        if (!cached) {
+            reads.push_back({Statements::ResolveEventAccess, {eventId, userId}});
         }
         
-        pqxx::work txn(*conn_);
+        auto results = readBatch(txn, reads);
         
-        pqxx::result result = txn.exec_params(
-            "SELECT 1 FROM participants WHERE event_id = $1 AND user_id = $2 AND status = 'active'", 
-            eventId, userId
-        );
+        if (results[0].size() > 0) {
+            data.event = eventFromRow(results[0][0]);
+        }
+        if (!cached) {
+            data.access = accessFromResult(results[1]);
+            accessCache_.put(cacheKey, data.access, generation);
+        }
         
-        return result.size() > 0;
+        return data;
         
     } catch (const std::exception& e) {
-        return false;
+        throw std::runtime_error("Database error: " + std::string(e.what()));
     }
-}
\ No newline at end of file
+}
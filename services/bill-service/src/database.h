@@ -2,13 +2,40 @@
 #define DATABASE_H
 
 #include <pqxx/pqxx>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "connection_pool.h"
+#include "models.h"
+#include "pagination.h"
+#include "sharded_cache.h"
 
 using json = nlohmann::json;
 
+// Existence of an event and the caller's role in it, resolved in one query
+struct EventAccess {
+    bool exists = false;
+    bool isCreator = false;
+    bool isParticipant = false;
+    std::string eventStatus;
+};
+
+// Reads the settlements and event-detail handlers need, fetched in one batch
+struct EventSettlementData {
+    EventAccess access;
+    std::map<std::string, int64_t> balances;
+    int64_t version = 0;  // event change counter the balances were read at, see EventVersionBump
+};
+
+struct EventDetailData {
+    EventAccess access;
+    std::optional<Event> event;
+};
+
 class Database {
 public:
     Database();
@@ -18,42 +45,80 @@ public:
     void disconnect();
     
     // Events operations
-    json createEvent(const std::string& creatorId, const std::string& name, 
-                     const std::string& description, const std::string& eventType,
-                     const std::string& startDate = "", const std::string& endDate = "");
-    json getEvent(const std::string& eventId);
-    json getEventsByUser(const std::string& userId);
-    json updateEvent(const std::string& eventId, const json& updates);
+    Event createEvent(const std::string& creatorId, const std::string& name, 
+                      const std::string& description, const std::string& eventType,
+                      const std::string& startDate = "", const std::string& endDate = "");
+    std::optional<Event> getEvent(const std::string& eventId);
+    std::vector<Event> getEventsByUser(const std::string& userId);
+    // Listings write one keyset page into the response and return the cursor
+    // of the next page, if there is one
+    std::optional<PageCursor> writeEventsByUser(const std::string& userId, const PageRequest& page,
+                                                JsonWriter& out);
+    Event updateEvent(const std::string& eventId, const json& updates);
     bool deleteEvent(const std::string& eventId);
     
     // Expenses operations
-    json createExpense(const std::string& eventId, const std::string& payerId,
-                       double amount, const std::string& description,
-                       const std::string& splitType = "equal");
-    json getExpensesByEvent(const std::string& eventId);
-    json getExpense(const std::string& expenseId);
+    Expense createExpense(const std::string& eventId, const std::string& payerId,
+                          int64_t amountCents, const std::string& description,
+                          const std::string& splitType = "equal");
+    std::vector<Expense> getExpensesByEvent(const std::string& eventId);
+    std::optional<PageCursor> writeExpensesByEvent(const std::string& eventId, const PageRequest& page,
+                                                   JsonWriter& out);
+    std::optional<Expense> getExpense(const std::string& expenseId);
     bool deleteExpense(const std::string& expenseId);
     
     // Participants operations
-    json addParticipant(const std::string& eventId, const std::string& userId,
-                        double sharePercentage = 0.0, double customAmount = 0.0);
-    json getParticipantsByEvent(const std::string& eventId);
+    Participant addParticipant(const std::string& eventId, const std::string& userId,
+                               double sharePercentage = 0.0, int64_t customAmountCents = 0);
+    std::vector<Participant> getParticipantsByEvent(const std::string& eventId);
+    std::optional<PageCursor> writeParticipantsByEvent(const std::string& eventId, const PageRequest& page,
+                                                       JsonWriter& out);
     bool removeParticipant(const std::string& eventId, const std::string& userId);
     bool updateParticipant(const std::string& eventId, const std::string& userId,
-                           double sharePercentage, double customAmount);
+                           double sharePercentage, int64_t customAmountCents);
+    
+    // Balance ledger (event_balances), kept current by the writes above
+    std::map<std::string, int64_t> getEventBalances(const std::string& eventId);
+    UserBalanceSummary getUserBalances(const std::string& userId);
+    void rebuildEventBalances(const std::string& eventId);
+    std::vector<std::string> getEventIds();
     
     // Utility functions
     bool userExists(const std::string& userId);
-    bool eventExists(const std::string& eventId);
-    bool isEventCreator(const std::string& eventId, const std::string& userId);
-    bool isParticipant(const std::string& eventId, const std::string& userId);
+    EventAccess resolveEventAccess(const std::string& eventId, const std::string& userId);
+    
+    // Access check plus the handler's data in a single round trip
+    EventSettlementData loadEventSettlements(const std::string& eventId, const std::string& userId);
+    EventDetailData loadEventDetail(const std::string& eventId, const std::string& userId);
+    
+    // Connection pool wait-time and saturation counters
+    json getPoolStats() const;
+    json getAccessCacheStats() const;
+    json getPipelineStats() const;
 
 private:
-    std::unique_ptr<pqxx::connection> conn_;
-    std::string connectionString_;
+    std::unique_ptr<ConnectionPool> pool_;
+    ConnectionPool::Config poolConfig_;
+    
+    // Batches of at least pipelineMinReads_ reads go through pqxx::pipeline;
+    // smaller ones, or all of them with DB_PIPELINE_READS=false, run one by one
+    bool pipelineReads_;
+    size_t pipelineMinReads_;
+    std::atomic<uint64_t> pipelinedBatches_{0};
+    std::atomic<uint64_t> sequentialBatches_{0};
+    
+    // Short-lived access decisions keyed by (event, user)
+    ShardedCache<EventAccess> accessCache_;
     
     void initializeConnection();
-    json rowToJson(const pqxx::row& row, const std::vector<std::string>& columns);
+    void invalidateAccess(const std::string& eventId, const std::string& userId);
+    void invalidateEventAccess(const std::string& eventId);
+    
+    struct BatchedRead {
+        const char* statement;
+        std::vector<std::string> params;
+    };
+    std::vector<pqxx::result> readBatch(pqxx::transaction_base& txn, const std::vector<BatchedRead>& reads);
 };
 
 #endif
\ No newline at end of file
@@ -4,28 +4,31 @@
 #include <regex>
 #include <set>
 
-EventsController::EventsController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth)
-    : db_(db), auth_(auth) {}
+EventsController::EventsController(std::shared_ptr<Database> db)
+    : db_(db) {}
 
-void EventsController::getEvents(const httplib::Request& req, httplib::Response& res) {
+void EventsController::getEvents(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
+        // Get events for user
+        PageRequest page;
+        std::string pageError;
+        if (!parsePageRequest(req.get_param_value("limit"), req.get_param_value("cursor"), page, pageError)) {
+            json errorResponse = createErrorResponse(pageError);
+            res.status = 400;
             res.set_content(errorResponse.dump(), "application/json");
             return;
         }
-
-        // Get events for user
-        json events = db_->getEventsByUser(authResult.userId);
         
-        json response = createSuccessResponse();
-        response["events"] = events;
+        JsonWriter out;
+        out.beginObject();
+        out.key("events");
+        auto nextCursor = db_->writeEventsByUser(context.userId, page, out);
+        writeNextCursor(out, nextCursor);
+        writeSuccessFields(out);
+        out.endObject();
         
         res.status = 200;
-        res.set_content(response.dump(), "application/json");
+        res.set_content(out.release(), "application/json");
         
     } catch (const std::exception& e) {
         json errorResponse = createErrorResponse("Failed to retrieve events: " + std::string(e.what()), 500);
@@ -34,17 +37,8 @@ void EventsController::getEvents(const httplib::Request& req, httplib::Response&
     }
 }
 
-void EventsController::createEvent(const httplib::Request& req, httplib::Response& res) {
+void EventsController::createEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Parse request body
         json requestBody;
         try {
@@ -67,8 +61,8 @@ void EventsController::createEvent(const httplib::Request& req, httplib::Respons
         }
 
         // Create event
-        json event = db_->createEvent(
-            authResult.userId,
+        Event event = db_->createEvent(
+            context.userId,
             eventReq.name,
             eventReq.description,
             eventReq.eventType,
@@ -77,7 +71,7 @@ void EventsController::createEvent(const httplib::Request& req, httplib::Respons
         );
 
         json response = createSuccessResponse();
-        response["event"] = event;
+        response["event"] = toJson(event);
         
         res.status = 201;
         res.set_content(response.dump(), "application/json");
@@ -89,17 +83,8 @@ void EventsController::createEvent(const httplib::Request& req, httplib::Respons
     }
 }
 
-void EventsController::getEvent(const httplib::Request& req, httplib::Response& res) {
+void EventsController::getEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -110,8 +95,10 @@ void EventsController::getEvent(const httplib::Request& req, httplib::Response&
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Load the event together with the caller's role in it
+        auto detail = db_->loadEventDetail(eventId, context.userId);
+        const auto& access = detail.access;
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -119,21 +106,23 @@ void EventsController::getEvent(const httplib::Request& req, httplib::Response&
         }
 
         // Check if user has access (creator or participant)
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isParticipant = db_->isParticipant(eventId, authResult.userId);
-        
-        if (!isCreator && !isParticipant) {
+        if (!access.isCreator && !access.isParticipant) {
             json errorResponse = createErrorResponse("Access denied", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
             return;
         }
 
-        // Get event details
-        json event = db_->getEvent(eventId);
+        const auto& event = detail.event;
+        if (!event) {
+            json errorResponse = createErrorResponse("Event not found", 404);
+            res.status = 404;
+            res.set_content(errorResponse.dump(), "application/json");
+            return;
+        }
         
         json response = createSuccessResponse();
-        response["event"] = event;
+        response["event"] = toJson(*event);
         
         res.status = 200;
         res.set_content(response.dump(), "application/json");
@@ -145,17 +134,8 @@ void EventsController::getEvent(const httplib::Request& req, httplib::Response&
     }
 }
 
-void EventsController::updateEvent(const httplib::Request& req, httplib::Response& res) {
+void EventsController::updateEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -166,8 +146,9 @@ void EventsController::updateEvent(const httplib::Request& req, httplib::Respons
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -175,7 +156,7 @@ void EventsController::updateEvent(const httplib::Request& req, httplib::Respons
         }
 
         // Check if user is the creator
-        if (!db_->isEventCreator(eventId, authResult.userId)) {
+        if (!access.isCreator) {
             json errorResponse = createErrorResponse("Only event creator can update event", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -213,10 +194,10 @@ void EventsController::updateEvent(const httplib::Request& req, httplib::Respons
         if (!updateReq.endDate.empty()) updates["end_date"] = updateReq.endDate;
 
         // Update event
-        json updatedEvent = db_->updateEvent(eventId, updates);
+        Event updatedEvent = db_->updateEvent(eventId, updates);
         
         json response = createSuccessResponse();
-        response["event"] = updatedEvent;
+        response["event"] = toJson(updatedEvent);
         
         res.status = 200;
         res.set_content(response.dump(), "application/json");
@@ -228,17 +209,8 @@ void EventsController::updateEvent(const httplib::Request& req, httplib::Respons
     }
 }
 
-void EventsController::deleteEvent(const httplib::Request& req, httplib::Response& res) {
+void EventsController::deleteEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -249,8 +221,9 @@ void EventsController::deleteEvent(const httplib::Request& req, httplib::Respons
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -258,7 +231,7 @@ void EventsController::deleteEvent(const httplib::Request& req, httplib::Respons
         }
 
         // Check if user is the creator
-        if (!db_->isEventCreator(eventId, authResult.userId)) {
+        if (!access.isCreator) {
             json errorResponse = createErrorResponse("Only event creator can delete event", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -5,23 +5,22 @@
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include "database.h"
-#include "auth_middleware.h"
+#include "request_context.h"
 
 using json = nlohmann::json;
 
 class EventsController {
 public:
-    EventsController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth);
+    explicit EventsController(std::shared_ptr<Database> db);
     
-    void getEvents(const httplib::Request& req, httplib::Response& res);
-    void createEvent(const httplib::Request& req, httplib::Response& res);
-    void getEvent(const httplib::Request& req, httplib::Response& res);
-    void updateEvent(const httplib::Request& req, httplib::Response& res);
-    void deleteEvent(const httplib::Request& req, httplib::Response& res);
+    void getEvents(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void createEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void getEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void updateEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void deleteEvent(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
 
 private:
     std::shared_ptr<Database> db_;
-    std::shared_ptr<AuthMiddleware> auth_;
     
     struct CreateEventRequest {
         std::string name;
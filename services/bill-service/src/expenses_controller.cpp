@@ -4,20 +4,11 @@
 #include <regex>
 #include <set>
 
-ExpensesController::ExpensesController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth)
-    : db_(db), auth_(auth) {}
+ExpensesController::ExpensesController(std::shared_ptr<Database> db)
+    : db_(db) {}
 
-void ExpensesController::getExpenses(const httplib::Request& req, httplib::Response& res) {
+void ExpensesController::getExpenses(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -28,8 +19,9 @@ void ExpensesController::getExpenses(const httplib::Request& req, httplib::Respo
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -37,10 +29,7 @@ void ExpensesController::getExpenses(const httplib::Request& req, httplib::Respo
         }
 
         // Check if user has access (creator or participant)
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isParticipant = db_->isParticipant(eventId, authResult.userId);
-        
-        if (!isCreator && !isParticipant) {
+        if (!access.isCreator && !access.isParticipant) {
             json errorResponse = createErrorResponse("Access denied", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -48,13 +37,25 @@ void ExpensesController::getExpenses(const httplib::Request& req, httplib::Respo
         }
 
         // Get expenses for event
-        json expenses = db_->getExpensesByEvent(eventId);
+        PageRequest page;
+        std::string pageError;
+        if (!parsePageRequest(req.get_param_value("limit"), req.get_param_value("cursor"), page, pageError)) {
+            json errorResponse = createErrorResponse(pageError);
+            res.status = 400;
+            res.set_content(errorResponse.dump(), "application/json");
+            return;
+        }
         
-        json response = createSuccessResponse();
-        response["expenses"] = expenses;
+        JsonWriter out;
+        out.beginObject();
+        out.key("expenses");
+        auto nextCursor = db_->writeExpensesByEvent(eventId, page, out);
+        writeNextCursor(out, nextCursor);
+        writeSuccessFields(out);
+        out.endObject();
         
         res.status = 200;
-        res.set_content(response.dump(), "application/json");
+        res.set_content(out.release(), "application/json");
         
     } catch (const std::exception& e) {
         json errorResponse = createErrorResponse("Failed to retrieve expenses: " + std::string(e.what()), 500);
@@ -63,17 +64,8 @@ void ExpensesController::getExpenses(const httplib::Request& req, httplib::Respo
     }
 }
 
-void ExpensesController::createExpense(const httplib::Request& req, httplib::Response& res) {
+void ExpensesController::createExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -84,8 +76,9 @@ void ExpensesController::createExpense(const httplib::Request& req, httplib::Res
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -93,10 +86,7 @@ void ExpensesController::createExpense(const httplib::Request& req, httplib::Res
         }
 
         // Check if user has access (creator or participant)
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isParticipant = db_->isParticipant(eventId, authResult.userId);
-        
-        if (!isCreator && !isParticipant) {
+        if (!access.isCreator && !access.isParticipant) {
             json errorResponse = createErrorResponse("Access denied", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -132,10 +122,11 @@ void ExpensesController::createExpense(const httplib::Request& req, httplib::Res
             return;
         }
 
-        bool payerIsCreator = db_->isEventCreator(eventId, expenseReq.payerId);
-        bool payerIsParticipant = db_->isParticipant(eventId, expenseReq.payerId);
+        auto payerAccess = expenseReq.payerId == context.userId
+            ? access
+            : db_->resolveEventAccess(eventId, expenseReq.payerId);
         
-        if (!payerIsCreator && !payerIsParticipant) {
+        if (!payerAccess.isCreator && !payerAccess.isParticipant) {
             json errorResponse = createErrorResponse("Payer must be event creator or participant");
             res.status = 400;
             res.set_content(errorResponse.dump(), "application/json");
@@ -143,16 +134,16 @@ void ExpensesController::createExpense(const httplib::Request& req, httplib::Res
         }
 
         // Create expense
-        json expense = db_->createExpense(
+        Expense expense = db_->createExpense(
             eventId,
             expenseReq.payerId,
-            expenseReq.amount,
+            amountToCents(expenseReq.amount),
             expenseReq.description,
             expenseReq.splitType
         );
 
         json response = createSuccessResponse();
-        response["expense"] = expense;
+        response["expense"] = toJson(expense);
         
         res.status = 201;
         res.set_content(response.dump(), "application/json");
@@ -164,17 +155,8 @@ void ExpensesController::createExpense(const httplib::Request& req, httplib::Res
     }
 }
 
-void ExpensesController::getExpense(const httplib::Request& req, httplib::Response& res) {
+void ExpensesController::getExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID and expense ID from URL
         std::string eventId = req.matches[1];
         std::string expenseId = req.matches[2];
@@ -186,8 +168,9 @@ void ExpensesController::getExpense(const httplib::Request& req, httplib::Respon
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -195,10 +178,7 @@ void ExpensesController::getExpense(const httplib::Request& req, httplib::Respon
         }
 
         // Check if user has access (creator or participant)
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isParticipant = db_->isParticipant(eventId, authResult.userId);
-        
-        if (!isCreator && !isParticipant) {
+        if (!access.isCreator && !access.isParticipant) {
             json errorResponse = createErrorResponse("Access denied", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -206,9 +186,9 @@ void ExpensesController::getExpense(const httplib::Request& req, httplib::Respon
         }
 
         // Get expense details
-        json expense = db_->getExpense(expenseId);
+        auto expense = db_->getExpense(expenseId);
         
-        if (expense.empty()) {
+        if (!expense) {
             json errorResponse = createErrorResponse("Expense not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -216,7 +196,7 @@ void ExpensesController::getExpense(const httplib::Request& req, httplib::Respon
         }
 
         // Verify expense belongs to this event
-        if (expense["event_id"] != eventId) {
+        if (expense->eventId != eventId) {
             json errorResponse = createErrorResponse("Expense not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -224,7 +204,7 @@ void ExpensesController::getExpense(const httplib::Request& req, httplib::Respon
         }
         
         json response = createSuccessResponse();
-        response["expense"] = expense;
+        response["expense"] = toJson(*expense);
         
         res.status = 200;
         res.set_content(response.dump(), "application/json");
@@ -236,17 +216,8 @@ void ExpensesController::getExpense(const httplib::Request& req, httplib::Respon
     }
 }
 
-void ExpensesController::updateExpense(const httplib::Request& req, httplib::Response& res) {
+void ExpensesController::updateExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID and expense ID from URL
         std::string eventId = req.matches[1];
         std::string expenseId = req.matches[2];
@@ -259,9 +230,9 @@ void ExpensesController::updateExpense(const httplib::Request& req, httplib::Res
         }
 
         // Get expense details to check ownership
-        json expense = db_->getExpense(expenseId);
+        auto expense = db_->getExpense(expenseId);
         
-        if (expense.empty()) {
+        if (!expense) {
             json errorResponse = createErrorResponse("Expense not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -269,7 +240,7 @@ void ExpensesController::updateExpense(const httplib::Request& req, httplib::Res
         }
 
         // Verify expense belongs to this event
-        if (expense["event_id"] != eventId) {
+        if (expense->eventId != eventId) {
             json errorResponse = createErrorResponse("Expense not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -277,8 +248,8 @@ void ExpensesController::updateExpense(const httplib::Request& req, httplib::Res
         }
 
         // Check if user is the payer or event creator
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isPayer = (expense["payer_id"] == authResult.userId);
+        bool isCreator = db_->resolveEventAccess(eventId, context.userId).isCreator;
+        bool isPayer = (expense->payerId == context.userId);
         
         if (!isCreator && !isPayer) {
             json errorResponse = createErrorResponse("Only expense payer or event creator can update expense", 403);
@@ -321,17 +292,8 @@ void ExpensesController::updateExpense(const httplib::Request& req, httplib::Res
     }
 }
 
-void ExpensesController::deleteExpense(const httplib::Request& req, httplib::Response& res) {
+void ExpensesController::deleteExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID and expense ID from URL
         std::string eventId = req.matches[1];
         std::string expenseId = req.matches[2];
@@ -344,9 +306,9 @@ void ExpensesController::deleteExpense(const httplib::Request& req, httplib::Res
         }
 
         // Get expense details to check ownership
-        json expense = db_->getExpense(expenseId);
+        auto expense = db_->getExpense(expenseId);
         
-        if (expense.empty()) {
+        if (!expense) {
             json errorResponse = createErrorResponse("Expense not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -354,7 +316,7 @@ void ExpensesController::deleteExpense(const httplib::Request& req, httplib::Res
         }
 
         // Verify expense belongs to this event
-        if (expense["event_id"] != eventId) {
+        if (expense->eventId != eventId) {
             json errorResponse = createErrorResponse("Expense not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -362,8 +324,8 @@ void ExpensesController::deleteExpense(const httplib::Request& req, httplib::Res
         }
 
         // Check if user is the payer or event creator
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isPayer = (expense["payer_id"] == authResult.userId);
+        bool isCreator = db_->resolveEventAccess(eventId, context.userId).isCreator;
+        bool isPayer = (expense->payerId == context.userId);
         
         if (!isCreator && !isPayer) {
             json errorResponse = createErrorResponse("Only expense payer or event creator can delete expense", 403);
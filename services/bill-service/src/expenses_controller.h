@@ -5,23 +5,22 @@
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include "database.h"
-#include "auth_middleware.h"
+#include "request_context.h"
 
 using json = nlohmann::json;
 
 class ExpensesController {
 public:
-    ExpensesController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth);
+    explicit ExpensesController(std::shared_ptr<Database> db);
     
-    void getExpenses(const httplib::Request& req, httplib::Response& res);
-    void createExpense(const httplib::Request& req, httplib::Response& res);
-    void getExpense(const httplib::Request& req, httplib::Response& res);
-    void updateExpense(const httplib::Request& req, httplib::Response& res);
-    void deleteExpense(const httplib::Request& req, httplib::Response& res);
+    void getExpenses(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void createExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void getExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void updateExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void deleteExpense(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
 
 private:
     std::shared_ptr<Database> db_;
-    std::shared_ptr<AuthMiddleware> auth_;
     
     struct CreateExpenseRequest {
         std::string payerId;
@@ -0,0 +1,151 @@
+#include "json_writer.h"
+#include "utils.h"
+#include <charconv>
+#include <cmath>
+
+JsonWriter::JsonWriter(size_t reserveBytes) {
+    out_.reserve(reserveBytes);
+}
+
+void JsonWriter::separate() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+
+    if (!hasItems_.empty()) {
+        if (hasItems_.back()) {
+            out_ += ',';
+        }
+        hasItems_.back() = true;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_ += '{';
+    hasItems_.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out_ += '}';
+    hasItems_.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_ += '[';
+    hasItems_.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out_ += ']';
+    hasItems_.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    appendEscaped(name);
+    out_ += ':';
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(std::string_view value) {
+    separate();
+    appendEscaped(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::integer(int64_t value) {
+    separate();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(double value) {
+    if (!std::isfinite(value)) {
+        return null();
+    }
+
+    separate();
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    std::string_view text(buffer, result.ptr - buffer);
+    out_ += text;
+
+    // Keep whole numbers recognisable as floating point, as json::dump() does
+    if (text.find_first_of(".e") == std::string_view::npos) {
+        out_ += ".0";
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool value) {
+    separate();
+    out_ += value ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out_ += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::amount(int64_t cents) {
+    separate();
+
+    uint64_t magnitude = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+    if (cents < 0) {
+        out_ += '-';
+    }
+
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), magnitude / 100);
+    out_.append(buffer, result.ptr);
+
+    uint64_t fraction = magnitude % 100;
+    out_ += '.';
+    out_ += static_cast<char>('0' + fraction / 10);
+    if (fraction % 10 != 0) {
+        out_ += static_cast<char>('0' + fraction % 10);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::timestamp(int64_t epochMillis) {
+    return string(formatTimestamp(epochMillis));
+}
+
+void JsonWriter::appendEscaped(std::string_view value) {
+    static const char hex[] = "0123456789abcdef";
+
+    out_ += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"':  out_ += "\\\""; break;
+            case '\\': out_ += "\\\\"; break;
+            case '\b': out_ += "\\b"; break;
+            case '\f': out_ += "\\f"; break;
+            case '\n': out_ += "\\n"; break;
+            case '\r': out_ += "\\r"; break;
+            case '\t': out_ += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out_ += "\\u00";
+                    out_ += hex[(c >> 4) & 0x0f];
+                    out_ += hex[c & 0x0f];
+                } else {
+                    out_ += c;  // UTF-8 passes through unchanged
+                }
+        }
+    }
+    out_ += '"';
+}
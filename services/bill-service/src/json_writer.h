@@ -0,0 +1,50 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Forward-only JSON serializer that appends into a single pre-reserved
+// buffer. Used for list responses, where building a json DOM and then
+// dumping it would copy every row several times.
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t reserveBytes = 4096);
+
+    // Grow the buffer ahead of a known number of rows
+    void reserve(size_t additionalBytes) { out_.reserve(out_.size() + additionalBytes); }
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& string(std::string_view value);
+    JsonWriter& integer(int64_t value);
+    JsonWriter& number(double value);
+    JsonWriter& boolean(bool value);
+    JsonWriter& null();
+
+    // Money in cents, written as a decimal amount (1250 -> 12.5)
+    JsonWriter& amount(int64_t cents);
+
+    // Epoch milliseconds, written as an ISO 8601 string
+    JsonWriter& timestamp(int64_t epochMillis);
+
+    const std::string& str() const { return out_; }
+    std::string release() { return std::move(out_); }
+
+private:
+    std::string out_;
+    std::vector<bool> hasItems_;  // one entry per open object/array
+    bool afterKey_ = false;
+
+    void separate();
+    void appendEscaped(std::string_view value);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef KEY_VALUE_BACKEND_H
+#define KEY_VALUE_BACKEND_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Storage RedisClient can run against instead of Redis servers, for running
+// the auth and cache paths hermetically. It covers the subset of commands
+// RedisClient issues, with the same semantics: TTLs in seconds, ttl <= 0
+// meaning no expiry.
+class KeyValueBackend {
+public:
+    virtual ~KeyValueBackend() = default;
+
+    virtual bool set(const std::string& key, const std::string& value, int ttlSeconds) = 0;
+    virtual std::optional<std::string> get(const std::string& key) = 0;
+    // get, raising an expiring key's remaining TTL to at least minTtlSeconds
+    virtual std::optional<std::string> getAndExtend(const std::string& key, int minTtlSeconds) = 0;
+    virtual bool del(const std::string& key) = 0;
+    virtual bool exists(const std::string& key) = 0;
+
+    // Sorted sets of members scored by an integer, as far as the
+    // revoked_tokens set needs: add or rescore, members scored at least
+    // minScore, a member's score, and removal of members scored at most
+    // maxScore
+    virtual bool zadd(const std::string& key, const std::string& member, int64_t score) = 0;
+    virtual std::vector<std::string> zrangeByScore(const std::string& key, int64_t minScore) = 0;
+    virtual std::optional<int64_t> zscore(const std::string& key, const std::string& member) = 0;
+    virtual size_t zremRangeByScore(const std::string& key, int64_t maxScore) = 0;
+
+    // Receives every key that is deleted or expires, the counterpart of
+    // keyspace notifications. Pass nullptr to stop.
+    virtual void setInvalidationListener(std::function<void(const std::string& key)> listener) = 0;
+
+    virtual json getStats() const = 0;
+};
+
+#endif
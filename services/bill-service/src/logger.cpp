@@ -0,0 +1,233 @@
+#include "logger.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+std::atomic<int> Logger::level_{static_cast<int>(LogLevel::Info)};
+
+Logger& Logger::instance() {
+    // Never destroyed, so threads still logging during exit stay safe;
+    // atexit drains whatever is queued
+    static Logger* logger = [] {
+        Logger* created = new Logger();
+        std::atexit([] { instance().stop(); });
+        return created;
+    }();
+    return *logger;
+}
+
+Logger::Logger() {
+    LogLevel initial;
+    if (parseLevel(getEnvVar("LOG_LEVEL", "info"), initial)) {
+        setLevel(initial);
+    }
+
+    // Rounded up to a power of two so positions map to slots with a mask
+    size_t requested = std::max<size_t>(2, std::stoul(getEnvVar("LOG_BUFFER_SIZE", "8192")));
+    size_t capacity = 1;
+    while (capacity < requested) {
+        capacity <<= 1;
+    }
+
+    slots_.reset(new Slot[capacity]);
+    mask_ = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    running_ = true;
+    writer_ = std::thread(&Logger::run, this);
+}
+
+void Logger::log(LogLevel level, std::string message) {
+    Record record;
+    record.level = level;
+    record.epochMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.message = std::move(message);
+
+    if (!running_.load(std::memory_order_acquire)) {
+        std::string line;
+        append(line, record);
+        write(line);
+        return;
+    }
+
+    size_t pos;
+    if (!tryPush(record, pos)) {
+        ++dropped_;
+        return;
+    }
+
+    // A burst could fill the ring before the writer's next poll, so every
+    // half ring of records also wakes it
+    if ((pos & (mask_ >> 1)) == 0) {
+        wake_.notify_one();
+    }
+}
+
+bool Logger::tryPush(Record& record, size_t& pos) {
+    pos = enqueuePos_.load(std::memory_order_relaxed);
+
+    while (true) {
+        Slot& slot = slots_[pos & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            // The slot is free for this position; claim it
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record = std::move(record);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // The writer has not consumed this slot from the previous lap
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Logger::tryPop(Record& record) {
+    Slot& slot = slots_[dequeuePos_ & mask_];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (sequence != dequeuePos_ + 1) {
+        return false;
+    }
+
+    record = std::move(slot.record);
+    slot.sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+    ++dequeuePos_;
+    return true;
+}
+
+void Logger::run() {
+    std::string buffer;
+    int lastLevel = level_.load();
+
+    while (true) {
+        int currentLevel = level_.load();
+        if (currentLevel != lastLevel) {
+            lastLevel = currentLevel;
+            Record notice;
+            notice.level = LogLevel::Warn;
+            notice.epochMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            notice.message = std::string("Log level set to ") + levelName(static_cast<LogLevel>(currentLevel));
+            append(buffer, notice);
+        }
+
+        size_t count = drain(buffer);
+        if (!buffer.empty()) {
+            write(buffer);
+            buffer.clear();
+        }
+
+        if (count == 0) {
+            if (!running_.load()) {
+                break;
+            }
+            // Producers never signal, to stay lock-free; poll while idle
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+}
+
+size_t Logger::drain(std::string& buffer) {
+    Record record;
+    size_t count = 0;
+
+    // Bounded so a busy ring still gets written out regularly
+    while (count < 1024 && tryPop(record)) {
+        append(buffer, record);
+        ++count;
+    }
+
+    written_ += count;
+    return count;
+}
+
+void Logger::append(std::string& buffer, const Record& record) {
+    buffer += "{\"ts\":\"";
+    buffer += formatTimestamp(record.epochMillis);
+    buffer += "\",\"level\":\"";
+    buffer += levelName(record.level);
+    buffer += "\",\"msg\":";
+    buffer += json(record.message).dump(-1, ' ', false, json::error_handler_t::replace);
+    buffer += "}\n";
+}
+
+void Logger::write(const std::string& buffer) {
+    fwrite(buffer.data(), 1, buffer.size(), stdout);
+    fflush(stdout);
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    wake_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void Logger::setLevel(LogLevel level) {
+    level_.store(static_cast<int>(level));
+}
+
+LogLevel Logger::level() {
+    return static_cast<LogLevel>(level_.load());
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    if (name == "debug") level = LogLevel::Debug;
+    else if (name == "info") level = LogLevel::Info;
+    else if (name == "warn" || name == "warning") level = LogLevel::Warn;
+    else if (name == "error") level = LogLevel::Error;
+    else return false;
+    return true;
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warn: return "warn";
+        case LogLevel::Error: return "error";
+    }
+    return "info";
+}
+
+void Logger::onSignal(int signal) {
+    // Only a lock-free atomic update, which is async-signal-safe
+    int current = level_.load();
+    if (signal == SIGUSR1) {
+        level_.store(std::max(current - 1, static_cast<int>(LogLevel::Debug)));
+    } else if (signal == SIGUSR2) {
+        level_.store(std::min(current + 1, static_cast<int>(LogLevel::Error)));
+    }
+}
+
+void Logger::installSignalHandlers() {
+    std::signal(SIGUSR1, &Logger::onSignal);
+    std::signal(SIGUSR2, &Logger::onSignal);
+}
+
+json Logger::getStats() const {
+    return json{
+        {"level", levelName(level())},
+        {"capacity", mask_ + 1},
+        {"queued", enqueuePos_.load() - written_.load()},
+        {"written", written_.load()},
+        {"dropped", dropped_.load()}
+    };
+}
@@ -0,0 +1,101 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+enum class LogLevel { Debug = 0, Info = 1, Warn = 2, Error = 3 };
+
+// Leveled logger writing one JSON object per line to stdout. Request threads
+// only format the message and push it onto a bounded lock-free ring; a
+// background thread serializes and writes records in batches. When
+// the ring is full, records are dropped and counted rather than blocking.
+//
+// LOG_LEVEL sets the initial level (debug, info, warn, error). At runtime,
+// SIGUSR1 makes logging more verbose by one level and SIGUSR2 less verbose.
+class Logger {
+public:
+    static Logger& instance();
+
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    void log(LogLevel level, std::string message);
+
+    static void setLevel(LogLevel level);
+    static LogLevel level();
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static const char* levelName(LogLevel level);
+
+    void installSignalHandlers();
+    // Drains the ring and stops the writer; later records are written inline
+    void stop();
+
+    json getStats() const;
+
+private:
+    struct Record {
+        LogLevel level = LogLevel::Info;
+        int64_t epochMillis = 0;
+        std::string message;
+    };
+
+    // Slot of a bounded multi-producer queue (Vyukov); sequence says whether
+    // the slot is free for the producer at that position or holds a record
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        Record record;
+    };
+
+    Logger();
+
+    static std::atomic<int> level_;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) size_t dequeuePos_ = 0;  // writer thread only
+
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    bool tryPush(Record& record, size_t& pos);
+    bool tryPop(Record& record);
+    void run();
+    size_t drain(std::string& buffer);
+    static void append(std::string& buffer, const Record& record);
+    static void onSignal(int signal);
+    static void write(const std::string& buffer);
+};
+
+// The message expression is only evaluated when the level is enabled
+#define LOG_AT(level, message)                                      \
+    do {                                                            \
+        if (Logger::enabled(level)) {                               \
+            std::ostringstream log_stream_;                         \
+            log_stream_ << message;                                 \
+            Logger::instance().log(level, log_stream_.str());       \
+        }                                                           \
+    } while (0)
+
+#define LOG_DEBUG(message) LOG_AT(LogLevel::Debug, message)
+#define LOG_INFO(message) LOG_AT(LogLevel::Info, message)
+#define LOG_WARN(message) LOG_AT(LogLevel::Warn, message)
+#define LOG_ERROR(message) LOG_AT(LogLevel::Error, message)
+
+#endif
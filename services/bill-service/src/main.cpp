@@ -1,50 +1,179 @@
 #include <httplib.h>
 #include <nlohmann/json.hpp>
-#include <iostream>
 #include <string>
+#include <string_view>
+#include <cctype>
 #include <memory>
+#include <thread>
 #include "database.h"
 #include "redis_client.h"
+#include "async_redis_client.h"
 #include "auth_middleware.h"
 #include "events_controller.h"
 #include "expenses_controller.h"
 #include "participants_controller.h"
 #include "utils.h"
 #include "settlements_controller.h"
+#include "balance_tool.h"
+#include "request_metrics.h"
+#include "request_context.h"
+#include "worker_pool.h"
+#include "logger.h"
 using json = nlohmann::json;
 
-int main() {
+// Routes served without a bearer token
+static bool isPublicRoute(const std::string& path) {
+    return path == "/health" || path == "/test";
+}
+
+// One "[0-9a-fA-F-]+" capture of the route patterns below
+static bool isIdSegment(std::string_view segment) {
+    if (segment.empty()) {
+        return false;
+    }
+    for (char c : segment) {
+        if (!std::isxdigit(static_cast<unsigned char>(c)) && c != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether some route registered below matches the path, whatever the method,
+// so unknown paths get a 404 before authentication instead of a 401. Walks
+// the segments by hand to keep regexes and allocations off every request;
+// keep it in step with the server.Get/Post/Put/Delete calls.
+static bool isKnownRoute(const std::string& path) {
+    if (path.empty() || path[0] != '/') {
+        return false;
+    }
+    std::string_view segments[4];
+    size_t count = 0;
+    size_t start = 1;
+    for (;;) {
+        size_t end = path.find('/', start);
+        if (count == 4) {
+            return false;
+        }
+        segments[count++] = std::string_view(path).substr(start, end == std::string::npos ? end : end - start);
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    if (segments[0] != "events") {
+        return count == 2 && segments[0] == "users" && segments[1] == "balance";
+    }
+    if (count == 1) {
+        return true;
+    }
+    if (!isIdSegment(segments[1])) {
+        return false;
+    }
+    if (count == 2) {
+        return true;
+    }
+    const std::string_view& collection = segments[2];
+    bool nested = collection == "expenses" || collection == "participants";
+    if (count == 3) {
+        return nested || collection == "settlements" || collection == "payments";
+    }
+    return nested && isIdSegment(segments[3]);
+}
+
+int main(int argc, char* argv[]) {
     const std::string host = "0.0.0.0";
     const int port = std::stoi(getenv("PORT") ? getenv("PORT") : "8002");
     
+    // Starts the log writer; SIGUSR1/SIGUSR2 raise or lower verbosity at runtime
+    Logger::instance().installSignalHandlers();
+    
+    // Stateless mode learns about logouts only from the revoked_tokens set the
+    // auth service writes to Redis; an in-process backend never receives them
+    if (getEnvVar("AUTH_MODE", "session") == "stateless" && getEnvVar("REDIS_BACKEND", "redis") == "memory") {
+        LOG_ERROR("AUTH_MODE=stateless needs REDIS_BACKEND=redis to receive token revocations");
+        return 1;
+    }
+    
     auto db = std::make_shared<Database>();
     auto redis = std::make_shared<RedisClient>();
-    auto auth = std::make_shared<AuthMiddleware>(redis);
+    std::shared_ptr<AsyncRedisClient> asyncRedis;
+    if (getEnvVar("REDIS_ASYNC_CONNECTIONS", "2") != "0" && getEnvVar("REDIS_BACKEND", "redis") != "memory") {
+        asyncRedis = std::make_shared<AsyncRedisClient>();
+    }
+    auto auth = std::make_shared<AuthMiddleware>(redis, asyncRedis);
     
     // CONNECT TO SERVICES BEFORE CREATING CONTROLLERS
     if (!db->connect()) {
-        std::cerr << "Failed to connect to database" << std::endl;
+        LOG_ERROR("Failed to connect to database");
         return 1;
     }
     
+    // One-off ledger maintenance runs instead of the server
+    if (argc > 1 && isBalanceToolCommand(argv[1])) {
+        return runBalanceTool(*db, argv[1]);
+    }
+    
     if (!redis->connect()) {
-        std::cerr << "Failed to connect to Redis" << std::endl;
+        LOG_ERROR("Failed to connect to Redis");
         return 1;
     }
     
-    std::cout << "Database and Redis connected successfully" << std::endl;
+    // Optional: without it, token lookups use the blocking pool
+    if (asyncRedis && !asyncRedis->connect()) {
+        LOG_WARN("Async Redis client not connected yet, retrying in the background");
+    }
+    
+    LOG_INFO("Database and Redis connected successfully");
     
-    auto events_controller = std::make_shared<EventsController>(db, auth);
-    auto expenses_controller = std::make_shared<ExpensesController>(db, auth);
-    auto participants_controller = std::make_shared<ParticipantsController>(db, auth);
-    auto settlements_controller = std::make_shared<SettlementsController>(db, auth);
+    auth->startTokenInvalidation();
+    
+    auto events_controller = std::make_shared<EventsController>(db);
+    auto expenses_controller = std::make_shared<ExpensesController>(db);
+    auto participants_controller = std::make_shared<ParticipantsController>(db);
+    auto settlements_controller = std::make_shared<SettlementsController>(db, redis, asyncRedis);
 
-    std::cout << "Controllers initialized successfully" << std::endl;
+    LOG_INFO("Controllers initialized successfully");
+    
+    auto requestMetrics = std::make_shared<RequestMetrics>();
+    auto workerPool = std::make_shared<WorkerPool>();
+    WorkerPoolServer server(workerPool);
     
-    httplib::Server server;
+    // Authentication runs once here, before route matching, so rejected
+    // requests never reach a controller; handlers get the resulting context.
+    // Paths no route serves are answered 404 first, as they were before
+    // authentication moved here.
+    server.set_pre_routing_handler([requestMetrics, auth, workerPool](const httplib::Request& req, httplib::Response& res) {
+        requestMetrics->begin();
+        RequestContext& context = RequestContext::begin(req);
+        context.queueTime = WorkerPool::takeQueueTime();
+        res.set_header("X-Request-Id", context.traceId);
+        
+        if (WorkerPool::isShedding()) {
+            workerPool->writeOverloadResponse(res);
+            return httplib::Server::HandlerResponse::Handled;
+        }
+        if (isPublicRoute(req.path)) {
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
+        if (!isKnownRoute(req.path)) {
+            res.status = 404;
+            res.set_content(createErrorResponse("Route not found", 404).dump(), "application/json");
+            return httplib::Server::HandlerResponse::Handled;
+        }
+        if (!auth->requireAuth(req, res, context)) {
+            return httplib::Server::HandlerResponse::Handled;
+        }
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
     
-    server.set_logger([](const httplib::Request& req, const httplib::Response& res) {
-        std::cout << req.method << " " << req.path << " " << res.status << std::endl;
+    server.set_logger([requestMetrics](const httplib::Request& req, const httplib::Response& res) {
+        requestMetrics->end(req, res);
+        const RequestContext& context = RequestContext::current();
+        LOG_INFO(req.method << " " << req.path << " " << res.status
+                 << " trace=" << context.traceId << " queue_us=" << context.queueTime.count());
+        RequestContext::end();
     });
     
     server.Get("/health", [](const httplib::Request&, httplib::Response& res) {
@@ -63,78 +192,78 @@ int main() {
     });
 
     server.Get("/events", [events_controller](const httplib::Request& req, httplib::Response& res) {
-        events_controller->getEvents(req, res);
+        events_controller->getEvents(req, res, RequestContext::current());
     });
 
     
     server.Post("/events", [events_controller](const httplib::Request& req, httplib::Response& res) {
-        events_controller->createEvent(req, res);
+        events_controller->createEvent(req, res, RequestContext::current());
     });
     
     server.Get("/events/([0-9a-fA-F-]+)", [events_controller](const httplib::Request& req, httplib::Response& res) {
-        events_controller->getEvent(req, res);
+        events_controller->getEvent(req, res, RequestContext::current());
     });
     
     server.Put("/events/([0-9a-fA-F-]+)", [events_controller](const httplib::Request& req, httplib::Response& res) {
-        events_controller->updateEvent(req, res);
+        events_controller->updateEvent(req, res, RequestContext::current());
     });
     
     server.Delete("/events/([0-9a-fA-F-]+)", [events_controller](const httplib::Request& req, httplib::Response& res) {
-        events_controller->deleteEvent(req, res);
+        events_controller->deleteEvent(req, res, RequestContext::current());
     });
     
     // Expenses routes
     server.Get("/events/([0-9a-fA-F-]+)/expenses", [expenses_controller](const httplib::Request& req, httplib::Response& res) {
-        expenses_controller->getExpenses(req, res);
+        expenses_controller->getExpenses(req, res, RequestContext::current());
     });
     
     server.Post("/events/([0-9a-fA-F-]+)/expenses", [expenses_controller](const httplib::Request& req, httplib::Response& res) {
-        expenses_controller->createExpense(req, res);
+        expenses_controller->createExpense(req, res, RequestContext::current());
     });
     
     server.Get("/events/([0-9a-fA-F-]+)/expenses/([0-9a-fA-F-]+)", [expenses_controller](const httplib::Request& req, httplib::Response& res) {
-        expenses_controller->getExpense(req, res);
+        expenses_controller->getExpense(req, res, RequestContext::current());
     });
     
     server.Delete("/events/([0-9a-fA-F-]+)/expenses/([0-9a-fA-F-]+)", [expenses_controller](const httplib::Request& req, httplib::Response& res) {
-        expenses_controller->deleteExpense(req, res);
+        expenses_controller->deleteExpense(req, res, RequestContext::current());
     });
     
     // Participants routes
     server.Get("/events/([0-9a-fA-F-]+)/participants", [participants_controller](const httplib::Request& req, httplib::Response& res) {
-        participants_controller->getParticipants(req, res);
+        participants_controller->getParticipants(req, res, RequestContext::current());
     });
     
     server.Post("/events/([0-9a-fA-F-]+)/participants", [participants_controller](const httplib::Request& req, httplib::Response& res) {
-        participants_controller->addParticipant(req, res);
+        participants_controller->addParticipant(req, res, RequestContext::current());
     });
     
     server.Put("/events/([0-9a-fA-F-]+)/participants/([0-9a-fA-F-]+)", [participants_controller](const httplib::Request& req, httplib::Response& res) {
-        participants_controller->updateParticipant(req, res);
+        participants_controller->updateParticipant(req, res, RequestContext::current());
     });
     
     server.Delete("/events/([0-9a-fA-F-]+)/participants/([0-9a-fA-F-]+)", [participants_controller](const httplib::Request& req, httplib::Response& res) {
-        participants_controller->removeParticipant(req, res);
+        participants_controller->removeParticipant(req, res, RequestContext::current());
     });
 
     server.Get("/events/([0-9a-fA-F-]+)/settlements", [settlements_controller](const httplib::Request& req, httplib::Response& res) {
-        settlements_controller->getEventSettlements(req, res);
+        settlements_controller->getEventSettlements(req, res, RequestContext::current());
     });
 
     server.Post("/events/([0-9a-fA-F-]+)/payments", [settlements_controller](const httplib::Request& req, httplib::Response& res) {
-        settlements_controller->recordPayment(req, res);
+        settlements_controller->recordPayment(req, res, RequestContext::current());
     });
 
     server.Get("/events/([0-9a-fA-F-]+)/settlements", [settlements_controller](const httplib::Request& req, httplib::Response& res) {
-        settlements_controller->getEventSettlements(req, res);
+        settlements_controller->getEventSettlements(req, res, RequestContext::current());
     });
 
     server.Post("/events/([0-9a-fA-F-]+)/payments", [settlements_controller](const httplib::Request& req, httplib::Response& res) {
-        settlements_controller->recordPayment(req, res);
+        settlements_controller->recordPayment(req, res, RequestContext::current());
     });
 
     server.Get("/users/balance", [settlements_controller](const httplib::Request& req, httplib::Response& res) {
-        settlements_controller->getUserBalance(req, res);
+        settlements_controller->getUserBalance(req, res, RequestContext::current());
     });
     
     //server.set_error_handler([](const httplib::Request&, httplib::Response& res) {
@@ -146,10 +275,55 @@ int main() {
     //    res.set_content(error.dump(), "application/json");
     //});
     
-    std::cout << "Bill Service starting on " << host << ":" << port << std::endl;
+    // Pool, cache and traffic internals are served on a separate listener,
+    // loopback-only unless METRICS_HOST says otherwise
+    const std::string metricsHost = getEnvVar("METRICS_HOST", "127.0.0.1");
+    const int metricsPort = std::stoi(getEnvVar("METRICS_PORT", "9102"));
+    httplib::Server metricsServer;
+    metricsServer.new_task_queue = [] { return new httplib::ThreadPool(1); };
+    
+    metricsServer.Get("/metrics", [db, redis, asyncRedis, auth, settlements_controller, requestMetrics, workerPool](const httplib::Request&, httplib::Response& res) {
+        json response = {
+            {"service", "Bill Service"},
+            {"timestamp", getCurrentTimestamp()},
+            {"db_pool", db->getPoolStats()},
+            {"acl_cache", db->getAccessCacheStats()},
+            {"db_pipeline", db->getPipelineStats()},
+            {"redis_pool", redis->getStats()},
+            {"redis_async", asyncRedis ? asyncRedis->getStats() : json(nullptr)},
+            {"token_cache", auth->getTokenCacheStats()},
+            {"auth", auth->getAuthStats()},
+            {"logger", Logger::instance().getStats()},
+            {"settlements_cache", settlements_controller->getCacheStats()},
+            {"handlers", requestMetrics->getStats()},
+            {"worker_pool", workerPool->getStats()}
+        };
+        res.set_content(response.dump(), "application/json");
+    });
+    
+    std::thread metricsThread;
+    if (metricsServer.bind_to_port(metricsHost, metricsPort)) {
+        metricsThread = std::thread([&metricsServer] { metricsServer.listen_after_bind(); });
+        LOG_INFO("Metrics listening on " << metricsHost << ":" << metricsPort);
+    } else {
+        LOG_ERROR("Failed to bind metrics listener on " << metricsHost << ":" << metricsPort);
+    }
+    
+    LOG_INFO("Bill Service starting on " << host << ":" << port);
+    
+    bool listened = server.listen(host, port);
+    
+    if (metricsThread.joinable()) {
+        // stop() is a no-op until the listener loop has started
+        while (!metricsServer.is_running()) {
+            std::this_thread::yield();
+        }
+        metricsServer.stop();
+        metricsThread.join();
+    }
     
-    if (!server.listen(host, port)) {
-        std::cerr << "Failed to start server" << std::endl;
+    if (!listened) {
+        LOG_ERROR("Failed to start server");
         return 1;
     }
     
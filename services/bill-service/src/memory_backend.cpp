@@ -0,0 +1,224 @@
+#include "memory_backend.h"
+#include <algorithm>
+
+MemoryBackend::MemoryBackend(size_t shards, size_t sweepInterval)
+    : sweepInterval_(std::max<size_t>(1, sweepInterval)) {
+    shards = std::max<size_t>(1, shards);
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+MemoryBackend::Shard& MemoryBackend::shardFor(const std::string& key) const {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+MemoryBackend::Clock::time_point MemoryBackend::expiryFor(int ttlSeconds) {
+    if (ttlSeconds <= 0) {
+        return Clock::time_point::max();
+    }
+    return Clock::now() + std::chrono::seconds(ttlSeconds);
+}
+
+bool MemoryBackend::set(const std::string& key, const std::string& value, int ttlSeconds) {
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries[key] = Entry{value, expiryFor(ttlSeconds)};
+    }
+
+    if (++writes_ % sweepInterval_ == 0) {
+        std::vector<std::string> expired;
+        sweep(*shards_[nextSweep_++ % shards_.size()], expired);
+        notify(expired);
+    }
+    return true;
+}
+
+std::optional<std::string> MemoryBackend::get(const std::string& key) {
+    return getAndExtend(key, 0);
+}
+
+std::optional<std::string> MemoryBackend::getAndExtend(const std::string& key, int minTtlSeconds) {
+    std::optional<std::string> value;
+    bool expired = false;
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            auto now = Clock::now();
+            if (it->second.expiresAt <= now) {
+                shard.entries.erase(it);
+                expired = true;
+            } else {
+                // Like the lookup script: persistent keys are left alone
+                auto extended = now + std::chrono::seconds(minTtlSeconds);
+                if (minTtlSeconds > 0 && it->second.expiresAt != Clock::time_point::max() &&
+                    it->second.expiresAt < extended) {
+                    it->second.expiresAt = extended;
+                }
+                value = it->second.value;
+            }
+        }
+    }
+
+    if (expired) {
+        ++expired_;
+        notify({key});
+    }
+    if (value) {
+        ++hits_;
+    } else {
+        ++misses_;
+    }
+    return value;
+}
+
+bool MemoryBackend::del(const std::string& key) {
+    bool erased;
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        erased = shard.entries.erase(key) > 0;
+    }
+
+    if (erased) {
+        notify({key});
+    }
+    return erased;
+}
+
+bool MemoryBackend::exists(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(key);
+    return it != shard.entries.end() && it->second.expiresAt > Clock::now();
+}
+
+bool MemoryBackend::zadd(const std::string& key, const std::string& member, int64_t score) {
+    std::lock_guard<std::mutex> lock(sortedSetsMutex_);
+    return sortedSets_[key].insert_or_assign(member, score).second;
+}
+
+std::vector<std::string> MemoryBackend::zrangeByScore(const std::string& key, int64_t minScore) {
+    std::vector<std::pair<int64_t, std::string>> scored;
+    {
+        std::lock_guard<std::mutex> lock(sortedSetsMutex_);
+        auto set = sortedSets_.find(key);
+        if (set != sortedSets_.end()) {
+            for (const auto& [member, score] : set->second) {
+                if (score >= minScore) {
+                    scored.emplace_back(score, member);
+                }
+            }
+        }
+    }
+
+    // Same order as ZRANGEBYSCORE: by score, then member
+    std::sort(scored.begin(), scored.end());
+
+    std::vector<std::string> members;
+    members.reserve(scored.size());
+    for (auto& entry : scored) {
+        members.push_back(std::move(entry.second));
+    }
+    return members;
+}
+
+std::optional<int64_t> MemoryBackend::zscore(const std::string& key, const std::string& member) {
+    std::lock_guard<std::mutex> lock(sortedSetsMutex_);
+    auto set = sortedSets_.find(key);
+    if (set == sortedSets_.end()) {
+        return std::nullopt;
+    }
+    auto it = set->second.find(member);
+    if (it == set->second.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t MemoryBackend::zremRangeByScore(const std::string& key, int64_t maxScore) {
+    std::lock_guard<std::mutex> lock(sortedSetsMutex_);
+    auto set = sortedSets_.find(key);
+    if (set == sortedSets_.end()) {
+        return 0;
+    }
+
+    size_t removed = 0;
+    for (auto it = set->second.begin(); it != set->second.end();) {
+        if (it->second <= maxScore) {
+            it = set->second.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    if (set->second.empty()) {
+        sortedSets_.erase(set);
+    }
+    return removed;
+}
+
+void MemoryBackend::setInvalidationListener(std::function<void(const std::string& key)> listener) {
+    std::lock_guard<std::mutex> lock(listenerMutex_);
+    listener_ = listener ? std::make_shared<std::function<void(const std::string&)>>(std::move(listener))
+                         : nullptr;
+}
+
+void MemoryBackend::sweep(Shard& shard, std::vector<std::string>& expired) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto now = Clock::now();
+
+    for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+        if (it->second.expiresAt <= now) {
+            expired.push_back(it->first);
+            it = shard.entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    expired_ += expired.size();
+}
+
+void MemoryBackend::notify(const std::vector<std::string>& keys) {
+    if (keys.empty()) {
+        return;
+    }
+
+    std::shared_ptr<std::function<void(const std::string&)>> listener;
+    {
+        std::lock_guard<std::mutex> lock(listenerMutex_);
+        listener = listener_;
+    }
+
+    if (listener) {
+        for (const auto& key : keys) {
+            (*listener)(key);
+        }
+    }
+}
+
+json MemoryBackend::getStats() const {
+    size_t keys = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        keys += shard->entries.size();
+    }
+
+    uint64_t hits = hits_.load();
+    uint64_t misses = misses_.load();
+
+    return json{
+        {"backend", "memory"},
+        {"shards", shards_.size()},
+        {"keys", keys},
+        {"hits", hits},
+        {"misses", misses},
+        {"hit_ratio", hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0},
+        {"expired", expired_.load()}
+    };
+}
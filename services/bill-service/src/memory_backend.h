@@ -0,0 +1,72 @@
+#ifndef MEMORY_BACKEND_H
+#define MEMORY_BACKEND_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "key_value_backend.h"
+
+// In-process KeyValueBackend. Keys are spread over mutex-guarded shards.
+// Expired keys are dropped when read and by a sweep of one shard every
+// sweepInterval writes, much like Redis's lazy plus sampled expiry.
+class MemoryBackend : public KeyValueBackend {
+public:
+    explicit MemoryBackend(size_t shards = 16, size_t sweepInterval = 1024);
+
+    bool set(const std::string& key, const std::string& value, int ttlSeconds) override;
+    std::optional<std::string> get(const std::string& key) override;
+    std::optional<std::string> getAndExtend(const std::string& key, int minTtlSeconds) override;
+    bool del(const std::string& key) override;
+    bool exists(const std::string& key) override;
+
+    bool zadd(const std::string& key, const std::string& member, int64_t score) override;
+    std::vector<std::string> zrangeByScore(const std::string& key, int64_t minScore) override;
+    std::optional<int64_t> zscore(const std::string& key, const std::string& member) override;
+    size_t zremRangeByScore(const std::string& key, int64_t maxScore) override;
+
+    void setInvalidationListener(std::function<void(const std::string& key)> listener) override;
+
+    json getStats() const override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string value;
+        Clock::time_point expiresAt;  // time_point::max() when persistent
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Few and small (just revoked_tokens), so one lock covers them; like
+    // Redis, members are only dropped by zremRangeByScore
+    std::mutex sortedSetsMutex_;
+    std::unordered_map<std::string, std::unordered_map<std::string, int64_t>> sortedSets_;
+    size_t sweepInterval_;
+    std::atomic<uint64_t> writes_{0};
+    std::atomic<size_t> nextSweep_{0};
+
+    // Copied out before calling, so a listener may call back into the backend
+    std::mutex listenerMutex_;
+    std::shared_ptr<std::function<void(const std::string&)>> listener_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> expired_{0};
+
+    Shard& shardFor(const std::string& key) const;
+    static Clock::time_point expiryFor(int ttlSeconds);
+    void sweep(Shard& shard, std::vector<std::string>& expired);
+    void notify(const std::vector<std::string>& keys);
+};
+
+#endif
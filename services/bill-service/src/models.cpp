@@ -0,0 +1,144 @@
+#include "models.h"
+#include "utils.h"
+#include <cmath>
+
+int64_t amountToCents(double amount) {
+    return static_cast<int64_t>(std::llround(amount * 100.0));
+}
+
+double centsToAmount(int64_t cents) {
+    return static_cast<double>(cents) / 100.0;
+}
+
+json toJson(const Event& event) {
+    json result = {
+        {"id", event.id},
+        {"name", event.name},
+        {"description", event.description},
+        {"event_type", event.eventType},
+        {"status", event.status},
+        {"created_at", formatTimestamp(event.createdAt)},
+        {"updated_at", formatTimestamp(event.updatedAt)}
+    };
+    
+    if (!event.creatorId.empty()) result["creator_id"] = event.creatorId;
+    if (event.startDate) result["start_date"] = formatTimestamp(*event.startDate);
+    if (event.endDate) result["end_date"] = formatTimestamp(*event.endDate);
+    
+    if (event.creator) {
+        result["creator"] = {
+            {"name", event.creator->name},
+            {"family_name", event.creator->familyName}
+        };
+    }
+    
+    return result;
+}
+
+json toJson(const Expense& expense) {
+    json result = {
+        {"id", expense.id},
+        {"event_id", expense.eventId},
+        {"payer_id", expense.payerId},
+        {"amount", centsToAmount(expense.amountCents)},
+        {"description", expense.description},
+        {"split_type", expense.splitType},
+        {"expense_date", formatTimestamp(expense.expenseDate)},
+        {"created_at", formatTimestamp(expense.createdAt)}
+    };
+    
+    if (expense.payer) {
+        result["payer"] = {
+            {"name", expense.payer->name},
+            {"family_name", expense.payer->familyName}
+        };
+    }
+    
+    return result;
+}
+
+json toJson(const Participant& participant) {
+    json result = {
+        {"id", participant.id},
+        {"event_id", participant.eventId},
+        {"user_id", participant.userId},
+        {"status", participant.status},
+        {"joined_at", formatTimestamp(participant.joinedAt)}
+    };
+    
+    if (participant.sharePercentage) {
+        result["share_percentage"] = *participant.sharePercentage;
+    }
+    if (participant.customAmountCents) {
+        result["custom_amount"] = centsToAmount(*participant.customAmountCents);
+    }
+    
+    if (participant.user) {
+        result["user"] = {
+            {"name", participant.user->name},
+            {"family_name", participant.user->familyName},
+            {"email", participant.user->email}
+        };
+    }
+    
+    return result;
+}
+
+void writeJson(JsonWriter& out, const Event& event) {
+    out.beginObject();
+    out.key("created_at").timestamp(event.createdAt);
+    if (event.creator) {
+        out.key("creator").beginObject();
+        out.key("family_name").string(event.creator->familyName);
+        out.key("name").string(event.creator->name);
+        out.endObject();
+    }
+    if (!event.creatorId.empty()) out.key("creator_id").string(event.creatorId);
+    out.key("description").string(event.description);
+    if (event.endDate) out.key("end_date").timestamp(*event.endDate);
+    out.key("event_type").string(event.eventType);
+    out.key("id").string(event.id);
+    out.key("name").string(event.name);
+    if (event.startDate) out.key("start_date").timestamp(*event.startDate);
+    out.key("status").string(event.status);
+    out.key("updated_at").timestamp(event.updatedAt);
+    out.endObject();
+}
+
+void writeJson(JsonWriter& out, const Expense& expense) {
+    out.beginObject();
+    out.key("amount").amount(expense.amountCents);
+    out.key("created_at").timestamp(expense.createdAt);
+    out.key("description").string(expense.description);
+    out.key("event_id").string(expense.eventId);
+    out.key("expense_date").timestamp(expense.expenseDate);
+    out.key("id").string(expense.id);
+    if (expense.payer) {
+        out.key("payer").beginObject();
+        out.key("family_name").string(expense.payer->familyName);
+        out.key("name").string(expense.payer->name);
+        out.endObject();
+    }
+    out.key("payer_id").string(expense.payerId);
+    out.key("split_type").string(expense.splitType);
+    out.endObject();
+}
+
+void writeJson(JsonWriter& out, const Participant& participant) {
+    out.beginObject();
+    if (participant.customAmountCents) out.key("custom_amount").amount(*participant.customAmountCents);
+    out.key("event_id").string(participant.eventId);
+    out.key("id").string(participant.id);
+    out.key("joined_at").timestamp(participant.joinedAt);
+    if (participant.sharePercentage) out.key("share_percentage").number(*participant.sharePercentage);
+    out.key("status").string(participant.status);
+    if (participant.user) {
+        out.key("user").beginObject();
+        out.key("email").string(participant.user->email);
+        out.key("family_name").string(participant.user->familyName);
+        out.key("name").string(participant.user->name);
+        out.endObject();
+    }
+    out.key("user_id").string(participant.userId);
+    out.endObject();
+}
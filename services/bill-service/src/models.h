@@ -0,0 +1,94 @@
+#ifndef MODELS_H
+#define MODELS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "json_writer.h"
+
+using json = nlohmann::json;
+
+// Plain domain records decoded straight from pqxx rows. Money is held in
+// integer cents and timestamps in milliseconds since the Unix epoch; JSON
+// is produced from them only when a controller writes the response.
+
+struct UserSummary {
+    std::string name;
+    std::string familyName;
+    std::string email;
+};
+
+struct Event {
+    std::string id;
+    std::string creatorId;
+    std::string name;
+    std::string description;
+    std::string eventType;
+    std::string status;
+    std::optional<int64_t> startDate;
+    std::optional<int64_t> endDate;
+    int64_t createdAt = 0;
+    int64_t updatedAt = 0;
+    std::optional<UserSummary> creator;
+};
+
+struct Expense {
+    std::string id;
+    std::string eventId;
+    std::string payerId;
+    int64_t amountCents = 0;
+    std::string description;
+    std::string splitType;
+    int64_t expenseDate = 0;
+    int64_t createdAt = 0;
+    std::optional<UserSummary> payer;
+};
+
+struct Participant {
+    std::string id;
+    std::string eventId;
+    std::string userId;
+    std::optional<double> sharePercentage;
+    std::optional<int64_t> customAmountCents;
+    std::string status;
+    int64_t joinedAt = 0;
+    std::optional<UserSummary> user;
+};
+
+// A user's net position in one event, read from the balance ledger
+struct UserEventBalance {
+    std::string eventId;
+    std::string eventName;
+    int64_t balanceCents = 0;
+};
+
+struct UserBalanceSummary {
+    int64_t totalCents = 0;
+    std::vector<UserEventBalance> events;
+};
+
+int64_t amountToCents(double amount);
+double centsToAmount(int64_t cents);
+
+json toJson(const Event& event);
+json toJson(const Expense& expense);
+json toJson(const Participant& participant);
+
+// Same fields as toJson(), appended straight to a response buffer. Keys are
+// written sorted, so the output is byte for byte toJson(...).dump()
+void writeJson(JsonWriter& out, const Event& event);
+void writeJson(JsonWriter& out, const Expense& expense);
+void writeJson(JsonWriter& out, const Participant& participant);
+
+template <typename T>
+json toJson(const std::vector<T>& items) {
+    json array = json::array();
+    for (const auto& item : items) {
+        array.push_back(toJson(item));
+    }
+    return array;
+}
+
+#endif
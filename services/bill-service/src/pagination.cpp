@@ -0,0 +1,135 @@
+#include "pagination.h"
+#include "utils.h"
+#include <algorithm>
+#include <charconv>
+
+static const char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static std::string base64UrlEncode(const std::string& input) {
+    std::string output;
+    output.reserve((input.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < input.size(); i += 3) {
+        uint32_t n = (static_cast<uint8_t>(input[i]) << 16) |
+                     (static_cast<uint8_t>(input[i + 1]) << 8) |
+                     static_cast<uint8_t>(input[i + 2]);
+        output += kBase64Url[(n >> 18) & 0x3f];
+        output += kBase64Url[(n >> 12) & 0x3f];
+        output += kBase64Url[(n >> 6) & 0x3f];
+        output += kBase64Url[n & 0x3f];
+    }
+
+    size_t remaining = input.size() - i;
+    if (remaining > 0) {
+        uint32_t n = static_cast<uint8_t>(input[i]) << 16;
+        if (remaining == 2) {
+            n |= static_cast<uint8_t>(input[i + 1]) << 8;
+        }
+        output += kBase64Url[(n >> 18) & 0x3f];
+        output += kBase64Url[(n >> 12) & 0x3f];
+        if (remaining == 2) {
+            output += kBase64Url[(n >> 6) & 0x3f];
+        }
+    }
+
+    return output;
+}
+
+static bool base64UrlDecode(const std::string& input, std::string& output) {
+    output.clear();
+    uint32_t buffer = 0;
+    int bits = 0;
+
+    for (char c : input) {
+        const char* pos = std::find(kBase64Url, kBase64Url + 64, c);
+        if (pos == kBase64Url + 64) {
+            return false;
+        }
+
+        buffer = (buffer << 6) | static_cast<uint32_t>(pos - kBase64Url);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            output += static_cast<char>((buffer >> bits) & 0xff);
+        }
+    }
+
+    return true;
+}
+
+std::string encodeCursor(const PageCursor& cursor) {
+    return base64UrlEncode(std::to_string(cursor.sortKey) + ":" + cursor.id);
+}
+
+bool decodeCursor(const std::string& token, PageCursor& cursor) {
+    std::string payload;
+    if (token.empty() || token.size() > 128 || !base64UrlDecode(token, payload)) {
+        return false;
+    }
+
+    size_t separator = payload.find(':');
+    if (separator == std::string::npos) {
+        return false;
+    }
+
+    const char* begin = payload.data();
+    const char* end = begin + separator;
+    auto result = std::from_chars(begin, end, cursor.sortKey);
+    // Sort keys are row timestamps, never before the epoch
+    if (result.ec != std::errc() || result.ptr != end || cursor.sortKey < 0) {
+        return false;
+    }
+
+    cursor.id = payload.substr(separator + 1);
+    return isValidUUID(cursor.id);
+}
+
+bool parsePageRequest(const std::string& limitParam, const std::string& cursorParam,
+                      PageRequest& page, std::string& error) {
+    static const size_t defaultLimit = std::stoul(getEnvVar("PAGE_SIZE_DEFAULT", "100"));
+    static const size_t maxLimit = std::stoul(getEnvVar("PAGE_SIZE_MAX", "500"));
+    static const bool unpagedLists = getEnvVar("PAGE_UNPAGED_LISTS", "true") == "true";
+
+    // Mobile builds released before pagination send neither parameter and
+    // expect the whole list; they get it until PAGE_UNPAGED_LISTS is turned off
+    if (unpagedLists && limitParam.empty() && cursorParam.empty()) {
+        page.limit = kUnpagedLimit;
+        page.after.reset();
+        return true;
+    }
+
+    page.limit = defaultLimit;
+    if (!limitParam.empty()) {
+        size_t limit = 0;
+        auto result = std::from_chars(limitParam.data(), limitParam.data() + limitParam.size(), limit);
+        if (result.ec != std::errc() || result.ptr != limitParam.data() + limitParam.size() ||
+            limit == 0 || limit > maxLimit) {
+            error = "limit must be between 1 and " + std::to_string(maxLimit);
+            return false;
+        }
+        page.limit = limit;
+    }
+
+    page.after.reset();
+    if (!cursorParam.empty()) {
+        PageCursor cursor;
+        if (!decodeCursor(cursorParam, cursor)) {
+            error = "Invalid cursor";
+            return false;
+        }
+        page.after = std::move(cursor);
+    }
+
+    return true;
+}
+
+void writeNextCursor(JsonWriter& out, const std::optional<PageCursor>& next) {
+    out.key("next_cursor");
+    if (next) {
+        out.string(encodeCursor(*next));
+    } else {
+        out.null();
+    }
+}
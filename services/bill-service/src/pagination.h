@@ -0,0 +1,38 @@
+#ifndef PAGINATION_H
+#define PAGINATION_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "json_writer.h"
+
+// Position of the last row returned: the listing's sort timestamp in
+// microseconds since the epoch and the row id as tie-breaker. Clients see
+// it only as an opaque base64url token.
+struct PageCursor {
+    int64_t sortKey = 0;
+    std::string id;
+};
+
+struct PageRequest {
+    size_t limit = 0;
+    std::optional<PageCursor> after;  // unset for the first page
+};
+
+// Limit of a request without `limit` or `cursor` while PAGE_UNPAGED_LISTS is
+// on: no page boundary, yet limit + 1 still fits a PostgreSQL bigint
+inline constexpr size_t kUnpagedLimit = static_cast<size_t>(INT64_MAX - 1);
+
+std::string encodeCursor(const PageCursor& cursor);
+bool decodeCursor(const std::string& token, PageCursor& cursor);
+
+// Build a PageRequest from the `limit` and `cursor` query parameters. With
+// neither, the request is unpaged (kUnpagedLimit) while PAGE_UNPAGED_LISTS is
+// on, and gets PAGE_SIZE_DEFAULT rows once it is off
+bool parsePageRequest(const std::string& limitParam, const std::string& cursorParam,
+                      PageRequest& page, std::string& error);
+
+// Emit "next_cursor": the encoded token, or null on the last page
+void writeNextCursor(JsonWriter& out, const std::optional<PageCursor>& next);
+
+#endif
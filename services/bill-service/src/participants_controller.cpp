@@ -2,20 +2,11 @@
 #include "utils.h"
 #include <iostream>
 
-ParticipantsController::ParticipantsController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth)
-    : db_(db), auth_(auth) {}
+ParticipantsController::ParticipantsController(std::shared_ptr<Database> db)
+    : db_(db) {}
 
-void ParticipantsController::getParticipants(const httplib::Request& req, httplib::Response& res) {
+void ParticipantsController::getParticipants(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -26,8 +17,9 @@ void ParticipantsController::getParticipants(const httplib::Request& req, httpli
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -35,10 +27,7 @@ void ParticipantsController::getParticipants(const httplib::Request& req, httpli
         }
 
         // Check if user has access (creator or participant)
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isParticipant = db_->isParticipant(eventId, authResult.userId);
-        
-        if (!isCreator && !isParticipant) {
+        if (!access.isCreator && !access.isParticipant) {
             json errorResponse = createErrorResponse("Access denied", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -46,13 +35,25 @@ void ParticipantsController::getParticipants(const httplib::Request& req, httpli
         }
 
         // Get participants for event
-        json participants = db_->getParticipantsByEvent(eventId);
+        PageRequest page;
+        std::string pageError;
+        if (!parsePageRequest(req.get_param_value("limit"), req.get_param_value("cursor"), page, pageError)) {
+            json errorResponse = createErrorResponse(pageError);
+            res.status = 400;
+            res.set_content(errorResponse.dump(), "application/json");
+            return;
+        }
         
-        json response = createSuccessResponse();
-        response["participants"] = participants;
+        JsonWriter out;
+        out.beginObject();
+        out.key("participants");
+        auto nextCursor = db_->writeParticipantsByEvent(eventId, page, out);
+        writeNextCursor(out, nextCursor);
+        writeSuccessFields(out);
+        out.endObject();
         
         res.status = 200;
-        res.set_content(response.dump(), "application/json");
+        res.set_content(out.release(), "application/json");
         
     } catch (const std::exception& e) {
         json errorResponse = createErrorResponse("Failed to retrieve participants: " + std::string(e.what()), 500);
@@ -61,17 +62,8 @@ void ParticipantsController::getParticipants(const httplib::Request& req, httpli
     }
 }
 
-void ParticipantsController::addParticipant(const httplib::Request& req, httplib::Response& res) {
+void ParticipantsController::addParticipant(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID from URL
         std::string eventId = req.matches[1];
         
@@ -82,8 +74,9 @@ void ParticipantsController::addParticipant(const httplib::Request& req, httplib
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -91,7 +84,7 @@ void ParticipantsController::addParticipant(const httplib::Request& req, httplib
         }
 
         // Check if user is the event creator
-        if (!db_->isEventCreator(eventId, authResult.userId)) {
+        if (!access.isCreator) {
             json errorResponse = createErrorResponse("Only event creator can add participants", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
@@ -128,7 +121,8 @@ void ParticipantsController::addParticipant(const httplib::Request& req, httplib
         }
 
         // Check if user is already a participant
-        if (db_->isParticipant(eventId, participantReq.userId)) {
+        auto targetAccess = db_->resolveEventAccess(eventId, participantReq.userId);
+        if (targetAccess.isParticipant) {
             json errorResponse = createErrorResponse("User is already a participant");
             res.status = 409;
             res.set_content(errorResponse.dump(), "application/json");
@@ -136,7 +130,7 @@ void ParticipantsController::addParticipant(const httplib::Request& req, httplib
         }
 
         // Check if user is the event creator (creator is automatically a participant)
-        if (db_->isEventCreator(eventId, participantReq.userId)) {
+        if (targetAccess.isCreator) {
             json errorResponse = createErrorResponse("Event creator is automatically a participant");
             res.status = 409;
             res.set_content(errorResponse.dump(), "application/json");
@@ -144,15 +138,15 @@ void ParticipantsController::addParticipant(const httplib::Request& req, httplib
         }
 
         // Add participant
-        json participant = db_->addParticipant(
+        Participant participant = db_->addParticipant(
             eventId,
             participantReq.userId,
             participantReq.sharePercentage,
-            participantReq.customAmount
+            amountToCents(participantReq.customAmount)
         );
 
         json response = createSuccessResponse();
-        response["participant"] = participant;
+        response["participant"] = toJson(participant);
         
         res.status = 201;
         res.set_content(response.dump(), "application/json");
@@ -164,17 +158,8 @@ void ParticipantsController::addParticipant(const httplib::Request& req, httplib
     }
 }
 
-void ParticipantsController::updateParticipant(const httplib::Request& req, httplib::Response& res) {
+void ParticipantsController::updateParticipant(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID and user ID from URL
         std::string eventId = req.matches[1];
         std::string userId = req.matches[2];
@@ -186,8 +171,9 @@ void ParticipantsController::updateParticipant(const httplib::Request& req, http
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -195,7 +181,10 @@ void ParticipantsController::updateParticipant(const httplib::Request& req, http
         }
 
         // Check if user is participant
-        if (!db_->isParticipant(eventId, userId)) {
+        auto targetAccess = userId == context.userId
+            ? access
+            : db_->resolveEventAccess(eventId, userId);
+        if (!targetAccess.isParticipant) {
             json errorResponse = createErrorResponse("User is not a participant", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -203,8 +192,8 @@ void ParticipantsController::updateParticipant(const httplib::Request& req, http
         }
 
         // Check if current user is the event creator or the participant being updated
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isSelf = (authResult.userId == userId);
+        bool isCreator = access.isCreator;
+        bool isSelf = (context.userId == userId);
         
         if (!isCreator && !isSelf) {
             json errorResponse = createErrorResponse("Only event creator or the participant can update participation", 403);
@@ -239,7 +228,7 @@ void ParticipantsController::updateParticipant(const httplib::Request& req, http
             eventId,
             userId,
             updateReq.sharePercentage,
-            updateReq.customAmount
+            amountToCents(updateReq.customAmount)
         );
 
         if (!updated) {
@@ -262,17 +251,8 @@ void ParticipantsController::updateParticipant(const httplib::Request& req, http
     }
 }
 
-void ParticipantsController::removeParticipant(const httplib::Request& req, httplib::Response& res) {
+void ParticipantsController::removeParticipant(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        // Authenticate user
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         // Extract event ID and user ID from URL
         std::string eventId = req.matches[1];
         std::string userId = req.matches[2];
@@ -284,8 +264,9 @@ void ParticipantsController::removeParticipant(const httplib::Request& req, http
             return;
         }
 
-        // Check if event exists
-        if (!db_->eventExists(eventId)) {
+        // Check if event exists and load the caller's role in it
+        auto access = db_->resolveEventAccess(eventId, context.userId);
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -293,7 +274,10 @@ void ParticipantsController::removeParticipant(const httplib::Request& req, http
         }
 
         // Check if user is participant
-        if (!db_->isParticipant(eventId, userId)) {
+        auto targetAccess = userId == context.userId
+            ? access
+            : db_->resolveEventAccess(eventId, userId);
+        if (!targetAccess.isParticipant) {
             json errorResponse = createErrorResponse("User is not a participant", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
@@ -301,8 +285,8 @@ void ParticipantsController::removeParticipant(const httplib::Request& req, http
         }
 
         // Check if current user is the event creator or the participant being removed
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isSelf = (authResult.userId == userId);
+        bool isCreator = access.isCreator;
+        bool isSelf = (context.userId == userId);
         
         if (!isCreator && !isSelf) {
             json errorResponse = createErrorResponse("Only event creator or the participant can remove participation", 403);
@@ -312,7 +296,7 @@ void ParticipantsController::removeParticipant(const httplib::Request& req, http
         }
 
         // Prevent removing event creator
-        if (db_->isEventCreator(eventId, userId)) {
+        if (targetAccess.isCreator) {
             json errorResponse = createErrorResponse("Cannot remove event creator from participants");
             res.status = 400;
             res.set_content(errorResponse.dump(), "application/json");
@@ -5,22 +5,21 @@
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include "database.h"
-#include "auth_middleware.h"
+#include "request_context.h"
 
 using json = nlohmann::json;
 
 class ParticipantsController {
 public:
-    ParticipantsController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth);
+    explicit ParticipantsController(std::shared_ptr<Database> db);
     
-    void getParticipants(const httplib::Request& req, httplib::Response& res);
-    void addParticipant(const httplib::Request& req, httplib::Response& res);
-    void updateParticipant(const httplib::Request& req, httplib::Response& res);
-    void removeParticipant(const httplib::Request& req, httplib::Response& res);
+    void getParticipants(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void addParticipant(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void updateParticipant(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    void removeParticipant(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
 
 private:
     std::shared_ptr<Database> db_;
-    std::shared_ptr<AuthMiddleware> auth_;
     
     struct AddParticipantRequest {
         std::string userId;
@@ -0,0 +1,277 @@
+#include "prepared_statements.h"
+
+const std::vector<PreparedStatement>& preparedStatements() {
+    static const std::vector<PreparedStatement> statements = {
+        // Events
+        {Statements::EventInsert,
+            "INSERT INTO events (creator_id, name, description, event_type, start_date, end_date) "
+            "VALUES ($1, $2, $3, $4, $5::timestamptz, $6::timestamptz) "
+            "RETURNING id, creator_id, name, description, event_type, status, "
+            "(EXTRACT(EPOCH FROM start_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM end_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM created_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM updated_at) * 1000)::bigint"},
+        {Statements::EventById,
+            "SELECT e.id, e.creator_id, e.name, e.description, e.event_type, e.status, "
+            "(EXTRACT(EPOCH FROM e.start_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.end_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.updated_at) * 1000)::bigint, "
+            "u.name as creator_name, u.family_name as creator_family_name "
+            "FROM events e "
+            "JOIN users u ON e.creator_id = u.id "
+            "WHERE e.id = $1"},
+        {Statements::EventsByUser,
+            "SELECT e.id, e.creator_id, e.name, e.description, e.event_type, e.status, "
+            "(EXTRACT(EPOCH FROM e.start_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.end_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.updated_at) * 1000)::bigint "
+            "FROM events e "
+            "WHERE e.creator_id = $1 "
+            "OR EXISTS (SELECT 1 FROM participants p WHERE p.event_id = e.id AND p.user_id = $1) "
+            "ORDER BY e.created_at DESC, e.id DESC"},
+
+        // Keyset pages: the trailing column is the sort key in microseconds,
+        // and each branch of the UNION stops after $2 (or $4) rows on its index
+        {Statements::EventsByUserPage,
+            "SELECT e.id, e.creator_id, e.name, e.description, e.event_type, e.status, "
+            "(EXTRACT(EPOCH FROM e.start_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.end_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.updated_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000000)::bigint "
+            "FROM events e "
+            "WHERE e.id IN ("
+            "(SELECT c.id FROM events c WHERE c.creator_id = $1 "
+            "ORDER BY c.created_at DESC, c.id DESC LIMIT $2) "
+            "UNION ALL "
+            "(SELECT pe.id FROM participants p JOIN events pe ON pe.id = p.event_id "
+            "WHERE p.user_id = $1 ORDER BY pe.created_at DESC, pe.id DESC LIMIT $2)) "
+            "ORDER BY e.created_at DESC, e.id DESC "
+            "LIMIT $2"},
+        {Statements::EventsByUserAfter,
+            "SELECT e.id, e.creator_id, e.name, e.description, e.event_type, e.status, "
+            "(EXTRACT(EPOCH FROM e.start_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.end_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.updated_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000000)::bigint "
+            "FROM events e "
+            "WHERE e.id IN ("
+            "(SELECT c.id FROM events c WHERE c.creator_id = $1 "
+            "AND (c.created_at, c.id) < (TIMESTAMPTZ 'epoch' + $2::bigint * INTERVAL '1 microsecond', $3::uuid) "
+            "ORDER BY c.created_at DESC, c.id DESC LIMIT $4) "
+            "UNION ALL "
+            "(SELECT pe.id FROM participants p JOIN events pe ON pe.id = p.event_id "
+            "WHERE p.user_id = $1 "
+            "AND (pe.created_at, pe.id) < (TIMESTAMPTZ 'epoch' + $2::bigint * INTERVAL '1 microsecond', $3::uuid) "
+            "ORDER BY pe.created_at DESC, pe.id DESC LIMIT $4)) "
+            "ORDER BY e.created_at DESC, e.id DESC "
+            "LIMIT $4"},
+        {Statements::EventUpdate,
+            "UPDATE events SET "
+            "name = COALESCE($2, name), "
+            "description = COALESCE($3, description), "
+            "event_type = COALESCE($4::event_type, event_type), "
+            "status = COALESCE($5::event_status, status), "
+            "start_date = COALESCE($6::timestamptz, start_date), "
+            "end_date = COALESCE($7::timestamptz, end_date), "
+            "updated_at = CURRENT_TIMESTAMP "
+            "WHERE id = $1 "
+            "RETURNING id, creator_id, name, description, event_type, status, "
+            "(EXTRACT(EPOCH FROM start_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM end_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM created_at) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM updated_at) * 1000)::bigint"},
+        {Statements::EventDelete,
+            "DELETE FROM events WHERE id = $1"},
+
+        // Expenses (amounts cross the wire as integer cents)
+        {Statements::ExpenseInsert,
+            "INSERT INTO expenses (event_id, payer_id, amount, description, split_type) "
+            "VALUES ($1, $2, $3::bigint / 100.0, $4, $5) "
+            "RETURNING id, event_id, payer_id, (amount * 100)::bigint, description, split_type, "
+            "(EXTRACT(EPOCH FROM expense_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM created_at) * 1000)::bigint"},
+        {Statements::ExpensesByEvent,
+            "SELECT e.id, e.event_id, e.payer_id, (e.amount * 100)::bigint, e.description, e.split_type, "
+            "(EXTRACT(EPOCH FROM e.expense_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "u.name as payer_name, u.family_name as payer_family_name "
+            "FROM expenses e "
+            "JOIN users u ON e.payer_id = u.id "
+            "WHERE e.event_id = $1 "
+            "ORDER BY e.expense_date DESC, e.id DESC"},
+        {Statements::ExpensesByEventPage,
+            "SELECT e.id, e.event_id, e.payer_id, (e.amount * 100)::bigint, e.description, e.split_type, "
+            "(EXTRACT(EPOCH FROM e.expense_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "u.name as payer_name, u.family_name as payer_family_name, "
+            "(EXTRACT(EPOCH FROM e.expense_date) * 1000000)::bigint "
+            "FROM expenses e "
+            "JOIN users u ON e.payer_id = u.id "
+            "WHERE e.event_id = $1 "
+            "ORDER BY e.expense_date DESC, e.id DESC "
+            "LIMIT $2"},
+        {Statements::ExpensesByEventAfter,
+            "SELECT e.id, e.event_id, e.payer_id, (e.amount * 100)::bigint, e.description, e.split_type, "
+            "(EXTRACT(EPOCH FROM e.expense_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "u.name as payer_name, u.family_name as payer_family_name, "
+            "(EXTRACT(EPOCH FROM e.expense_date) * 1000000)::bigint "
+            "FROM expenses e "
+            "JOIN users u ON e.payer_id = u.id "
+            "WHERE e.event_id = $1 "
+            "AND (e.expense_date, e.id) < (TIMESTAMPTZ 'epoch' + $2::bigint * INTERVAL '1 microsecond', $3::uuid) "
+            "ORDER BY e.expense_date DESC, e.id DESC "
+            "LIMIT $4"},
+        {Statements::ExpenseById,
+            "SELECT e.id, e.event_id, e.payer_id, (e.amount * 100)::bigint, e.description, e.split_type, "
+            "(EXTRACT(EPOCH FROM e.expense_date) * 1000)::bigint, "
+            "(EXTRACT(EPOCH FROM e.created_at) * 1000)::bigint, "
+            "u.name as payer_name, u.family_name as payer_family_name "
+            "FROM expenses e "
+            "JOIN users u ON e.payer_id = u.id "
+            "WHERE e.id = $1"},
+        {Statements::ExpenseEventId,
+            "SELECT event_id FROM expenses WHERE id = $1"},
+        {Statements::ExpenseDelete,
+            "DELETE FROM expenses WHERE id = $1 "
+            "RETURNING event_id, payer_id, (amount * 100)::bigint"},
+
+        // Participants (a zero share or amount is stored as NULL)
+        {Statements::ParticipantInsert,
+            "INSERT INTO participants (event_id, user_id, share_percentage, custom_amount) "
+            "VALUES ($1, $2, NULLIF($3::numeric, 0), NULLIF($4::bigint, 0) / 100.0) "
+            "RETURNING id, event_id, user_id, share_percentage, (custom_amount * 100)::bigint, status, "
+            "(EXTRACT(EPOCH FROM joined_at) * 1000)::bigint"},
+        {Statements::ParticipantsByEvent,
+            "SELECT p.id, p.event_id, p.user_id, p.share_percentage, (p.custom_amount * 100)::bigint, "
+            "p.status, (EXTRACT(EPOCH FROM p.joined_at) * 1000)::bigint, "
+            "u.name, u.family_name, u.email "
+            "FROM participants p "
+            "JOIN users u ON p.user_id = u.id "
+            "WHERE p.event_id = $1 AND p.status = 'active' "
+            "ORDER BY p.joined_at, p.id"},
+        {Statements::ParticipantsByEventPage,
+            "SELECT p.id, p.event_id, p.user_id, p.share_percentage, (p.custom_amount * 100)::bigint, "
+            "p.status, (EXTRACT(EPOCH FROM p.joined_at) * 1000)::bigint, "
+            "u.name, u.family_name, u.email, "
+            "(EXTRACT(EPOCH FROM p.joined_at) * 1000000)::bigint "
+            "FROM participants p "
+            "JOIN users u ON p.user_id = u.id "
+            "WHERE p.event_id = $1 AND p.status = 'active' "
+            "ORDER BY p.joined_at, p.id "
+            "LIMIT $2"},
+        {Statements::ParticipantsByEventAfter,
+            "SELECT p.id, p.event_id, p.user_id, p.share_percentage, (p.custom_amount * 100)::bigint, "
+            "p.status, (EXTRACT(EPOCH FROM p.joined_at) * 1000)::bigint, "
+            "u.name, u.family_name, u.email, "
+            "(EXTRACT(EPOCH FROM p.joined_at) * 1000000)::bigint "
+            "FROM participants p "
+            "JOIN users u ON p.user_id = u.id "
+            "WHERE p.event_id = $1 AND p.status = 'active' "
+            "AND (p.joined_at, p.id) > (TIMESTAMPTZ 'epoch' + $2::bigint * INTERVAL '1 microsecond', $3::uuid) "
+            "ORDER BY p.joined_at, p.id "
+            "LIMIT $4"},
+        {Statements::ParticipantDelete,
+            "DELETE FROM participants WHERE event_id = $1 AND user_id = $2"},
+        {Statements::ParticipantUpdate,
+            "UPDATE participants SET "
+            "share_percentage = NULLIF($3::numeric, 0), "
+            "custom_amount = NULLIF($4::bigint, 0) / 100.0, "
+            "updated_at = CURRENT_TIMESTAMP "
+            "WHERE event_id = $1 AND user_id = $2"},
+
+        // Balance ledger. Writers lock the event row first so ledger updates
+        // for one event apply in commit order. Members are the creator plus
+        // active participants; each expense is split equally in cents with
+        // the leftover cents going to the first members by user id, exactly
+        // as SplitCalculator does.
+        {Statements::LockEventLedger,
+            "SELECT 1 FROM events WHERE id = $1 FOR NO KEY UPDATE"},
+        {Statements::LedgerApplyExpense,
+            "WITH members AS ("
+            "SELECT user_id, row_number() OVER (ORDER BY user_id) - 1 AS idx, count(*) OVER () AS n "
+            "FROM (SELECT creator_id AS user_id FROM events WHERE id = $1 "
+            "UNION SELECT user_id FROM participants WHERE event_id = $1 AND status = 'active') m) "
+            "INSERT INTO event_balances (event_id, user_id, balance_cents) "
+            "SELECT $1, user_id, $4::integer * ("
+            "CASE WHEN user_id = $2 THEN $3::bigint ELSE 0 END "
+            "- ($3::bigint / n + CASE WHEN idx < $3::bigint % n THEN 1 ELSE 0 END)) "
+            "FROM members "
+            "ON CONFLICT (event_id, user_id) DO UPDATE SET "
+            "balance_cents = event_balances.balance_cents + EXCLUDED.balance_cents, "
+            "version = event_balances.version + 1, "
+            "updated_at = CURRENT_TIMESTAMP"},
+        {Statements::LedgerRebuild,
+            "WITH members AS ("
+            "SELECT user_id, row_number() OVER (ORDER BY user_id) - 1 AS idx, count(*) OVER () AS n "
+            "FROM (SELECT creator_id AS user_id FROM events WHERE id = $1 "
+            "UNION SELECT user_id FROM participants WHERE event_id = $1 AND status = 'active') m), "
+            "expense_cents AS ("
+            "SELECT payer_id, (amount * 100)::bigint AS cents FROM expenses WHERE event_id = $1), "
+            "balances AS ("
+            "SELECT m.user_id, COALESCE(SUM("
+            "CASE WHEN x.payer_id = m.user_id THEN x.cents ELSE 0 END "
+            "- (x.cents / m.n + CASE WHEN m.idx < x.cents % m.n THEN 1 ELSE 0 END)), 0)::bigint AS balance_cents "
+            "FROM members m LEFT JOIN expense_cents x ON true "
+            "GROUP BY m.user_id), "
+            "removed AS ("
+            "DELETE FROM event_balances b WHERE b.event_id = $1 "
+            "AND NOT EXISTS (SELECT 1 FROM members m WHERE m.user_id = b.user_id)) "
+            "INSERT INTO event_balances (event_id, user_id, balance_cents) "
+            "SELECT $1, user_id, balance_cents FROM balances "
+            "ON CONFLICT (event_id, user_id) DO UPDATE SET "
+            "balance_cents = EXCLUDED.balance_cents, "
+            "version = event_balances.version + 1, "
+            "updated_at = CURRENT_TIMESTAMP"},
+        {Statements::BalancesByEvent,
+            "SELECT user_id, balance_cents FROM event_balances WHERE event_id = $1"},
+        {Statements::BalancesByUser,
+            "SELECT b.event_id, e.name, b.balance_cents, "
+            "COALESCE(SUM(b.balance_cents) OVER (), 0)::bigint AS total_cents "
+            "FROM event_balances b "
+            "JOIN events e ON e.id = b.event_id "
+            "WHERE b.user_id = $1 "
+            "ORDER BY e.created_at DESC, e.id DESC"},
+        {Statements::EventIds,
+            "SELECT id FROM events ORDER BY created_at, id"},
+
+        // Bumped after LockEventLedger by every write that can change an
+        // event's balances; events without a row are at version 0
+        {Statements::EventVersionBump,
+            "INSERT INTO event_versions (event_id, version) VALUES ($1, 1) "
+            "ON CONFLICT (event_id) DO UPDATE SET version = event_versions.version + 1"},
+        // The version with the ledger rows it describes: one statement, so one
+        // snapshot. Always one row; user_id is NULL when there are no balances
+        {Statements::VersionedBalancesByEvent,
+            "SELECT v.version, b.user_id, b.balance_cents "
+            "FROM (SELECT COALESCE((SELECT version FROM event_versions WHERE event_id = $1), 0) AS version) v "
+            "LEFT JOIN event_balances b ON b.event_id = $1"},
+
+        // Access checks
+        {Statements::UserExists,
+            "SELECT 1 FROM users WHERE id = $1 AND is_active = true"},
+        {Statements::ResolveEventAccess,
+            "SELECT e.status, e.creator_id = $2 AS is_creator, "
+            "EXISTS (SELECT 1 FROM participants p "
+            "WHERE p.event_id = e.id AND p.user_id = $2 AND p.status = 'active') AS is_participant "
+            "FROM events e "
+            "WHERE e.id = $1"}
+    };
+
+    return statements;
+}
+
+void prepareStatements(pqxx::connection& conn) {
+    for (const auto& statement : preparedStatements()) {
+        conn.prepare(statement.name, statement.sql);
+#if PQXX_VERSION_MAJOR < 7
+        // libpqxx 6 defers PREPARE to the first exec_prepared; pipelined
+        // reads EXECUTE by name and need the statement on the server already
+        conn.prepare_now(statement.name);
+#endif
+    }
+}
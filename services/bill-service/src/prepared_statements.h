@@ -0,0 +1,63 @@
+#ifndef PREPARED_STATEMENTS_H
+#define PREPARED_STATEMENTS_H
+
+#include <pqxx/pqxx>
+#include <vector>
+
+// Names of the statements every pooled connection prepares when it opens.
+// Database methods invoke them with txn.exec_prepared(Statements::X, ...).
+namespace Statements {
+    // Events
+    constexpr const char* EventInsert = "event_insert";
+    constexpr const char* EventById = "event_by_id";
+    constexpr const char* EventsByUser = "events_by_user";
+    constexpr const char* EventsByUserPage = "events_by_user_page";
+    constexpr const char* EventsByUserAfter = "events_by_user_after";
+    constexpr const char* EventUpdate = "event_update";
+    constexpr const char* EventDelete = "event_delete";
+
+    // Expenses
+    constexpr const char* ExpenseInsert = "expense_insert";
+    constexpr const char* ExpensesByEvent = "expenses_by_event";
+    constexpr const char* ExpensesByEventPage = "expenses_by_event_page";
+    constexpr const char* ExpensesByEventAfter = "expenses_by_event_after";
+    constexpr const char* ExpenseById = "expense_by_id";
+    constexpr const char* ExpenseEventId = "expense_event_id";
+    constexpr const char* ExpenseDelete = "expense_delete";
+
+    // Participants
+    constexpr const char* ParticipantInsert = "participant_insert";
+    constexpr const char* ParticipantsByEvent = "participants_by_event";
+    constexpr const char* ParticipantsByEventPage = "participants_by_event_page";
+    constexpr const char* ParticipantsByEventAfter = "participants_by_event_after";
+    constexpr const char* ParticipantDelete = "participant_delete";
+    constexpr const char* ParticipantUpdate = "participant_update";
+
+    // Balance ledger
+    constexpr const char* LockEventLedger = "lock_event_ledger";
+    constexpr const char* LedgerApplyExpense = "ledger_apply_expense";
+    constexpr const char* LedgerRebuild = "ledger_rebuild";
+    constexpr const char* BalancesByEvent = "balances_by_event";
+    constexpr const char* BalancesByUser = "balances_by_user";
+    constexpr const char* EventIds = "event_ids";
+
+    // Per-event change counter for versioned response caches
+    constexpr const char* EventVersionBump = "event_version_bump";
+    constexpr const char* VersionedBalancesByEvent = "versioned_balances_by_event";
+
+    // Access checks
+    constexpr const char* UserExists = "user_exists";
+    constexpr const char* ResolveEventAccess = "resolve_event_access";
+}
+
+struct PreparedStatement {
+    const char* name;
+    const char* sql;
+};
+
+const std::vector<PreparedStatement>& preparedStatements();
+
+// Prepare the whole registry on a freshly opened connection
+void prepareStatements(pqxx::connection& conn);
+
+#endif
@@ -1,284 +1,965 @@
 #include "redis_client.h"
+#include "memory_backend.h"
 #include "utils.h"
-#include <iostream>
+#include "logger.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cerrno>
 #include <cstring>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
 
-RedisClient::RedisClient() : context_(nullptr) {
+// GET the session and, if present, extend (never shorten or remove) its TTL
+static const char* kLookupTokenScript =
+    "local value = redis.call('GET', KEYS[1]) "
+    "if value then "
+    "local ttl = redis.call('TTL', KEYS[1]) "
+    "if ttl >= 0 and ttl < tonumber(ARGV[1]) then redis.call('EXPIRE', KEYS[1], ARGV[1]) end "
+    "end "
+    "return value";
+
+// Tag bytes for setCacheObject payloads
+static const char kEncodingJson = 'j';
+static const char kEncodingMsgpack = 'm';
+static const char kEncodingCbor = 'c';
+
+// Shared with the auth service, which adds to it on logout
+static const char* kRevokedTokensKey = "revoked_tokens";
+
+// Keyspace channels look like __keyspace@<db>__:token:<token>
+static const char* kTokenKeyspacePattern = "__keyspace@*__:token:*";
+
+RedisClient::Lease::Lease(RedisClient* client, Node* node, ContextPtr context, bool reused)
+    : client_(client), node_(node), context_(std::move(context)), reused_(reused) {}
+
+RedisClient::Lease::Lease(Lease&& other) noexcept
+    : client_(other.client_), node_(other.node_), context_(std::move(other.context_)), reused_(other.reused_) {
+    other.client_ = nullptr;
+}
+
+RedisClient::Lease::~Lease() {
+    if (client_ && context_) {
+        client_->release(*node_, std::move(context_));
+    }
+}
+
+RedisClient::RedisClient()
+    : ring_(loadRedisNodes()),
+      nearCacheEnabled_(getEnvVar("REDIS_NEAR_CACHE", "false") == "true"),
+      nearCache_(std::stoul(getEnvVar("REDIS_NEAR_CACHE_CAPACITY", "10000")),
+                 std::stoul(getEnvVar("REDIS_NEAR_CACHE_SHARDS", "16")),
+                 std::chrono::milliseconds(std::stol(getEnvVar("REDIS_NEAR_CACHE_TTL_MS", "60000")))) {
     initializeConnection();
+
+    if (getEnvVar("REDIS_BACKEND", "redis") == "memory") {
+        backend_ = std::make_shared<MemoryBackend>();
+    }
+}
+
+RedisClient::RedisClient(std::shared_ptr<KeyValueBackend> backend)
+    : RedisClient() {
+    backend_ = std::move(backend);
 }
 
 RedisClient::~RedisClient() {
+    stopTokenInvalidation();
+    for (auto& node : nodes_) {
+        stopSubscriber(node->trackingSubscriber);
+    }
+    shutdown_ = true;
     disconnect();
 }
 
 void RedisClient::initializeConnection() {
-    host_ = getEnvVar("REDIS_HOST", "redis");
-    port_ = std::stoi(getEnvVar("REDIS_PORT", "6379"));
+    // Same list, in the same order, as the ring was built from
+    for (const auto& address : loadRedisNodes()) {
+        auto node = std::make_unique<Node>();
+        node->address = address;
+        nodes_.push_back(std::move(node));
+    }
     password_ = getEnvVar("REDIS_PASSWORD", "");
+
+    std::string encoding = getEnvVar("REDIS_CACHE_ENCODING", "msgpack");
+    cacheEncoding_ = encoding == "cbor" ? kEncodingCbor : encoding == "json" ? kEncodingJson : kEncodingMsgpack;
+
+    maxSize_ = std::max<size_t>(1, std::stoul(getEnvVar("REDIS_MAX_CONNECTIONS", "10")));
+    acquireTimeout_ = std::chrono::milliseconds(std::stol(getEnvVar("REDIS_POOL_ACQUIRE_TIMEOUT_MS", "1000")));
+    backoffInitial_ = std::chrono::milliseconds(std::stol(getEnvVar("REDIS_RECONNECT_BACKOFF_MS", "100")));
+    backoffMax_ = std::chrono::milliseconds(std::stol(getEnvVar("REDIS_RECONNECT_BACKOFF_MAX_MS", "5000")));
+    backoffMax_ = std::max(backoffMax_, backoffInitial_);
+    companionPingInterval_ = std::chrono::milliseconds(
+        std::max(1L, std::stol(getEnvVar("REDIS_NEAR_CACHE_PING_MS", "1000"))));
+
+    if (nodes_.size() > 1) {
+        LOG_INFO("Redis: sharding keys across " << nodes_.size() << " nodes");
+    }
 }
 
 bool RedisClient::connect() {
-    try {
-        if (context_) {
-            disconnect();
+    if (backend_) {
+        LOG_INFO("Redis: using the in-memory backend, no server connections");
+        return true;
+    }
+
+    shutdown_ = false;
+    for (auto& node : nodes_) {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        node->nextAttempt = Clock::time_point{};
+    }
+
+    // Opens the first pooled context on every node; the rest are created on demand
+    if (!ping()) {
+        return false;
+    }
+
+    if (nearCacheEnabled_ && nearCache_.enabled()) {
+        for (auto& entry : nodes_) {
+            Node& node = *entry;
+
+            SubscriberHooks hooks;
+            hooks.subscribe = [this](Node& node, redisContext* context) { return subscribeTracking(node, context); };
+            hooks.onMessage = [this](redisReply* message) { handleTrackingMessage(message); };
+            // Entries read before tracking was (re)established may be stale
+            hooks.onSubscribed = [this, &node]() {
+                clearNearCache(node);
+                node.nearCacheActive = true;
+            };
+            hooks.onDisconnected = [this, &node]() {
+                node.nearCacheActive = false;
+                clearNearCache(node);
+            };
+            startSubscriber(node, node.trackingSubscriber, std::move(hooks));
+        }
+    }
+
+    return true;
+}
+
+void RedisClient::disconnect() {
+    for (auto& node : nodes_) {
+        std::vector<ContextPtr> closing;
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            closing.swap(node->idle);
+            node->total -= closing.size();
+        }
+        node->connected = false;
+        node->available.notify_all();
+    }
+}
+
+bool RedisClient::authenticate(redisContext* context) {
+    if (password_.empty()) {
+        return true;
+    }
+
+    ReplyPtr reply(static_cast<redisReply*>(redisCommand(context, "AUTH %b", password_.data(), password_.size())));
+    return reply && reply->type == REDIS_REPLY_STATUS && strcmp(reply->str, "OK") == 0;
+}
+
+RedisClient::ContextPtr RedisClient::openContext(const RedisNode& address) {
+    struct timeval timeout = { 1, 500000 }; // 1.5 seconds
+    ContextPtr context(redisConnectWithTimeout(address.host.c_str(), address.port, timeout));
+
+    if (!context || context->err) {
+        if (context) {
+            LOG_ERROR("Redis connection error (" << address.address() << "): " << context->errstr);
+        } else {
+            LOG_ERROR("Redis connection error: can't allocate redis context");
+        }
+        return nullptr;
+    }
+
+    if (!authenticate(context.get())) {
+        LOG_ERROR("Redis authentication failed (" << address.address() << ")");
+        return nullptr;
+    }
+
+    return context;
+}
+
+RedisClient::Lease RedisClient::acquire(Node& node) {
+    auto start = Clock::now();
+    auto deadline = start + acquireTimeout_;
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(node.mutex);
+
+    while (true) {
+        if (shutdown_) {
+            throw std::runtime_error("Redis client is shut down");
+        }
+
+        if (!node.idle.empty()) {
+            ContextPtr context = std::move(node.idle.back());
+            node.idle.pop_back();
+            ++node.inUse;
+            lock.unlock();
+
+            ++acquired_;
+            if (waited) recordWait(start);
+            return Lease(this, &node, std::move(context), true);
+        }
+
+        if (node.total < maxSize_) {
+            // After a failed connect, fail fast until the backoff window has passed
+            if (Clock::now() < node.nextAttempt) {
+                ++backoffRejections_;
+                throw std::runtime_error("Redis reconnect backoff in effect for " + node.address.address());
+            }
+
+            ++node.total;
+            ++node.inUse;
+            lock.unlock();
+
+            ContextPtr context = openContext(node.address);
+            recordConnectResult(node, context != nullptr);
+            if (!context) {
+                lock.lock();
+                --node.total;
+                --node.inUse;
+                lock.unlock();
+                node.available.notify_one();
+                throw std::runtime_error("Redis connection failed: " + node.address.address());
+            }
+
+            ++created_;
+            ++acquired_;
+            if (waited) recordWait(start);
+            return Lease(this, &node, std::move(context), false);
+        }
+
+        // Every context is checked out
+        if (!waited) {
+            waited = true;
+            ++waits_;
+        }
+
+        if (node.available.wait_until(lock, deadline) == std::cv_status::timeout &&
+            node.idle.empty() && node.total >= maxSize_) {
+            ++timeouts_;
+            recordWait(start);
+            throw std::runtime_error("Timed out waiting for a Redis connection");
+        }
+    }
+}
+
+void RedisClient::release(Node& node, ContextPtr context) {
+    ContextPtr closing;
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        --node.inUse;
+
+        // hiredis contexts are unusable once an I/O or protocol error is set
+        if (shutdown_ || context->err) {
+            --node.total;
+            ++evictedBroken_;
+            closing = std::move(context);
+        } else {
+            node.idle.push_back(std::move(context));
+        }
+    }
+
+    node.available.notify_one();
+}
+
+void RedisClient::recordWait(Clock::time_point start) {
+    uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+
+    waitMicrosTotal_ += micros;
+
+    uint64_t currentMax = waitMicrosMax_.load();
+    while (micros > currentMax && !waitMicrosMax_.compare_exchange_weak(currentMax, micros)) {
+    }
+}
+
+void RedisClient::recordConnectResult(Node& node, bool success) {
+    std::lock_guard<std::mutex> lock(node.mutex);
+
+    if (success) {
+        node.backoff = std::chrono::milliseconds(0);
+        node.nextAttempt = Clock::time_point{};
+        node.connected = true;
+        return;
+    }
+
+    ++connectFailures_;
+    node.backoff = node.backoff.count() == 0 ? backoffInitial_ : std::min(node.backoff * 2, backoffMax_);
+    node.nextAttempt = Clock::now() + node.backoff;
+    node.connected = false;
+}
+
+void RedisClient::startTokenInvalidation(std::function<void(const std::string& token)> onInvalidate,
+                                         std::function<void()> onResync) {
+    if (backend_) {
+        if (onResync) onResync();
+        backend_->setInvalidationListener([this, onInvalidate](const std::string& key) {
+            if (key.compare(0, 6, "token:") == 0) {
+                ++tokenInvalidations_;
+                onInvalidate(key.substr(6));
+            }
+        });
+        return;
+    }
+
+    SubscriberHooks hooks;
+    bool checked = false;
+    hooks.subscribe = [this, checked](Node&, redisContext* context) mutable {
+        if (!checked) {
+            checkKeyspaceNotifications(context);
+            checked = true;
+        }
+        ReplyPtr reply(static_cast<redisReply*>(
+            redisCommand(context, "PSUBSCRIBE %s", kTokenKeyspacePattern)));
+        return reply && reply->type == REDIS_REPLY_ARRAY;
+    };
+    hooks.onMessage = [this, onInvalidate](redisReply* message) {
+        // pmessage, pattern, channel, event
+        if (message->type != REDIS_REPLY_ARRAY || message->elements != 4) {
+            return;
+        }
+
+        std::string channel(message->element[2]->str, message->element[2]->len);
+        std::string event(message->element[3]->str, message->element[3]->len);
+        if (event != "del" && event != "expired" && event != "evicted" && event != "rename_from") {
+            return;
+        }
+
+        size_t keyStart = channel.find("__:token:");
+        if (keyStart != std::string::npos) {
+            ++tokenInvalidations_;
+            onInvalidate(channel.substr(keyStart + 9));
+        }
+    };
+    hooks.onSubscribed = std::move(onResync);
+
+    // Keyspace events are only published by the node holding the key
+    for (auto& node : nodes_) {
+        startSubscriber(*node, node->tokenSubscriber, hooks);
+    }
+}
+
+void RedisClient::stopTokenInvalidation() {
+    if (backend_) {
+        backend_->setInvalidationListener(nullptr);
+    }
+    for (auto& node : nodes_) {
+        stopSubscriber(node->tokenSubscriber);
+    }
+}
+
+void RedisClient::startSubscriber(Node& node, Subscriber& subscriber, SubscriberHooks hooks) {
+    std::lock_guard<std::mutex> lock(subscriberMutex_);
+    if (subscriber.running || subscriber.thread.joinable()) {
+        return;
+    }
+
+    subscriber.running = true;
+    subscriber.thread = std::thread(&RedisClient::runSubscriber, this,
+                                    std::ref(node), std::ref(subscriber), std::move(hooks));
+}
+
+void RedisClient::stopSubscriber(Subscriber& subscriber) {
+    {
+        std::lock_guard<std::mutex> lock(subscriberMutex_);
+        subscriber.running = false;
+        // Unblock a subscriber waiting in redisGetReply
+        if (subscriber.fd >= 0) {
+            ::shutdown(subscriber.fd, SHUT_RDWR);
+        }
+    }
+    subscriberWake_.notify_all();
+
+    if (subscriber.thread.joinable()) {
+        subscriber.thread.join();
+    }
+}
+
+void RedisClient::runSubscriber(Node& node, Subscriber& subscriber, SubscriberHooks hooks) {
+    auto backoff = backoffInitial_;
+
+    while (true) {
+        ContextPtr context = openContext(node.address);
+
+        if (context && hooks.subscribe(node, context.get())) {
+            {
+                std::lock_guard<std::mutex> lock(subscriberMutex_);
+                if (!subscriber.running) {
+                    subscriber.companion.reset();
+                    return;
+                }
+                subscriber.fd = context->fd;
+            }
+
+            subscriber.connected = true;
+            backoff = backoffInitial_;
+            ++subscriber.resyncs;
+            if (hooks.onSubscribed) hooks.onSubscribed();
+
+            readSubscription(node, subscriber, context.get(), hooks);
+
+            subscriber.connected = false;
+            if (hooks.onDisconnected) hooks.onDisconnected();
+            {
+                std::lock_guard<std::mutex> lock(subscriberMutex_);
+                subscriber.fd = -1;
+            }
+        }
+        subscriber.companion.reset();
+
+        std::unique_lock<std::mutex> lock(subscriberMutex_);
+        if (!subscriber.running) {
+            return;
+        }
+        LOG_WARN("Redis subscriber for " << node.address.address()
+                 << " disconnected, retrying in " << backoff.count() << "ms");
+        subscriberWake_.wait_for(lock, backoff, [&subscriber] { return !subscriber.running; });
+        if (!subscriber.running) {
+            return;
         }
-        
-        struct timeval timeout = { 1, 500000 }; // 1.5 seconds
-        context_ = redisConnectWithTimeout(host_.c_str(), port_, timeout);
-        
-        if (context_ == nullptr || context_->err) {
-            if (context_) {
-                std::cerr << "Redis connection error: " << context_->errstr << std::endl;
-                redisFree(context_);
-                context_ = nullptr;
-            } else {
-                std::cerr << "Redis connection error: can't allocate redis context" << std::endl;
+        backoff = std::min(backoff * 2, backoffMax_);
+    }
+}
+
+void RedisClient::readSubscription(Node& node, Subscriber& subscriber, redisContext* context,
+                                   const SubscriberHooks& hooks) {
+    redisContext* companion = subscriber.companion.get();
+    auto nextPing = Clock::now() + companionPingInterval_;
+
+    while (true) {
+        // Replies hiredis has already buffered never make the socket readable again
+        void* raw = nullptr;
+        do {
+            if (redisGetReplyFromReader(context, &raw) != REDIS_OK) {
+                return;
             }
-            return false;
+            if (raw) {
+                ReplyPtr message(static_cast<redisReply*>(raw));
+                hooks.onMessage(message.get());
+            }
+        } while (raw);
+
+        pollfd fds[2] = {{context->fd, POLLIN, 0}, {companion ? companion->fd : -1, POLLIN, 0}};
+        int timeoutMs = -1;
+        if (companion) {
+            auto untilPing = std::chrono::duration_cast<std::chrono::milliseconds>(nextPing - Clock::now());
+            timeoutMs = static_cast<int>(std::max<long long>(0, untilPing.count()));
         }
-        
-        if (!password_.empty()) {
-            if (!authenticate()) {
-                disconnect();
-                return false;
+
+        if (::poll(fds, companion ? 2 : 1, timeoutMs) < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            return;
+        }
+
+        if (fds[0].revents && redisBufferRead(context) != REDIS_OK) {
+            return;
+        }
+
+        if (!companion) {
+            continue;
+        }
+
+        // Nothing is sent on the companion unasked: a close, or a notice such as
+        // tracking-redir-broken, means Redis has stopped tracking for us
+        if (fds[1].revents) {
+            std::string notice = "connection closed";
+            if (redisBufferRead(companion) == REDIS_OK && redisGetReplyFromReader(companion, &raw) == REDIS_OK && raw) {
+                ReplyPtr reply(static_cast<redisReply*>(raw));
+                redisReply* first = reply->type == REDIS_REPLY_ARRAY && reply->elements > 0 ? reply->element[0] : reply.get();
+                notice = first->str ? std::string(first->str, first->len) : "unexpected reply";
+            }
+            LOG_WARN("Redis tracking companion for " << node.address.address() << " lost: " << notice);
+            return;
+        }
+
+        if (Clock::now() >= nextPing) {
+            ReplyPtr pong(static_cast<redisReply*>(redisCommand(companion, "PING")));
+            if (!pong || pong->type != REDIS_REPLY_STATUS) {
+                LOG_WARN("Redis tracking companion for " << node.address.address() << " stopped answering PING");
+                return;
+            }
+            nextPing = Clock::now() + companionPingInterval_;
         }
-        
-        return ping();
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Redis connection exception: " << e.what() << std::endl;
-        return false;
     }
 }
 
-void RedisClient::disconnect() {
-    if (context_) {
-        redisFree(context_);
-        context_ = nullptr;
+void RedisClient::checkKeyspaceNotifications(redisContext* context) {
+    ReplyPtr reply(static_cast<redisReply*>(
+        redisCommand(context, "CONFIG GET notify-keyspace-events")));
+
+    // CONFIG may be disabled on managed servers; only warn when we can tell
+    if (!reply || reply->type != REDIS_REPLY_ARRAY || reply->elements != 2) {
+        return;
+    }
+
+    std::string flags(reply->element[1]->str, reply->element[1]->len);
+    bool keyspace = flags.find('K') != std::string::npos;
+    bool events = flags.find('A') != std::string::npos ||
+                  (flags.find('g') != std::string::npos && flags.find('x') != std::string::npos);
+    if (!keyspace || !events) {
+        LOG_WARN("Redis notify-keyspace-events is \"" << flags
+                 << "\"; token revocations will only be seen after the local cache TTL");
     }
 }
 
-bool RedisClient::authenticate() {
-    if (!context_ || password_.empty()) {
-        return true;
+bool RedisClient::subscribeTracking(Node& node, redisContext* context) {
+    ReplyPtr id(static_cast<redisReply*>(redisCommand(context, "CLIENT ID")));
+    if (!id || id->type != REDIS_REPLY_INTEGER) {
+        return false;
     }
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "AUTH %s", password_.c_str());
-    
-    if (!reply) {
+
+    ReplyPtr subscribed(static_cast<redisReply*>(
+        redisCommand(context, "SUBSCRIBE __redis__:invalidate")));
+    if (!subscribed || subscribed->type != REDIS_REPLY_ARRAY) {
         return false;
     }
-    
-    bool success = (reply->type == REDIS_REPLY_STATUS && 
-                   strcmp(reply->str, "OK") == 0);
-    
-    freeReplyObject(reply);
-    return success;
-}
 
-bool RedisClient::ping() {
-    if (!context_) {
+    // RESP2 cannot carry push messages on a command connection, so tracking is
+    // enabled on a companion connection and redirected to this subscriber.
+    // BCAST mode covers every cache: key, whichever connection read it.
+    ContextPtr control = openContext(node.address);
+    if (!control) {
         return false;
     }
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "PING");
-    
-    if (!reply) {
+
+    ReplyPtr tracking(static_cast<redisReply*>(redisCommand(control.get(),
+        "CLIENT TRACKING on REDIRECT %lld BCAST PREFIX cache:", id->integer)));
+    if (!tracking || tracking->type != REDIS_REPLY_STATUS) {
+        LOG_ERROR("Redis CLIENT TRACKING failed: "
+                  << (tracking ? std::string(tracking->str, tracking->len) : control->errstr));
         return false;
     }
-    
-    bool success = (reply->type == REDIS_REPLY_STATUS && 
-                   strcmp(reply->str, "PONG") == 0);
-    
-    freeReplyObject(reply);
-    return success;
+
+    node.trackingSubscriber.companion = std::move(control);
+    return true;
+}
+
+void RedisClient::handleTrackingMessage(redisReply* message) {
+    // message, __redis__:invalidate, [keys] (nil when the server was flushed)
+    if (message->type != REDIS_REPLY_ARRAY || message->elements != 3) {
+        return;
+    }
+
+    redisReply* keys = message->element[2];
+    if (keys->type == REDIS_REPLY_ARRAY) {
+        for (size_t i = 0; i < keys->elements; ++i) {
+            ++trackingInvalidations_;
+            nearCache_.erase(std::string(keys->element[i]->str, keys->element[i]->len));
+        }
+    } else {
+        ++trackingInvalidations_;
+        nearCache_.clear();
+    }
+}
+
+void RedisClient::clearNearCache(Node& node) {
+    if (nodes_.size() == 1) {
+        nearCache_.clear();
+        return;
+    }
+
+    // Other nodes' entries are still covered by their own tracking
+    nearCache_.eraseIf([this, &node](const std::string& key) { return &nodeFor(key) == &node; });
+}
+
+RedisClient::ReplyPtr RedisClient::execute(const std::string& key, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    ReplyPtr reply = vexecute(nodeFor(key), format, args);
+    va_end(args);
+    return reply;
+}
+
+RedisClient::ReplyPtr RedisClient::executeOn(Node& node, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    ReplyPtr reply = vexecute(node, format, args);
+    va_end(args);
+    return reply;
+}
+
+RedisClient::ReplyPtr RedisClient::vexecute(Node& node, const char* format, va_list args) {
+    ReplyPtr reply;
+    for (int attempt = 0; attempt < 2 && !reply; ++attempt) {
+        try {
+            Lease lease = acquire(node);
+
+            va_list attemptArgs;
+            va_copy(attemptArgs, args);
+            reply.reset(static_cast<redisReply*>(redisvCommand(lease.get(), format, attemptArgs)));
+            va_end(attemptArgs);
+
+            if (!reply) {
+                LOG_ERROR("Redis command error: " << lease.get()->errstr);
+                // Only a context that sat idle may have been closed by the server; retry once on another
+                if (!lease.reused()) {
+                    break;
+                }
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("Redis unavailable: " << e.what());
+            break;
+        }
+    }
+
+    if (reply) {
+        handleReply(reply.get());
+    }
+    return reply;
+}
+
+bool RedisClient::ping() {
+    if (backend_) {
+        return true;
+    }
+
+    bool healthy = true;
+
+    for (auto& node : nodes_) {
+        ReplyPtr reply = executeOn(*node, "PING");
+        if (!reply || reply->type != REDIS_REPLY_STATUS || strcmp(reply->str, "PONG") != 0) {
+            healthy = false;
+        }
+    }
+    return healthy;
 }
 
 bool RedisClient::isConnected() {
-    return context_ != nullptr && context_->err == 0;
+    if (backend_) {
+        return true;
+    }
+    return std::all_of(nodes_.begin(), nodes_.end(),
+                       [](const std::unique_ptr<Node>& node) { return node->connected.load(); });
 }
 
-bool RedisClient::setToken(const std::string& token, const std::string& userData, int ttl) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return false;
+json RedisClient::getStats() const {
+    if (backend_) {
+        json stats = backend_->getStats();
+        stats["token_invalidations"] = tokenInvalidations_.load();
+        return stats;
+    }
+
+    size_t total = 0, inUse = 0, idle = 0;
+    long long backoffMs = 0;
+    uint64_t tokenResyncs = 0, trackingResyncs = 0;
+    bool connected = true, tokenSubscribed = true, nearCacheActive = true;
+    json nodes = json::array();
+
+    for (const auto& node : nodes_) {
+        size_t nodeTotal, nodeInUse, nodeIdle;
+        long long nodeBackoffMs;
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            nodeTotal = node->total;
+            nodeInUse = node->inUse;
+            nodeIdle = node->idle.size();
+            nodeBackoffMs = node->backoff.count();
         }
+
+        total += nodeTotal;
+        inUse += nodeInUse;
+        idle += nodeIdle;
+        backoffMs = std::max(backoffMs, nodeBackoffMs);
+        tokenResyncs += node->tokenSubscriber.resyncs.load();
+        trackingResyncs += node->trackingSubscriber.resyncs.load();
+        connected = connected && node->connected.load();
+        tokenSubscribed = tokenSubscribed && node->tokenSubscriber.connected.load();
+        nearCacheActive = nearCacheActive && node->nearCacheActive.load();
+
+        nodes.push_back(json{
+            {"address", node->address.address()},
+            {"size", nodeTotal},
+            {"in_use", nodeInUse},
+            {"idle", nodeIdle},
+            {"connected", node->connected.load()},
+            {"backoff_ms", nodeBackoffMs},
+            {"token_subscriber_connected", node->tokenSubscriber.connected.load()},
+            {"near_cache_active", node->nearCacheActive.load()}
+        });
     }
-    
+
+    uint64_t waits = waits_.load();
+
+    return json{
+        {"max_size", maxSize_ * nodes_.size()},
+        {"size", total},
+        {"in_use", inUse},
+        {"idle", idle},
+        {"connected", connected},
+        {"acquired", acquired_.load()},
+        {"timeouts", timeouts_.load()},
+        {"waits", waits},
+        {"wait_us_total", waitMicrosTotal_.load()},
+        {"wait_us_avg", waits > 0 ? waitMicrosTotal_.load() / waits : 0},
+        {"wait_us_max", waitMicrosMax_.load()},
+        {"created", created_.load()},
+        {"connect_failures", connectFailures_.load()},
+        {"backoff_ms", backoffMs},
+        {"backoff_rejections", backoffRejections_.load()},
+        {"evicted_broken", evictedBroken_.load()},
+        {"token_subscriber_connected", tokenSubscribed},
+        {"token_invalidations", tokenInvalidations_.load()},
+        {"token_subscriber_resyncs", tokenResyncs},
+        {"near_cache_active", nearCacheActive},
+        {"near_cache_invalidations", trackingInvalidations_.load()},
+        {"near_cache_resyncs", trackingResyncs},
+        {"near_cache", nearCache_.getStats()},
+        {"nodes", nodes}
+    };
+}
+
+bool RedisClient::setToken(const std::string& token, const std::string& userData, int ttl) {
     std::string key = "token:" + token;
-    std::string escapedData = escapeString(userData);
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, 
-        "SETEX %s %d %s", key.c_str(), ttl, escapedData.c_str());
-    
-    if (!reply) {
-        return false;
+    if (backend_) {
+        return backend_->set(key, userData, ttl);
     }
-    
-    bool success = (reply->type == REDIS_REPLY_STATUS && 
-                   strcmp(reply->str, "OK") == 0);
-    
-    freeReplyObject(reply);
-    return success;
+
+    ReplyPtr reply = execute(key, "SETEX %b %d %b", key.data(), key.size(), ttl, userData.data(), userData.size());
+    return reply && reply->type == REDIS_REPLY_STATUS && strcmp(reply->str, "OK") == 0;
 }
 
 std::string RedisClient::getToken(const std::string& token) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return "";
-        }
-    }
-    
     std::string key = "token:" + token;
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "GET %s", key.c_str());
-    
-    if (!reply) {
-        return "";
+    if (backend_) {
+        return backend_->get(key).value_or("");
     }
-    
-    std::string result;
-    if (reply->type == REDIS_REPLY_STRING) {
-        result = std::string(reply->str, reply->len);
+
+    ReplyPtr reply = execute(key, "GET %b", key.data(), key.size());
+    if (!reply || reply->type != REDIS_REPLY_STRING) {
+        return "";
     }
-    
-    freeReplyObject(reply);
-    return result;
+    return std::string(reply->str, reply->len);
 }
 
 bool RedisClient::deleteToken(const std::string& token) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return false;
-        }
-    }
-    
     std::string key = "token:" + token;
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "DEL %s", key.c_str());
-    
-    if (!reply) {
-        return false;
+    if (backend_) {
+        return backend_->del(key);
     }
-    
-    bool success = reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
-    
-    freeReplyObject(reply);
-    return success;
+
+    ReplyPtr reply = execute(key, "DEL %b", key.data(), key.size());
+    return reply && reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
 }
 
 bool RedisClient::tokenExists(const std::string& token) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return false;
-        }
-    }
-    
     std::string key = "token:" + token;
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "EXISTS %s", key.c_str());
-    
-    if (!reply) {
-        return false;
+    if (backend_) {
+        return backend_->exists(key);
     }
-    
-    bool exists = reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
-    
-    freeReplyObject(reply);
-    return exists;
+
+    ReplyPtr reply = execute(key, "EXISTS %b", key.data(), key.size());
+    return reply && reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
 }
 
-bool RedisClient::setCache(const std::string& key, const std::string& value, int ttl) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return false;
+std::string RedisClient::lookupToken(const std::string& token, int slidingTtl) {
+    std::string key = "token:" + token;
+    if (backend_) {
+        return backend_->getAndExtend(key, slidingTtl).value_or("");
+    }
+
+    ReplyPtr reply;
+    if (slidingTtl <= 0) {
+        reply = execute(key, "GET %b", key.data(), key.size());
+    } else {
+        std::string sha = loadLookupScript(key);
+        if (!sha.empty()) {
+            reply = execute(key, "EVALSHA %s 1 %b %d", sha.c_str(), key.data(), key.size(), slidingTtl);
+        }
+
+        // Script cache flushed or server restarted: EVAL runs it and caches it again
+        if (!reply || (reply->type == REDIS_REPLY_ERROR && strncmp(reply->str, "NOSCRIPT", 8) == 0)) {
+            reply = execute(key, "EVAL %s 1 %b %d", kLookupTokenScript, key.data(), key.size(), slidingTtl);
         }
     }
-    
-    std::string cacheKey = "cache:" + key;
-    std::string escapedValue = escapeString(value);
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, 
-        "SETEX %s %d %s", cacheKey.c_str(), ttl, escapedValue.c_str());
-    
-    if (!reply) {
+
+    if (!reply || reply->type != REDIS_REPLY_STRING) {
+        return "";
+    }
+    return std::string(reply->str, reply->len);
+}
+
+static int64_t epochSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::optional<std::vector<std::string>> RedisClient::getRevokedTokens() {
+    if (backend_) {
+        return backend_->zrangeByScore(kRevokedTokensKey, epochSeconds());
+    }
+
+    std::vector<std::string> digests;
+    std::string now = std::to_string(epochSeconds());
+    ReplyPtr reply = execute(kRevokedTokensKey, "ZRANGEBYSCORE %s %b +inf",
+                             kRevokedTokensKey, now.data(), now.size());
+    if (!reply || reply->type != REDIS_REPLY_ARRAY) {
+        return std::nullopt;
+    }
+
+    digests.reserve(reply->elements);
+    for (size_t i = 0; i < reply->elements; ++i) {
+        digests.emplace_back(reply->element[i]->str, reply->element[i]->len);
+    }
+    return digests;
+}
+
+std::optional<bool> RedisClient::isTokenRevoked(const std::string& digestHex) {
+    if (backend_) {
+        return backend_->zscore(kRevokedTokensKey, digestHex).has_value();
+    }
+
+    ReplyPtr reply = execute(kRevokedTokensKey, "ZSCORE %s %b",
+                             kRevokedTokensKey, digestHex.data(), digestHex.size());
+    if (!reply || reply->type == REDIS_REPLY_ERROR) {
+        return std::nullopt;
+    }
+    return reply->type != REDIS_REPLY_NIL;
+}
+
+bool RedisClient::revokeToken(const std::string& digestHex, int64_t expiresAt) {
+    int64_t now = epochSeconds();
+    if (backend_) {
+        backend_->zadd(kRevokedTokensKey, digestHex, expiresAt);
+        backend_->zremRangeByScore(kRevokedTokensKey, now);
+        return true;
+    }
+
+    ReplyPtr reply = execute(kRevokedTokensKey, "ZADD %s %lld %b", kRevokedTokensKey,
+                             static_cast<long long>(expiresAt), digestHex.data(), digestHex.size());
+    if (!reply || reply->type != REDIS_REPLY_INTEGER) {
         return false;
     }
-    
-    bool success = (reply->type == REDIS_REPLY_STATUS && 
-                   strcmp(reply->str, "OK") == 0);
-    
-    freeReplyObject(reply);
-    return success;
+    execute(kRevokedTokensKey, "ZREMRANGEBYSCORE %s -inf %lld", kRevokedTokensKey, static_cast<long long>(now));
+    return true;
+}
+
+bool RedisClient::setCache(const std::string& key, const std::string& value, int ttl) {
+    std::string cacheKey = RedisClient::cacheKey(key);
+    if (backend_) {
+        return backend_->set(cacheKey, value, ttl);
+    }
+
+    ReplyPtr reply = execute(cacheKey, "SETEX %b %d %b", cacheKey.data(), cacheKey.size(), ttl, value.data(), value.size());
+    // Read-your-writes without waiting for the tracking invalidation
+    nearCache_.erase(cacheKey);
+    return reply && reply->type == REDIS_REPLY_STATUS && strcmp(reply->str, "OK") == 0;
 }
 
 std::string RedisClient::getCache(const std::string& key) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return "";
-        }
+    std::string cacheKey = RedisClient::cacheKey(key);
+    if (backend_) {
+        return backend_->get(cacheKey).value_or("");
     }
-    
-    std::string cacheKey = "cache:" + key;
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "GET %s", cacheKey.c_str());
-    
-    if (!reply) {
+
+    bool nearCache = nodeFor(cacheKey).nearCacheActive.load();
+    std::string value;
+    if (nearCache && nearCache_.get(cacheKey, value)) {
+        return value;
+    }
+    // An invalidation that lands while GET is in flight bumps the generation
+    uint64_t generation = nearCache_.generation(cacheKey);
+
+    ReplyPtr reply = execute(cacheKey, "GET %b", cacheKey.data(), cacheKey.size());
+    if (!reply || reply->type != REDIS_REPLY_STRING) {
         return "";
     }
-    
-    std::string result;
-    if (reply->type == REDIS_REPLY_STRING) {
-        result = std::string(reply->str, reply->len);
+
+    value.assign(reply->str, reply->len);
+    if (nearCache) {
+        nearCache_.put(cacheKey, value, generation);
     }
-    
-    freeReplyObject(reply);
-    return result;
+    return value;
 }
 
 bool RedisClient::deleteCache(const std::string& key) {
-    if (!isConnected()) {
-        if (!connect()) {
-            return false;
-        }
+    std::string cacheKey = RedisClient::cacheKey(key);
+    if (backend_) {
+        return backend_->del(cacheKey);
     }
-    
-    std::string cacheKey = "cache:" + key;
-    
-    redisReply* reply = (redisReply*)redisCommand(context_, "DEL %s", cacheKey.c_str());
-    
-    if (!reply) {
-        return false;
+
+    ReplyPtr reply = execute(cacheKey, "DEL %b", cacheKey.data(), cacheKey.size());
+    nearCache_.erase(cacheKey);
+    return reply && reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
+}
+
+bool RedisClient::setCacheObject(const std::string& key, const json& value, int ttl) {
+    return setCache(key, encodeCacheObject(value), ttl);
+}
+
+std::optional<json> RedisClient::getCacheObject(const std::string& key) {
+    return decodeCacheObject(getCache(key));
+}
+
+std::string RedisClient::encodeCacheObject(const json& value) const {
+    // Encoders append straight after the tag byte
+    std::string payload(1, cacheEncoding_);
+
+    if (cacheEncoding_ == kEncodingMsgpack) {
+        json::to_msgpack(value, payload);
+    } else if (cacheEncoding_ == kEncodingCbor) {
+        json::to_cbor(value, payload);
+    } else {
+        payload += value.dump();
     }
-    
-    bool success = reply->type == REDIS_REPLY_INTEGER && reply->integer > 0;
-    
-    freeReplyObject(reply);
-    return success;
+    return payload;
+}
+
+std::optional<json> RedisClient::decodeCacheObject(const std::string& payload) {
+    if (payload.empty()) {
+        return std::nullopt;
+    }
+
+    auto begin = payload.begin() + 1;
+    json value;
+    switch (payload[0]) {
+        case kEncodingMsgpack:
+            value = json::from_msgpack(begin, payload.end(), true, false);
+            break;
+        case kEncodingCbor:
+            value = json::from_cbor(begin, payload.end(), true, false);
+            break;
+        case kEncodingJson:
+            value = json::parse(begin, payload.end(), nullptr, false);
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    // Undecodable entries are treated as misses
+    if (value.is_discarded()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::string RedisClient::loadLookupScript(const std::string& key) {
+    std::lock_guard<std::mutex> lock(scriptMutex_);
+    if (lookupScriptSha_.empty()) {
+        ReplyPtr reply = execute(key, "SCRIPT LOAD %s", kLookupTokenScript);
+        if (reply && reply->type == REDIS_REPLY_STRING) {
+            lookupScriptSha_.assign(reply->str, reply->len);
+        }
+    }
+    return lookupScriptSha_;
 }
 
 void RedisClient::handleReply(redisReply* reply) {
     if (!reply) {
-        std::cerr << "Redis: NULL reply" << std::endl;
+        LOG_ERROR("Redis: NULL reply");
         return;
     }
     
     if (reply->type == REDIS_REPLY_ERROR) {
-        std::cerr << "Redis error: " << reply->str << std::endl;
+        // NOSCRIPT is how EVALSHA reports a flushed script cache; the caller
+        // falls back to EVAL, so it is routine rather than a failure
+        if (strncmp(reply->str, "NOSCRIPT", 8) == 0) {
+            LOG_DEBUG("Redis: script not cached, reloading");
+            return;
+        }
+        LOG_WARN("Redis error: " << reply->str);
     }
 }
-
-std::string RedisClient::escapeString(const std::string& str) {
-    // Basic escaping for Redis strings
-    std::string escaped = str;
-    
-    // Replace any problematic characters
-    size_t pos = 0;
-    while ((pos = escaped.find("\"", pos)) != std::string::npos) {
-        escaped.replace(pos, 1, "\\\"");
-        pos += 2;
-    }
-    
-    return escaped;
-}
\ No newline at end of file
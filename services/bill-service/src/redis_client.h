@@ -2,45 +2,233 @@
 #define REDIS_CLIENT_H
 
 #include <hiredis/hiredis.h>
-#include <string>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "key_value_backend.h"
+#include "redis_nodes.h"
+#include "sharded_cache.h"
 
 using json = nlohmann::json;
 
+// Blocking Redis client. With REDIS_NODES listing several servers, every key
+// is routed to one of them by consistent hashing (see RedisHashRing); each
+// node has its own connection pool, reconnect backoff and subscribers.
+// REDIS_BACKEND=memory (or the backend constructor) swaps the servers for a
+// KeyValueBackend, so the same operations run without any network.
 class RedisClient {
 public:
     RedisClient();
+    explicit RedisClient(std::shared_ptr<KeyValueBackend> backend);
     ~RedisClient();
-    
+
     bool connect();
     void disconnect();
-    
+
     // Token operations
     bool setToken(const std::string& token, const std::string& userData, int ttl = 86400);
     std::string getToken(const std::string& token);
     bool deleteToken(const std::string& token);
     bool tokenExists(const std::string& token);
-    
-    // Cache operations
+    // Validated lookup in one round trip: returns the session data, or "" if the
+    // token is unknown. With slidingTtl > 0 the key's TTL is raised to at least
+    // that many seconds by a server-side script in the same call.
+    std::string lookupToken(const std::string& token, int slidingTtl = 0);
+
+    // Revoked tokens: a sorted set of hex SHA-256 token digests scored by the
+    // token's exp (epoch seconds), written by the auth service on logout.
+    // getRevokedTokens returns the digests that have not expired yet. Both
+    // return nullopt when Redis could not be asked. revokeToken writes an
+    // entry the way the auth service does and prunes lapsed ones.
+    std::optional<std::vector<std::string>> getRevokedTokens();
+    std::optional<bool> isTokenRevoked(const std::string& digestHex);
+    bool revokeToken(const std::string& digestHex, int64_t expiresAt);
+
+    // Cache operations. With REDIS_NEAR_CACHE enabled, getCache serves recently
+    // read keys from memory; Redis tracks the cache: prefix (CLIENT TRACKING
+    // BCAST) and pushes invalidations that drop them.
     bool setCache(const std::string& key, const std::string& value, int ttl = 3600);
     std::string getCache(const std::string& key);
     bool deleteCache(const std::string& key);
-    
-    // Generic operations
+
+    // Structured values, stored as MessagePack, CBOR or JSON text per
+    // REDIS_CACHE_ENCODING. A leading tag byte records the encoding, so
+    // entries written under another setting still decode.
+    bool setCacheObject(const std::string& key, const json& value, int ttl = 3600);
+    std::optional<json> getCacheObject(const std::string& key);
+
+    // The same keys and payloads, for callers that reach Redis through
+    // AsyncRedisClient instead
+    static std::string cacheKey(const std::string& key) { return "cache:" + key; }
+    std::string encodeCacheObject(const json& value) const;
+    static std::optional<json> decodeCacheObject(const std::string& payload);
+    // Whether getCache may answer from memory, without a round trip
+    bool nearCacheEnabled() const { return nearCacheEnabled_; }
+
+    // Keyspace-notification subscriber for token:* deletions, expirations and
+    // evictions, run on its own connection and thread. onInvalidate receives the
+    // raw token; onResync runs on every (re)subscribe, since events may have been
+    // missed while disconnected. Needs notify-keyspace-events with K and g/x/e.
+    void startTokenInvalidation(std::function<void(const std::string& token)> onInvalidate,
+                                std::function<void()> onResync);
+    void stopTokenInvalidation();
+
+    // Generic operations; true only if every node answers / is reachable
     bool ping();
     bool isConnected();
 
+    json getStats() const;
+
 private:
-    redisContext* context_;
-    std::string host_;
-    int port_;
+    using Clock = std::chrono::steady_clock;
+
+    struct ContextDeleter {
+        void operator()(redisContext* context) const { redisFree(context); }
+    };
+    using ContextPtr = std::unique_ptr<redisContext, ContextDeleter>;
+
+    struct ReplyDeleter {
+        void operator()(redisReply* reply) const { freeReplyObject(reply); }
+    };
+    using ReplyPtr = std::unique_ptr<redisReply, ReplyDeleter>;
+
+    // A pub/sub connection on its own thread, resubscribed with backoff
+    struct Subscriber {
+        std::thread thread;
+        bool running = false;  // guarded by subscriberMutex_
+        int fd = -1;           // guarded by subscriberMutex_
+        std::atomic<bool> connected{false};
+        std::atomic<uint64_t> resyncs{0};
+        // Extra connection that must live as long as the subscription; it is
+        // watched and pinged alongside it, and losing it ends the subscription
+        ContextPtr companion;
+    };
+
+    // One Redis server: its connection pool and subscribers
+    struct Node {
+        RedisNode address;
+
+        mutable std::mutex mutex;
+        std::condition_variable available;
+        std::vector<ContextPtr> idle;
+        size_t total = 0;
+        size_t inUse = 0;
+
+        // Reconnect backoff, guarded by mutex
+        std::chrono::milliseconds backoff{0};
+        Clock::time_point nextAttempt{};
+        std::atomic<bool> connected{false};
+
+        Subscriber tokenSubscriber;
+        Subscriber trackingSubscriber;
+        // Near-cache entries for this node's keys are only served while tracked
+        std::atomic<bool> nearCacheActive{false};
+    };
+
+    struct SubscriberHooks {
+        // Issues the (P)SUBSCRIBE; returns false to retry after backoff
+        std::function<bool(Node&, redisContext*)> subscribe;
+        std::function<void(redisReply*)> onMessage;
+        std::function<void()> onSubscribed;
+        std::function<void()> onDisconnected;
+    };
+
+    // RAII checkout of one blocking context; a context is never shared between threads
+    class Lease {
+    public:
+        Lease(RedisClient* client, Node* node, ContextPtr context, bool reused);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        redisContext* get() const { return context_.get(); }
+        bool reused() const { return reused_; }
+
+    private:
+        RedisClient* client_;
+        Node* node_;
+        ContextPtr context_;
+        bool reused_;
+    };
+
+    // Set when running without Redis; every operation goes to it instead
+    std::shared_ptr<KeyValueBackend> backend_;
+
     std::string password_;
-    
+    char cacheEncoding_;  // tag byte of the encoding setCacheObject writes
+
+    size_t maxSize_;  // per node
+    std::chrono::milliseconds acquireTimeout_;
+    std::chrono::milliseconds backoffInitial_;
+    std::chrono::milliseconds backoffMax_;
+    std::chrono::milliseconds companionPingInterval_;
+
+    std::vector<std::unique_ptr<Node>> nodes_;
+    RedisHashRing ring_;
+    std::atomic<bool> shutdown_{false};
+
+    // SHA1 of the sliding-TTL lookup script, set by SCRIPT LOAD. The SHA is the
+    // same on every node; nodes that never loaded it answer NOSCRIPT once.
+    std::mutex scriptMutex_;
+    std::string lookupScriptSha_;
+
+    std::mutex subscriberMutex_;
+    std::condition_variable subscriberWake_;
+    std::atomic<uint64_t> tokenInvalidations_{0};
+
+    // Near cache for getCache
+    bool nearCacheEnabled_;
+    ShardedCache<std::string> nearCache_;
+    std::atomic<uint64_t> trackingInvalidations_{0};
+
+    // Counters
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> waitMicrosTotal_{0};
+    std::atomic<uint64_t> waitMicrosMax_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> created_{0};
+    std::atomic<uint64_t> connectFailures_{0};
+    std::atomic<uint64_t> backoffRejections_{0};
+    std::atomic<uint64_t> evictedBroken_{0};
+
     void initializeConnection();
-    bool authenticate();
+    bool authenticate(redisContext* context);
+    ContextPtr openContext(const RedisNode& address);
+    Node& nodeFor(const std::string& key) { return *nodes_[ring_.nodeFor(key)]; }
+    Lease acquire(Node& node);
+    void release(Node& node, ContextPtr context);
+    void recordWait(Clock::time_point start);
+    void recordConnectResult(Node& node, bool success);
+
+    void startSubscriber(Node& node, Subscriber& subscriber, SubscriberHooks hooks);
+    void stopSubscriber(Subscriber& subscriber);
+    void runSubscriber(Node& node, Subscriber& subscriber, SubscriberHooks hooks);
+    void readSubscription(Node& node, Subscriber& subscriber, redisContext* context,
+                          const SubscriberHooks& hooks);
+    void checkKeyspaceNotifications(redisContext* context);
+    bool subscribeTracking(Node& node, redisContext* context);
+    void handleTrackingMessage(redisReply* message);
+    void clearNearCache(Node& node);
+
+    // Runs the command on the node that owns key
+    ReplyPtr execute(const std::string& key, const char* format, ...);
+    ReplyPtr executeOn(Node& node, const char* format, ...);
+    ReplyPtr vexecute(Node& node, const char* format, va_list args);
+    std::string loadLookupScript(const std::string& key);
     void handleReply(redisReply* reply);
-    std::string escapeString(const std::string& str);
 };
 
-#endif
\ No newline at end of file
+#endif
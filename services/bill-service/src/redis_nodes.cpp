@@ -0,0 +1,86 @@
+#include "redis_nodes.h"
+#include "utils.h"
+#include <algorithm>
+#include <sstream>
+
+std::vector<RedisNode> loadRedisNodes() {
+    std::vector<RedisNode> nodes;
+
+    std::stringstream list(getEnvVar("REDIS_NODES", ""));
+    std::string entry;
+    while (std::getline(list, entry, ',')) {
+        entry = trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        size_t colon = entry.rfind(':');
+        if (colon == std::string::npos) {
+            nodes.push_back(RedisNode{entry, 6379});
+        } else {
+            nodes.push_back(RedisNode{entry.substr(0, colon), std::stoi(entry.substr(colon + 1))});
+        }
+    }
+
+    if (nodes.empty()) {
+        nodes.push_back(RedisNode{getEnvVar("REDIS_HOST", "redis"), std::stoi(getEnvVar("REDIS_PORT", "6379"))});
+    }
+    return nodes;
+}
+
+RedisHashRing::RedisHashRing(const std::vector<RedisNode>& nodes, size_t pointsPerNode)
+    : nodeCount_(nodes.size()) {
+    points_.reserve(nodes.size() * pointsPerNode);
+
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        std::string address = nodes[node].address();
+        for (size_t i = 0; i < pointsPerNode; ++i) {
+            std::string point = address + "-" + std::to_string(i);
+            points_.emplace_back(hash(point.data(), point.size()), node);
+        }
+    }
+
+    std::sort(points_.begin(), points_.end());
+}
+
+size_t RedisHashRing::nodeFor(const std::string& key) const {
+    if (nodeCount_ <= 1) {
+        return 0;
+    }
+
+    const char* data = key.data();
+    size_t length = key.size();
+
+    size_t open = key.find('{');
+    if (open != std::string::npos) {
+        size_t close = key.find('}', open + 1);
+        if (close != std::string::npos && close > open + 1) {
+            data += open + 1;
+            length = close - open - 1;
+        }
+    }
+
+    // First point at or after the key's hash, wrapping around the ring
+    auto it = std::lower_bound(points_.begin(), points_.end(),
+                               std::make_pair(hash(data, length), size_t(0)));
+    if (it == points_.end()) {
+        it = points_.begin();
+    }
+    return it->second;
+}
+
+uint64_t RedisHashRing::hash(const char* data, size_t length) {
+    // FNV-1a, then the MurmurHash3 finalizer to spread similar inputs
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9a34e2e4bb3ULL;
+    h ^= h >> 33;
+    return h;
+}
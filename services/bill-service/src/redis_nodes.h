@@ -0,0 +1,40 @@
+#ifndef REDIS_NODES_H
+#define REDIS_NODES_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct RedisNode {
+    std::string host;
+    int port;
+
+    std::string address() const { return host + ":" + std::to_string(port); }
+};
+
+// REDIS_NODES as a comma-separated host:port list, or REDIS_HOST:REDIS_PORT
+// when unset. Every node shares REDIS_PASSWORD.
+std::vector<RedisNode> loadRedisNodes();
+
+// Client-side consistent hashing over independent Redis servers. Each node
+// owns many points on a 64-bit ring, placed by hashing its address, so the
+// ring does not depend on list order and adding a node moves only about 1/N
+// of the keys. As in Redis Cluster, a key containing a non-empty {tag} is
+// placed by the tag alone, which keeps related keys on one node.
+class RedisHashRing {
+public:
+    explicit RedisHashRing(const std::vector<RedisNode>& nodes, size_t pointsPerNode = 160);
+
+    // Index into the node list the ring was built from
+    size_t nodeFor(const std::string& key) const;
+    size_t size() const { return nodeCount_; }
+
+private:
+    std::vector<std::pair<uint64_t, size_t>> points_;
+    size_t nodeCount_;
+
+    static uint64_t hash(const char* data, size_t length);
+};
+
+#endif
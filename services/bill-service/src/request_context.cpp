@@ -0,0 +1,64 @@
+#include "request_context.h"
+#include <cctype>
+#include <cstdint>
+#include <random>
+
+static thread_local RequestContext currentContext;
+
+// Client ids are echoed into responses and logs, so only short ids made of
+// safe characters are kept
+static bool isUsableTraceId(const std::string& id) {
+    if (id.empty() || id.size() > 64) {
+        return false;
+    }
+    for (char c : id) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string generateTraceId() {
+    static thread_local std::mt19937_64 generator{std::random_device{}()};
+    static const char* digits = "0123456789abcdef";
+
+    std::string id(32, '0');
+    for (size_t i = 0; i < id.size(); i += 16) {
+        uint64_t bits = generator();
+        for (size_t j = 0; j < 16; ++j) {
+            id[i + j] = digits[(bits >> (j * 4)) & 0x0f];
+        }
+    }
+    return id;
+}
+
+RequestContext& RequestContext::begin(const httplib::Request& req) {
+    RequestContext& context = currentContext;
+    context.userId.clear();
+    context.email.clear();
+    context.startTime = std::chrono::steady_clock::now();
+    context.queueTime = std::chrono::microseconds(0);
+
+    auto header = req.headers.find("X-Request-Id");
+    if (header != req.headers.end() && isUsableTraceId(header->second)) {
+        context.traceId = header->second;
+    } else {
+        context.traceId = generateTraceId();
+    }
+    return context;
+}
+
+const RequestContext& RequestContext::current() {
+    return currentContext;
+}
+
+void RequestContext::end() {
+    // Cleared in place, so the thread's next request reuses the string buffers
+    RequestContext& context = currentContext;
+    context.userId.clear();
+    context.email.clear();
+    context.traceId.clear();
+    context.startTime = {};
+    context.queueTime = std::chrono::microseconds(0);
+}
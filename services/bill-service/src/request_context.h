@@ -0,0 +1,27 @@
+#ifndef REQUEST_CONTEXT_H
+#define REQUEST_CONTEXT_H
+
+#include <chrono>
+#include <string>
+#include <httplib.h>
+
+// Per-request state established once in the pre-routing handler and handed
+// to controllers. httplib serves a request's pre-routing handler, route
+// handler and logger on the same worker thread, so the context lives in a
+// thread-local slot between begin() and end().
+struct RequestContext {
+    std::string userId;
+    std::string email;
+    std::chrono::steady_clock::time_point startTime;
+    // Time the connection waited for an HTTP worker before this request
+    std::chrono::microseconds queueTime{0};
+    // X-Request-Id from the client when usable, otherwise generated
+    std::string traceId;
+
+    // Resets this thread's context for a new request
+    static RequestContext& begin(const httplib::Request& req);
+    static const RequestContext& current();
+    static void end();
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "request_metrics.h"
+#include <algorithm>
+
+static thread_local std::chrono::steady_clock::time_point requestStart;
+static thread_local bool requestStarted = false;
+
+std::string RequestMetrics::routeKey(const httplib::Request& req) {
+    // Requests answered before routing (auth failures, shed connections) or
+    // that matched no route share one key, so clients cannot mint new ones
+    if (req.matches.empty()) {
+        return kUnmatched;
+    }
+
+    // Every variable part of a route pattern is a capture group
+    std::string key = req.method + " ";
+    size_t copied = 0;
+    for (size_t i = 1; i < req.matches.size(); ++i) {
+        if (!req.matches[i].matched) {
+            continue;
+        }
+        size_t position = req.matches.position(i);
+        key.append(req.path, copied, position - copied);
+        key += ":id";
+        copied = position + req.matches.length(i);
+    }
+    key.append(req.path, copied, std::string::npos);
+
+    return key;
+}
+
+void RequestMetrics::begin() {
+    requestStart = std::chrono::steady_clock::now();
+    requestStarted = true;
+}
+
+void RequestMetrics::end(const httplib::Request& req, const httplib::Response& res) {
+    if (!requestStarted) {
+        return;
+    }
+    requestStarted = false;
+
+    uint64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - requestStart).count();
+
+    size_t bucket = 0;
+    while (bucket + 1 < kBuckets && (uint64_t{1} << bucket) <= elapsedUs) {
+        ++bucket;
+    }
+
+    std::string key = routeKey(req);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stats = routes_[key];
+    ++stats.count;
+    if (res.status >= 500) {
+        ++stats.errors;
+    }
+    stats.totalUs += elapsedUs;
+    stats.maxUs = std::max(stats.maxUs, elapsedUs);
+    ++stats.buckets[bucket];
+}
+
+uint64_t RequestMetrics::percentile(const RouteStats& stats, double fraction) {
+    uint64_t target = static_cast<uint64_t>(stats.count * fraction);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += stats.buckets[i];
+        if (seen > target) {
+            return std::min(uint64_t{1} << i, stats.maxUs);
+        }
+    }
+    return stats.maxUs;
+}
+
+json RequestMetrics::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    json result = json::object();
+    for (const auto& [key, stats] : routes_) {
+        result[key] = {
+            {"count", stats.count},
+            {"errors", stats.errors},
+            {"avg_us", stats.count > 0 ? stats.totalUs / stats.count : 0},
+            {"max_us", stats.maxUs},
+            {"p50_us", percentile(stats, 0.50)},
+            {"p95_us", percentile(stats, 0.95)},
+            {"p99_us", percentile(stats, 0.99)}
+        };
+    }
+    return result;
+}
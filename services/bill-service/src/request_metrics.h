@@ -0,0 +1,46 @@
+#ifndef REQUEST_METRICS_H
+#define REQUEST_METRICS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Per-handler latency, keyed by method and matched route with captured ids
+// collapsed ("GET /events/:id/settlements"). begin() runs in the pre-routing hook and
+// end() in the server logger, both on the worker thread serving the request.
+class RequestMetrics {
+public:
+    void begin();
+    void end(const httplib::Request& req, const httplib::Response& res);
+
+    json getStats() const;
+
+    static constexpr const char* kUnmatched = "unmatched";
+    static std::string routeKey(const httplib::Request& req);
+
+private:
+    // Bucket i counts requests that took less than 2^i microseconds
+    static constexpr size_t kBuckets = 26;
+
+    struct RouteStats {
+        uint64_t count = 0;
+        uint64_t errors = 0;
+        uint64_t totalUs = 0;
+        uint64_t maxUs = 0;
+        std::array<uint64_t, kBuckets> buckets{};
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, RouteStats> routes_;
+
+    static uint64_t percentile(const RouteStats& stats, double fraction);
+};
+
+#endif
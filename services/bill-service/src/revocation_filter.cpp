@@ -0,0 +1,221 @@
+#include "revocation_filter.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+BloomFilter::BloomFilter(size_t expectedItems, double falsePositiveRate) {
+    double items = static_cast<double>(std::max<size_t>(expectedItems, 1));
+    double rate = std::min(std::max(falsePositiveRate, 1e-9), 0.5);
+    double ln2 = std::log(2.0);
+
+    // m = -n ln p / (ln 2)^2 bits and k = (m / n) ln 2 hashes
+    bitCount_ = std::max<size_t>(64, static_cast<size_t>(std::ceil(-items * std::log(rate) / (ln2 * ln2))));
+    hashCount_ = std::min<size_t>(16, std::max<size_t>(1, static_cast<size_t>(
+        std::lround(static_cast<double>(bitCount_) / items * ln2))));
+    words_.assign((bitCount_ + 63) / 64, 0);
+}
+
+void BloomFilter::seeds(const std::string& digest, uint64_t& h1, uint64_t& h2) {
+    h1 = 0;
+    h2 = 0;
+    std::memcpy(&h1, digest.data(), std::min<size_t>(digest.size(), 8));
+    if (digest.size() > 8) {
+        std::memcpy(&h2, digest.data() + 8, std::min<size_t>(digest.size() - 8, 8));
+    }
+    // An even step could cycle through only part of the bit array
+    h2 |= 1;
+}
+
+void BloomFilter::add(const std::string& digest) {
+    uint64_t h1, h2;
+    seeds(digest, h1, h2);
+
+    for (size_t i = 0; i < hashCount_; ++i) {
+        uint64_t bit = (h1 + i * h2) % bitCount_;
+        words_[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool BloomFilter::mightContain(const std::string& digest) const {
+    uint64_t h1, h2;
+    seeds(digest, h1, h2);
+
+    for (size_t i = 0; i < hashCount_; ++i) {
+        uint64_t bit = (h1 + i * h2) % bitCount_;
+        if (!(words_[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RevocationFilter::RevocationFilter(std::shared_ptr<RedisClient> redis, std::chrono::milliseconds interval,
+                                   double falsePositiveRate)
+    : redis_(redis),
+      interval_(std::max(interval, std::chrono::milliseconds(100))),
+      maxStaleness_(interval_ * 3),
+      falsePositiveRate_(falsePositiveRate) {}
+
+RevocationFilter::~RevocationFilter() {
+    stop();
+}
+
+void RevocationFilter::start(std::function<void(const std::string& digest)> onRevoked) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ || thread_.joinable()) {
+            return;
+        }
+        running_ = true;
+    }
+    onRevoked_ = std::move(onRevoked);
+
+    // Until a sync succeeds every token is checked against Redis
+    if (!sync()) {
+        LOG_WARN("Revocation filter: initial sync failed, checking tokens against Redis");
+    }
+
+    thread_ = std::thread(&RevocationFilter::run, this);
+}
+
+void RevocationFilter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void RevocationFilter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (running_) {
+        wake_.wait_for(lock, interval_, [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+
+        lock.unlock();
+        if (!sync()) {
+            LOG_ERROR("Revocation filter: sync failed");
+        }
+        lock.lock();
+    }
+}
+
+bool RevocationFilter::sync() {
+    auto digests = redis_->getRevokedTokens();
+    if (!digests) {
+        ++syncFailures_;
+        return false;
+    }
+
+    auto filter = std::make_shared<BloomFilter>(digests->size(), falsePositiveRate_);
+    std::vector<std::string> revoked;
+    revoked.reserve(digests->size());
+    for (const auto& hex : *digests) {
+        std::string digest = fromHex(hex);
+        if (digest.size() == 32) {
+            filter->add(digest);
+            revoked.push_back(std::move(digest));
+        }
+    }
+
+    std::atomic_store(&filter_, std::shared_ptr<const BloomFilter>(filter));
+    revokedCount_ = revoked.size();
+    syncedAt_ = Clock::now().time_since_epoch().count();
+    ++syncs_;
+
+    if (onRevoked_) {
+        for (const auto& digest : revoked) {
+            onRevoked_(digest);
+        }
+    }
+    return true;
+}
+
+bool RevocationFilter::isFresh() const {
+    int64_t syncedAt = syncedAt_.load();
+    return syncedAt != 0 && Clock::now() - Clock::time_point(Clock::duration(syncedAt)) <= maxStaleness_;
+}
+
+bool RevocationFilter::isRevoked(const std::string& digest) {
+    ++checks_;
+
+    bool filtered = isFresh();
+    if (filtered && !std::atomic_load(&filter_)->mightContain(digest)) {
+        return false;
+    }
+
+    // A filter hit, or no filter to trust: ask Redis, and reject if it can't answer
+    ++confirmations_;
+    std::optional<bool> revoked = redis_->isTokenRevoked(toHex(digest));
+    if (!revoked || *revoked) {
+        ++rejected_;
+        return true;
+    }
+
+    if (filtered) {
+        ++falsePositives_;
+    }
+    return false;
+}
+
+json RevocationFilter::getStats() const {
+    auto filter = std::atomic_load(&filter_);
+
+    return json{
+        {"fresh", isFresh()},
+        {"revoked", revokedCount_.load()},
+        {"filter_bits", filter ? filter->bitCount() : 0},
+        {"filter_hashes", filter ? filter->hashCount() : 0},
+        {"syncs", syncs_.load()},
+        {"sync_failures", syncFailures_.load()},
+        {"checks", checks_.load()},
+        {"redis_confirmations", confirmations_.load()},
+        {"false_positives", falsePositives_.load()},
+        {"rejected", rejected_.load()}
+    };
+}
+
+std::string RevocationFilter::fromHex(const std::string& hex) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    std::string bytes;
+    if (hex.size() % 2 != 0) {
+        return bytes;
+    }
+
+    bytes.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = nibble(hex[i]);
+        int low = nibble(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return std::string();
+        }
+        bytes.push_back(static_cast<char>((high << 4) | low));
+    }
+    return bytes;
+}
+
+std::string RevocationFilter::toHex(const std::string& digest) {
+    static const char* digits = "0123456789abcdef";
+
+    std::string hex;
+    hex.reserve(digest.size() * 2);
+    for (unsigned char byte : digest) {
+        hex.push_back(digits[byte >> 4]);
+        hex.push_back(digits[byte & 0x0f]);
+    }
+    return hex;
+}
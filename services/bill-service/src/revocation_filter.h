@@ -0,0 +1,93 @@
+#ifndef REVOCATION_FILTER_H
+#define REVOCATION_FILTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "redis_client.h"
+
+using json = nlohmann::json;
+
+// Bloom filter over raw 32-byte SHA-256 digests. The digest is already
+// uniformly distributed, so its first two 64-bit words drive double hashing.
+class BloomFilter {
+public:
+    BloomFilter(size_t expectedItems, double falsePositiveRate);
+
+    void add(const std::string& digest);
+    bool mightContain(const std::string& digest) const;
+
+    size_t bitCount() const { return bitCount_; }
+    size_t hashCount() const { return hashCount_; }
+
+private:
+    std::vector<uint64_t> words_;
+    size_t bitCount_;
+    size_t hashCount_;
+
+    static void seeds(const std::string& digest, uint64_t& h1, uint64_t& h2);
+};
+
+// In-process copy of the revoked-token set for stateless JWT auth. A thread
+// rebuilds the filter from Redis every interval and swaps it in, so lookups
+// are lock-free and need no network unless the filter reports a possible
+// revocation; that is confirmed with Redis to rule out a false positive.
+// A filter older than maxStaleness is not trusted and every token is checked
+// against Redis, so a failing sync cannot stretch the revocation delay.
+class RevocationFilter {
+public:
+    RevocationFilter(std::shared_ptr<RedisClient> redis, std::chrono::milliseconds interval,
+                     double falsePositiveRate);
+    ~RevocationFilter();
+
+    // onRevoked receives the raw digest of every revoked token after each sync
+    void start(std::function<void(const std::string& digest)> onRevoked);
+    void stop();
+
+    // True if the token with this raw SHA-256 digest must be rejected
+    bool isRevoked(const std::string& digest);
+
+    json getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<RedisClient> redis_;
+    std::chrono::milliseconds interval_;
+    std::chrono::milliseconds maxStaleness_;
+    double falsePositiveRate_;
+
+    // Swapped with atomic_store; readers take a snapshot with atomic_load
+    std::shared_ptr<const BloomFilter> filter_;
+    std::atomic<int64_t> syncedAt_{0};  // Clock ticks of the last successful sync, 0 if none
+    std::atomic<size_t> revokedCount_{0};
+
+    std::function<void(const std::string&)> onRevoked_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = false;
+
+    std::atomic<uint64_t> syncs_{0};
+    std::atomic<uint64_t> syncFailures_{0};
+    std::atomic<uint64_t> checks_{0};
+    std::atomic<uint64_t> confirmations_{0};
+    std::atomic<uint64_t> falsePositives_{0};
+    std::atomic<uint64_t> rejected_{0};
+
+    bool sync();
+    void run();
+    bool isFresh() const;
+    static std::string fromHex(const std::string& hex);
+    static std::string toHex(const std::string& digest);
+};
+
+#endif
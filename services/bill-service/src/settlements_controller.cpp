@@ -1,20 +1,18 @@
 #include "settlements_controller.h"
 #include "split_calculator.h"
 #include "utils.h"
+#include "json_writer.h"
+#include "logger.h"
+#include <chrono>
 
-SettlementsController::SettlementsController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth)
-    : db_(db), auth_(auth) {}
+SettlementsController::SettlementsController(std::shared_ptr<Database> db, std::shared_ptr<RedisClient> redis,
+                                             std::shared_ptr<AsyncRedisClient> asyncRedis)
+    : db_(db), redis_(redis), asyncRedis_(asyncRedis),
+      cacheTtl_(std::stoi(getEnvVar("SETTLEMENTS_CACHE_TTL", "3600"))),
+      asyncRedisTimeout_(std::stol(getEnvVar("REDIS_ASYNC_TIMEOUT_MS", "1000"))) {}
 
-void SettlementsController::getEventSettlements(const httplib::Request& req, httplib::Response& res) {
+void SettlementsController::getEventSettlements(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         std::string eventId = req.matches[1];
         
         if (!isValidUUID(eventId)) {
@@ -24,72 +22,79 @@ void SettlementsController::getEventSettlements(const httplib::Request& req, htt
             return;
         }
 
-        if (!db_->eventExists(eventId)) {
+        // Access check and the ledger with its version share one round trip
+        auto data = db_->loadEventSettlements(eventId, context.userId);
+        const auto& access = data.access;
+        if (!access.exists) {
             json errorResponse = createErrorResponse("Event not found", 404);
             res.status = 404;
             res.set_content(errorResponse.dump(), "application/json");
             return;
         }
 
-        bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-        bool isParticipant = db_->isParticipant(eventId, authResult.userId);
-        
-        if (!isCreator && !isParticipant) {
+        if (!access.isCreator && !access.isParticipant) {
             json errorResponse = createErrorResponse("Access denied", 403);
             res.status = 403;
             res.set_content(errorResponse.dump(), "application/json");
             return;
         }
-
-        json expenses = db_->getExpensesByEvent(eventId);
-        json participants = db_->getParticipantsByEvent(eventId);
         
-        if (isCreator) {
-            // Get creator info
-            json creatorParticipant = {
-                {"user_id", authResult.userId},
-                {"status", "active"}
-            };
-            
-            // Add creator to participants array for calculation
-            if (participants.is_array()) {
-                participants.push_back(creatorParticipant);
-            } else {
-                participants = json::array({creatorParticipant});
-            }
-        }
+        LOG_DEBUG("Settlements for event " << eventId << ": user " << context.userId
+                  << " creator=" << access.isCreator << " participant=" << access.isParticipant);
         
-
-        // ADD DEBUG OUTPUT HERE
-        std::cout << "=== DEBUG: Participants JSON ===" << std::endl;
-        std::cout << participants.dump(2) << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Settlement> settlements;
+        std::string cacheKey;
+        bool hit = false;
+        bool useCache = redis_ && cacheTtl_ > 0;
+        if (useCache) {
+            // Same version, same balances: both came from one snapshot
+            cacheKey = "settlements:" + eventId + ":" + std::to_string(data.version);
+            auto cached = readCache(cacheKey);
+            hit = cached && fromCacheObject(*cached, settlements);
+        }
         
-        std::cout << "=== DEBUG: Expenses JSON ===" << std::endl;
-        std::cout << expenses.dump(2) << std::endl;
+        if (!hit) {
+            settlements = SplitCalculator::optimizeSettlements(data.balances);
+            if (useCache) {
+                writeCache(cacheKey, toCacheObject(settlements));
+            }
+        }
         
-        std::cout << "=== DEBUG: Auth User ID ===" << std::endl;
-        std::cout << "Current user: " << authResult.userId << std::endl;
-        std::cout << "Is creator: " << isCreator << std::endl;
-        std::cout << "Is participant: " << isParticipant << std::endl;
+        if (useCache) {
+            uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (hit) {
+                ++cacheHits_;
+                hitMicrosTotal_ += micros;
+            } else {
+                ++cacheMisses_;
+                missMicrosTotal_ += micros;
+            }
+        }
         
-        json balances = SplitCalculator::calculateUserBalances(eventId, expenses, participants);
-        auto settlements = SplitCalculator::calculateEventSettlements(expenses, participants);
+        JsonWriter out(64 * (data.balances.size() + settlements.size()) + 128);
+        out.beginObject();
+        out.key("balances").beginObject();
+        for (const auto& [userId, balanceCents] : data.balances) {
+            out.key(userId).amount(balanceCents);
+        }
+        out.endObject();
         
-        json settlementsJson = json::array();
+        out.key("settlements").beginArray();
         for (const auto& settlement : settlements) {
-            settlementsJson.push_back({
-                {"from_user_id", settlement.fromUserId},
-                {"to_user_id", settlement.toUserId},
-                {"amount", settlement.amount}
-            });
+            out.beginObject();
+            out.key("amount").amount(settlement.amountCents);
+            out.key("from_user_id").string(settlement.fromUserId);
+            out.key("to_user_id").string(settlement.toUserId);
+            out.endObject();
         }
-        
-        json response = createSuccessResponse();
-        response["balances"] = balances;
-        response["settlements"] = settlementsJson;
+        out.endArray();
+        writeSuccessFields(out);
+        out.endObject();
         
         res.status = 200;
-        res.set_content(response.dump(), "application/json");
+        res.set_content(out.release(), "application/json");
         
     } catch (const std::exception& e) {
         json errorResponse = createErrorResponse("Failed to calculate settlements: " + std::string(e.what()), 500);
@@ -98,16 +103,8 @@ void SettlementsController::getEventSettlements(const httplib::Request& req, htt
     }
 }
 
-void SettlementsController::recordPayment(const httplib::Request& req, httplib::Response& res) {
+void SettlementsController::recordPayment(const httplib::Request& req, httplib::Response& res, const RequestContext& context) {
     try {
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
         std::string eventId = req.matches[1];
         
         if (!isValidUUID(eventId)) {
@@ -149,7 +146,7 @@ void SettlementsController::recordPayment(const httplib::Request& req, httplib::
         json response = createSuccessResponse();
         response["message"] = "Payment recorded successfully";
         response["payment"] = {
-            {"from_user_id", authResult.userId},
+            {"from_user_id", context.userId},
             {"to_user_id", toUserId},
             {"amount", amount},
             {"event_id", eventId},
@@ -166,56 +163,22 @@ void SettlementsController::recordPayment(const httplib::Request& req, httplib::
     }
 }
 
-void SettlementsController::getUserBalance(const httplib::Request& req, httplib::Response& res) {
+void SettlementsController::getUserBalance(const httplib::Request&, httplib::Response& res, const RequestContext& context) {
     try {
-        auto authResult = auth_->authenticate(req);
-        if (!authResult.success) {
-            json errorResponse = auth_->createAuthErrorResponse(authResult.error);
-            res.status = 401;
-            res.set_content(errorResponse.dump(), "application/json");
-            return;
-        }
-
-        // Get all events user is involved in
-        json userEvents = db_->getEventsByUser(authResult.userId);
+        // Net position per event and in total, in one query over the ledger
+        auto summary = db_->getUserBalances(context.userId);
         
-        double totalBalance = 0.0;
         json eventBalances = json::array();
-        
-        for (const auto& event : userEvents) {
-            std::string eventId = event["id"];
-            
-            json expenses = db_->getExpensesByEvent(eventId);
-            json participants = db_->getParticipantsByEvent(eventId);
-            
-            // Add creator to participants for calculation
-            bool isCreator = db_->isEventCreator(eventId, authResult.userId);
-            if (isCreator) {
-                json creatorParticipant = {
-                    {"user_id", authResult.userId},
-                    {"status", "active"}
-                };
-                if (participants.is_array()) {
-                    participants.push_back(creatorParticipant);
-                }
-            }
-            
-            json balances = SplitCalculator::calculateUserBalances(eventId, expenses, participants);
-            
-            if (balances.contains(authResult.userId)) {
-                double eventBalance = balances[authResult.userId];
-                totalBalance += eventBalance;
-                
-                eventBalances.push_back({
-                    {"event_id", eventId},
-                    {"event_name", event["name"]},
-                    {"balance", eventBalance}
-                });
-            }
+        for (const auto& balance : summary.events) {
+            eventBalances.push_back({
+                {"event_id", balance.eventId},
+                {"event_name", balance.eventName},
+                {"balance", centsToAmount(balance.balanceCents)}
+            });
         }
         
         json response = createSuccessResponse();
-        response["total_balance"] = totalBalance;
+        response["total_balance"] = centsToAmount(summary.totalCents);
         response["event_balances"] = eventBalances;
         
         res.status = 200;
@@ -228,6 +191,87 @@ void SettlementsController::getUserBalance(const httplib::Request& req, httplib:
     }
 }
 
+bool SettlementsController::useAsyncRedis() const {
+    // A near-cache hit on the blocking client needs no round trip at all
+    return asyncRedis_ && asyncRedis_->isConnected() && !redis_->nearCacheEnabled();
+}
+
+std::optional<json> SettlementsController::readCache(const std::string& key) {
+    if (!useAsyncRedis()) {
+        return redis_->getCacheObject(key);
+    }
+    
+    auto pending = asyncRedis_->command({"GET", RedisClient::cacheKey(key)});
+    if (pending.wait_for(asyncRedisTimeout_) == std::future_status::ready) {
+        AsyncRedisClient::Reply reply = pending.get();
+        if (reply.type == REDIS_REPLY_STRING) {
+            return RedisClient::decodeCacheObject(reply.str);
+        }
+        if (!reply.isError()) {
+            return std::nullopt;
+        }
+    }
+    
+    // Transport error or timeout: retry on the blocking client
+    return redis_->getCacheObject(key);
+}
+
+void SettlementsController::writeCache(const std::string& key, const json& value) {
+    if (!useAsyncRedis()) {
+        redis_->setCacheObject(key, value, cacheTtl_);
+        return;
+    }
+    
+    // Fire and forget: a lost write is just a later miss
+    asyncRedis_->command({"SET", RedisClient::cacheKey(key), redis_->encodeCacheObject(value),
+                          "EX", std::to_string(cacheTtl_)});
+}
+
+json SettlementsController::getCacheStats() const {
+    uint64_t hits = cacheHits_.load();
+    uint64_t misses = cacheMisses_.load();
+    
+    return json{
+        {"enabled", redis_ && cacheTtl_ > 0},
+        {"ttl_seconds", cacheTtl_},
+        {"hits", hits},
+        {"misses", misses},
+        {"hit_ratio", hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0},
+        {"hit_us_avg", hits > 0 ? hitMicrosTotal_.load() / hits : 0},
+        {"miss_us_avg", misses > 0 ? missMicrosTotal_.load() / misses : 0}
+    };
+}
+
+// Cached as {"s": [[from, to, cents], ...]}: integer cents and positional
+// settlements keep the encoded entry small. The balances are not cached, the
+// version read brings them along.
+json SettlementsController::toCacheObject(const std::vector<Settlement>& settlements) {
+    json settlementsJson = json::array();
+    for (const auto& settlement : settlements) {
+        settlementsJson.push_back({settlement.fromUserId, settlement.toUserId, settlement.amountCents});
+    }
+    
+    return json{{"s", std::move(settlementsJson)}};
+}
+
+bool SettlementsController::fromCacheObject(const json& cached, std::vector<Settlement>& settlements) {
+    try {
+        settlements.clear();
+        for (const auto& entry : cached.at("s")) {
+            Settlement settlement;
+            settlement.fromUserId = entry.at(0).get<std::string>();
+            settlement.toUserId = entry.at(1).get<std::string>();
+            settlement.amountCents = entry.at(2).get<int64_t>();
+            settlements.push_back(std::move(settlement));
+        }
+        return true;
+        
+    } catch (const json::exception&) {
+        // Unexpected shape, e.g. from an older release: recompute
+        return false;
+    }
+}
+
 json SettlementsController::createErrorResponse(const std::string& message, int statusCode) {
     return json{
         {"error", message},
@@ -1,31 +1,62 @@
 #ifndef SETTLEMENTS_CONTROLLER_H
 #define SETTLEMENTS_CONTROLLER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 #include <httplib.h>
 #include <nlohmann/json.hpp>
+#include "async_redis_client.h"
 #include "database.h"
-#include "auth_middleware.h"
+#include "request_context.h"
+#include "redis_client.h"
+#include "split_calculator.h"
 
 using json = nlohmann::json;
 
 class SettlementsController {
 public:
-    SettlementsController(std::shared_ptr<Database> db, std::shared_ptr<AuthMiddleware> auth);
+    SettlementsController(std::shared_ptr<Database> db, std::shared_ptr<RedisClient> redis,
+                          std::shared_ptr<AsyncRedisClient> asyncRedis = nullptr);
     
     // Get settlement summary for an event
-    void getEventSettlements(const httplib::Request& req, httplib::Response& res);
+    void getEventSettlements(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
     
     // Record a payment between users
-    void recordPayment(const httplib::Request& req, httplib::Response& res);
+    void recordPayment(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
     
     // Get user's overall balance across all events
-    void getUserBalance(const httplib::Request& req, httplib::Response& res);
+    void getUserBalance(const httplib::Request& req, httplib::Response& res, const RequestContext& context);
+    
+    json getCacheStats() const;
 
 private:
     std::shared_ptr<Database> db_;
-    std::shared_ptr<AuthMiddleware> auth_;
     
+    // Settlements cached in Redis under settlements:{event}:{version}, the
+    // version read with the balances; a write bumps it, so entries never
+    // need invalidating.
+    // With asyncRedis_ connected, reads wait at most REDIS_ASYNC_TIMEOUT_MS
+    // and writes are not waited for at all.
+    std::shared_ptr<RedisClient> redis_;
+    std::shared_ptr<AsyncRedisClient> asyncRedis_;
+    int cacheTtl_;
+    std::chrono::milliseconds asyncRedisTimeout_;
+    std::atomic<uint64_t> cacheHits_{0};
+    std::atomic<uint64_t> cacheMisses_{0};
+    std::atomic<uint64_t> hitMicrosTotal_{0};
+    std::atomic<uint64_t> missMicrosTotal_{0};
+    
+    std::optional<json> readCache(const std::string& key);
+    void writeCache(const std::string& key, const json& value);
+    bool useAsyncRedis() const;
+    static json toCacheObject(const std::vector<Settlement>& settlements);
+    static bool fromCacheObject(const json& cached, std::vector<Settlement>& settlements);
     json createErrorResponse(const std::string& message, int statusCode = 400);
     json createSuccessResponse(const json& data = json::object());
 };
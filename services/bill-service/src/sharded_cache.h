@@ -0,0 +1,228 @@
+#ifndef SHARDED_CACHE_H
+#define SHARDED_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Bounded in-process LRU cache with per-entry expiry. Keys are spread over
+// independently locked shards so concurrent lookups rarely contend.
+template <typename Value>
+class ShardedCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ShardedCache(size_t capacity, size_t shardCount, std::chrono::milliseconds ttl)
+        : ttl_(ttl) {
+        shardCount = std::max<size_t>(shardCount, 1);
+        capacityPerShard_ = capacity / shardCount + (capacity % shardCount ? 1 : 0);
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    bool enabled() const {
+        return capacityPerShard_ > 0 && ttl_.count() > 0;
+    }
+
+    bool get(const std::string& key, Value& value) {
+        if (!enabled()) {
+            return false;
+        }
+
+        Shard& shard = shardFor(key);
+        auto now = Clock::now();
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            ++misses_;
+            return false;
+        }
+
+        if (it->second->expiresAt <= now) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            ++expirations_;
+            ++misses_;
+            return false;
+        }
+
+        // Move to the front of the LRU list
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        value = it->second->value;
+        ++hits_;
+        return true;
+    }
+
+    // Invalidation generation of the key's shard. Read it before loading a
+    // value from the source of truth and pass it to put(), so a load that
+    // raced with an invalidation is not cached.
+    uint64_t generation(const std::string& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.generation;
+    }
+
+    void put(const std::string& key, Value value) {
+        put(key, std::move(value), Clock::now() + ttl_);
+    }
+
+    void put(const std::string& key, Value value, Clock::time_point expiresAt) {
+        insert(key, std::move(value), expiresAt, nullptr);
+    }
+
+    void put(const std::string& key, Value value, uint64_t generation) {
+        insert(key, std::move(value), Clock::now() + ttl_, &generation);
+    }
+
+    void put(const std::string& key, Value value, Clock::time_point expiresAt, uint64_t generation) {
+        insert(key, std::move(value), expiresAt, &generation);
+    }
+
+    bool erase(const std::string& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++shard.generation;
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return false;
+        }
+
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        ++invalidations_;
+        return true;
+    }
+
+    // Drop every entry whose key matches; scans all shards
+    size_t eraseIf(const std::function<bool(const std::string&)>& predicate) {
+        size_t erased = 0;
+
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            ++shard->generation;
+
+            for (auto it = shard->lru.begin(); it != shard->lru.end();) {
+                if (predicate(it->key)) {
+                    shard->index.erase(it->key);
+                    it = shard->lru.erase(it);
+                    ++erased;
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        invalidations_ += erased;
+        return erased;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            ++shard->generation;
+            invalidations_ += shard->lru.size();
+            shard->index.clear();
+            shard->lru.clear();
+        }
+    }
+
+    json getStats() const {
+        size_t size = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            size += shard->lru.size();
+        }
+
+        uint64_t hits = hits_.load();
+        uint64_t lookups = hits + misses_.load();
+
+        return json{
+            {"enabled", enabled()},
+            {"size", size},
+            {"capacity", capacityPerShard_ * shards_.size()},
+            {"shards", shards_.size()},
+            {"ttl_ms", ttl_.count()},
+            {"hits", hits},
+            {"misses", misses_.load()},
+            {"hit_ratio", lookups > 0 ? static_cast<double>(hits) / lookups : 0.0},
+            {"evictions", evictions_.load()},
+            {"expirations", expirations_.load()},
+            {"invalidations", invalidations_.load()}
+        };
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        Value value;
+        Clock::time_point expiresAt;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // front = most recently used
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+        uint64_t generation = 0;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t capacityPerShard_;
+    std::chrono::milliseconds ttl_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expirations_{0};
+    std::atomic<uint64_t> invalidations_{0};
+
+    Shard& shardFor(const std::string& key) {
+        return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+    }
+
+    void insert(const std::string& key, Value value, Clock::time_point expiresAt,
+                const uint64_t* generation) {
+        if (!enabled()) {
+            return;
+        }
+
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (generation && *generation != shard.generation) {
+            return;
+        }
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->value = std::move(value);
+            it->second->expiresAt = expiresAt;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+
+        shard.lru.push_front(Entry{key, std::move(value), expiresAt});
+        shard.index[key] = shard.lru.begin();
+
+        while (shard.lru.size() > capacityPerShard_) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+            ++evictions_;
+        }
+    }
+};
+
+#endif
@@ -3,181 +3,126 @@
 #include <cmath>
 
 std::vector<ExpenseShare> SplitCalculator::calculateExpenseShares(
-    double totalAmount,
+    int64_t totalCents,
     const std::string& splitType,
     const std::vector<std::string>& participantIds,
-    const json& customShares) {
+    const std::map<std::string, double>& customShares) {
     
     std::vector<ExpenseShare> shares;
     
-    if (splitType == "equal") {
-        double shareAmount = totalAmount / participantIds.size();
-        for (const auto& userId : participantIds) {
-            shares.push_back({userId, shareAmount, 100.0 / participantIds.size()});
-        }
+    if (participantIds.empty()) {
+        return shares;
     }
-    else if (splitType == "percentage" && !customShares.empty()) {
+    
+    if (splitType == "percentage" && !customShares.empty()) {
         for (const auto& userId : participantIds) {
-            if (customShares.contains(userId)) {
-                double percentage = customShares[userId];
-                double amount = (totalAmount * percentage) / 100.0;
+            auto it = customShares.find(userId);
+            if (it != customShares.end()) {
+                double percentage = it->second;
+                int64_t amount = std::llround(totalCents * percentage / 100.0);
                 shares.push_back({userId, amount, percentage});
             }
         }
     }
     else if (splitType == "custom" && !customShares.empty()) {
         for (const auto& userId : participantIds) {
-            if (customShares.contains(userId)) {
-                double amount = customShares[userId];
-                double percentage = (amount / totalAmount) * 100.0;
+            auto it = customShares.find(userId);
+            if (it != customShares.end()) {
+                int64_t amount = amountToCents(it->second);
+                double percentage = totalCents > 0 ? (amount * 100.0) / totalCents : 0.0;
                 shares.push_back({userId, amount, percentage});
             }
         }
     }
+    else {
+        // Equal split, also used when no per-user shares were supplied
+        shares = splitEqually(totalCents, participantIds);
+    }
     
     return shares;
 }
 
-std::vector<Settlement> SplitCalculator::calculateEventSettlements(
-    const json& expenses,
-    const json& participants) {
+std::vector<ExpenseShare> SplitCalculator::splitEqually(int64_t totalCents,
+                                                        std::vector<std::string> participantIds) {
+    std::vector<ExpenseShare> shares;
     
-    std::map<std::string, double> balances;
+    // Sorted so the leftover cents always land on the same users
+    std::sort(participantIds.begin(), participantIds.end());
     
-    // Initialize balances - check if participants is array
-    if (participants.is_array()) {
-        for (const auto& participant : participants) {
-            if (participant.contains("user_id")) {
-                balances[participant["user_id"]] = 0.0;
-            }
-        }
-    }
+    int64_t count = static_cast<int64_t>(participantIds.size());
+    int64_t base = totalCents / count;
+    int64_t remainder = totalCents % count;
+    double percentage = 100.0 / count;
     
-    // Calculate balances from expenses - check if expenses is array
-    if (expenses.is_array()) {
-        for (const auto& expense : expenses) {
-            if (!expense.contains("payer_id") || !expense.contains("amount")) {
-                continue; // Skip invalid expenses
-            }
-            
-            std::string payerId = expense["payer_id"];
-            double amount = expense["amount"];
-            std::string splitType = expense.contains("split_type") ? expense["split_type"] : "equal";
-            
-            // Get participant IDs
-            std::vector<std::string> participantIds;
-            if (participants.is_array()) {
-                for (const auto& participant : participants) {
-                    if (participant.contains("user_id")) {
-                        participantIds.push_back(participant["user_id"]);
-                    }
-                }
-            }
-            
-            if (participantIds.empty()) {
-                continue; // Skip if no participants
-            }
-            
-            // Calculate shares
-            auto shares = calculateExpenseShares(amount, splitType, participantIds);
-            
-            // Payer gets credit for paying
-            if (balances.find(payerId) != balances.end()) {
-                balances[payerId] += amount;
-            }
-            
-            // Everyone owes their share
-            for (const auto& share : shares) {
-                if (balances.find(share.userId) != balances.end()) {
-                    balances[share.userId] -= share.amount;
-                }
-            }
-        }
+    shares.reserve(participantIds.size());
+    for (int64_t i = 0; i < count; ++i) {
+        shares.push_back({participantIds[i], base + (i < remainder ? 1 : 0), percentage});
     }
     
-    return optimizeSettlements(balances);
+    return shares;
 }
 
-json SplitCalculator::calculateUserBalances(
-    const std::string& eventId,
-    const json& expenses,
-    const json& participants) {
+std::vector<Settlement> SplitCalculator::calculateEventSettlements(
+    const std::vector<Expense>& expenses,
+    const std::vector<Participant>& participants) {
     
-    json result = json::object();
-    std::map<std::string, double> balances;
+    return optimizeSettlements(calculateUserBalances(expenses, participants));
+}
+
+std::map<std::string, int64_t> SplitCalculator::calculateUserBalances(
+    const std::vector<Expense>& expenses,
+    const std::vector<Participant>& participants) {
+    
+    std::map<std::string, int64_t> balances;
+    std::vector<std::string> participantIds;
+    participantIds.reserve(participants.size());
     
     // Initialize balances
-    if (participants.is_array()) {
-        for (const auto& participant : participants) {
-            if (participant.contains("user_id")) {
-                std::string userId = participant["user_id"];
-                balances[userId] = 0.0;
-            }
+    for (const auto& participant : participants) {
+        if (balances.emplace(participant.userId, 0).second) {
+            participantIds.push_back(participant.userId);
         }
     }
     
-    // Calculate from expenses  
-    if (expenses.is_array()) {
-        for (const auto& expense : expenses) {
-            if (!expense.contains("payer_id") || !expense.contains("amount")) {
-                continue;
-            }
-            
-            std::string payerId = expense["payer_id"];
-            double amount = expense["amount"];
-            std::string splitType = expense.contains("split_type") ? expense["split_type"] : "equal";
-            
-            std::vector<std::string> participantIds;
-            if (participants.is_array()) {
-                for (const auto& participant : participants) {
-                    if (participant.contains("user_id")) {
-                        participantIds.push_back(participant["user_id"]);
-                    }
-                }
-            }
-            
-            if (participantIds.empty()) {
-                continue;
-            }
-            
-            auto shares = calculateExpenseShares(amount, splitType, participantIds);
-            
-            if (balances.find(payerId) != balances.end()) {
-                balances[payerId] += amount;
-            }
-            
-            for (const auto& share : shares) {
-                if (balances.find(share.userId) != balances.end()) {
-                    balances[share.userId] -= share.amount;
-                }
-            }
-        }
+    if (participantIds.empty()) {
+        return balances;
     }
     
-    // Convert to JSON
-    for (const auto& [userId, balance] : balances) {
-        result[userId] = balance;
+    // Calculate from expenses
+    for (const auto& expense : expenses) {
+        auto shares = calculateExpenseShares(expense.amountCents, expense.splitType, participantIds);
+        
+        // Payer gets credit for paying
+        auto payer = balances.find(expense.payerId);
+        if (payer != balances.end()) {
+            payer->second += expense.amountCents;
+        }
+        
+        // Everyone owes their share
+        for (const auto& share : shares) {
+            balances[share.userId] -= share.amountCents;
+        }
     }
     
-    return result;
+    return balances;
 }
 
-std::vector<Settlement> SplitCalculator::optimizeSettlements(const std::map<std::string, double>& balances) {
+std::vector<Settlement> SplitCalculator::optimizeSettlements(const std::map<std::string, int64_t>& balances) {
     std::vector<Settlement> settlements;
-    std::vector<std::pair<std::string, double>> debtors;
-    std::vector<std::pair<std::string, double>> creditors;
+    std::vector<std::pair<std::string, int64_t>> debtors;
+    std::vector<std::pair<std::string, int64_t>> creditors;
     
     // Separate debtors and creditors
     for (const auto& [userId, balance] : balances) {
-        if (balance < -0.01) {  // Owes money
+        if (balance < 0) {  // Owes money
             debtors.push_back({userId, -balance});
-        } else if (balance > 0.01) {  // Is owed money
+        } else if (balance > 0) {  // Is owed money
             creditors.push_back({userId, balance});
         }
     }
     
     // Sort by amount
-    std::sort(debtors.begin(), debtors.end(), 
+    std::sort(debtors.begin(), debtors.end(),
               [](const auto& a, const auto& b) { return a.second > b.second; });
     std::sort(creditors.begin(), creditors.end(),
               [](const auto& a, const auto& b) { return a.second > b.second; });
@@ -185,20 +130,20 @@ std::vector<Settlement> SplitCalculator::optimizeSettlements(const std::map<std:
     // Match debtors with creditors
     size_t i = 0, j = 0;
     while (i < debtors.size() && j < creditors.size()) {
-        double amount = std::min(debtors[i].second, creditors[j].second);
+        int64_t amount = std::min(debtors[i].second, creditors[j].second);
         
         settlements.push_back({
             debtors[i].first,   // from
-            creditors[j].first, // to  
+            creditors[j].first, // to
             amount
         });
         
         debtors[i].second -= amount;
         creditors[j].second -= amount;
         
-        if (debtors[i].second < 0.01) i++;
-        if (creditors[j].second < 0.01) j++;
+        if (debtors[i].second == 0) i++;
+        if (creditors[j].second == 0) j++;
     }
     
     return settlements;
-}
\ No newline at end of file
+}
@@ -1,50 +1,52 @@
 #ifndef SPLIT_CALCULATOR_H
 #define SPLIT_CALCULATOR_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <map>
-#include <nlohmann/json.hpp>
-
-using json = nlohmann::json;
+#include "models.h"
 
 struct ExpenseShare {
     std::string userId;
-    double amount;
+    int64_t amountCents;
     double percentage;
 };
 
 struct Settlement {
     std::string fromUserId;
     std::string toUserId;
-    double amount;
+    int64_t amountCents;
 };
 
 class SplitCalculator {
 public:
-    // Calculate individual shares for an expense
+    // Calculate individual shares for an expense. Shares always add up to
+    // the total; leftover cents go to the first participants by user id.
     static std::vector<ExpenseShare> calculateExpenseShares(
-        double totalAmount,
+        int64_t totalCents,
         const std::string& splitType,
         const std::vector<std::string>& participantIds,
-        const json& customShares = json::object()
+        const std::map<std::string, double>& customShares = {}
     );
     
     // Calculate who owes whom for an entire event
     static std::vector<Settlement> calculateEventSettlements(
-        const json& expenses,
-        const json& participants
+        const std::vector<Expense>& expenses,
+        const std::vector<Participant>& participants
     );
     
-    // Get balance summary for each user
-    static json calculateUserBalances(
-        const std::string& eventId,
-        const json& expenses,
-        const json& participants
+    // Get balance summary for each user, in cents
+    static std::map<std::string, int64_t> calculateUserBalances(
+        const std::vector<Expense>& expenses,
+        const std::vector<Participant>& participants
     );
-
+    
+    // Minimal list of transfers that settles a set of balances
+    static std::vector<Settlement> optimizeSettlements(const std::map<std::string, int64_t>& balances);
+    
 private:
-    static std::vector<Settlement> optimizeSettlements(const std::map<std::string, double>& balances);
+    static std::vector<ExpenseShare> splitEqually(int64_t totalCents, std::vector<std::string> participantIds);
 };
 
-#endif
\ No newline at end of file
+#endif
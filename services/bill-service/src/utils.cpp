@@ -1,16 +1,28 @@
 #include "utils.h"
 #include <cstdlib>
+#include <ctime>
 #include <regex>
 
 std::string getCurrentTimestamp() {
     auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+    return formatTimestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count());
+}
+
+std::string formatTimestamp(int64_t epochMillis) {
+    std::time_t seconds = static_cast<std::time_t>(epochMillis / 1000);
+    int64_t ms = epochMillis % 1000;
+    if (ms < 0) {
+        ms += 1000;
+        --seconds;
+    }
+    
+    std::tm tm{};
+    gmtime_r(&seconds, &tm);
     
     std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count() << 'Z';
+    ss << std::put_time(&tm, "%Y-%m-%dT%H:%M:%S");
+    ss << '.' << std::setfill('0') << std::setw(3) << ms << 'Z';
     return ss.str();
 }
 
@@ -47,6 +59,11 @@ json createSuccessResponse(const json& data) {
     return response;
 }
 
+void writeSuccessFields(JsonWriter& out) {
+    out.key("success").boolean(true);
+    out.key("timestamp").string(getCurrentTimestamp());
+}
+
 std::string trim(const std::string& str) {
     size_t start = str.find_first_not_of(" \t\n\r\f\v");
     if (start == std::string::npos) return "";
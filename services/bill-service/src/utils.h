@@ -1,19 +1,25 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstdint>
 #include <string>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 #include <nlohmann/json.hpp>
+#include "json_writer.h"
 
 using json = nlohmann::json;
 
 std::string getCurrentTimestamp();
+std::string formatTimestamp(int64_t epochMillis);  // ISO 8601, UTC
 std::string getEnvVar(const std::string& key, const std::string& defaultValue = "");
 bool isValidUUID(const std::string& uuid);
 json createErrorResponse(const std::string& message, int statusCode = 400);
 json createSuccessResponse(const json& data = json::object());
+// Appends "success":true,"timestamp":... to an open object. Written after the
+// payload so keys come out sorted, as createSuccessResponse().dump() has them
+void writeSuccessFields(JsonWriter& out);
 std::string trim(const std::string& str);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "worker_pool.h"
+#include "utils.h"
+#include "logger.h"
+#include <algorithm>
+
+// WorkerPoolServer::process_and_close_socket copies httplib's own body and
+// reaches into its protected members and detail:: helpers, so it is only
+// correct for the release pinned in CMakeLists.txt
+static constexpr bool sameVersion(const char* a, const char* b) {
+    return *a == *b && (*a == '\0' || sameVersion(a + 1, b + 1));
+}
+static_assert(sameVersion(CPPHTTPLIB_VERSION, "0.14.1"),
+              "WorkerPoolServer mirrors cpp-httplib 0.14.1; re-check process_and_close_socket before bumping");
+
+static thread_local bool sheddingConnection = false;
+static thread_local bool droppingConnection = false;
+static thread_local std::chrono::microseconds connectionQueueTime{0};
+
+namespace {
+
+class WorkerPoolTaskQueue : public httplib::TaskQueue {
+public:
+    explicit WorkerPoolTaskQueue(std::shared_ptr<WorkerPool> pool) : pool_(std::move(pool)) {}
+
+    void enqueue(std::function<void()> fn) override { pool_->enqueue(std::move(fn)); }
+    void shutdown() override { pool_->shutdown(); }
+
+private:
+    std::shared_ptr<WorkerPool> pool_;
+};
+
+}
+
+WorkerPool::WorkerPool() {
+    // Same default as httplib's own pool
+    size_t defaultThreads = std::max(8u, std::thread::hardware_concurrency() > 0
+        ? std::thread::hardware_concurrency() - 1 : 0u);
+    threadCount_ = std::max<size_t>(1, std::stoul(getEnvVar("HTTP_WORKER_THREADS", std::to_string(defaultThreads))));
+    maxQueue_ = std::max<size_t>(1, std::stoul(getEnvVar("HTTP_QUEUE_MAX", "256")));
+    deadline_ = std::chrono::milliseconds(std::stoi(getEnvVar("HTTP_QUEUE_DEADLINE_MS", "2000")));
+    retryAfterSeconds_ = std::max(1, std::stoi(getEnvVar("HTTP_RETRY_AFTER", "1")));
+    size_t shedThreads = std::max<size_t>(1, std::stoul(getEnvVar("HTTP_SHED_THREADS", "2")));
+    maxShedQueue_ = std::stoul(getEnvVar("HTTP_SHED_QUEUE_MAX", "64"));
+    shedTimeout_ = std::chrono::milliseconds(std::max(1, std::stoi(getEnvVar("HTTP_SHED_TIMEOUT_MS", "1000"))));
+
+    threads_.reserve(threadCount_ + shedThreads);
+    for (size_t i = 0; i < threadCount_; ++i) {
+        threads_.emplace_back(&WorkerPool::runWorker, this);
+    }
+    for (size_t i = 0; i < shedThreads; ++i) {
+        threads_.emplace_back(&WorkerPool::runShedder, this);
+    }
+
+    LOG_INFO("HTTP worker pool: " << threadCount_ << " threads, queue limit " << maxQueue_
+             << ", deadline " << deadline_.count() << "ms, shed limit " << maxShedQueue_);
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+httplib::TaskQueue* WorkerPool::makeTaskQueue(std::shared_ptr<WorkerPool> pool) {
+    return new WorkerPoolTaskQueue(std::move(pool));
+}
+
+void WorkerPool::enqueue(std::function<void()> task) {
+    Task entry{std::move(task), Clock::now()};
+    bool shed = false;
+    bool dropped = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= maxQueue_) {
+            ++shedFull_;
+            shed = true;
+        } else if (!queue_.empty() && entry.enqueuedAt - queue_.front().enqueuedAt > deadline_) {
+            // Workers are not keeping up; anything queued now would wait longer still
+            ++shedStale_;
+            shed = true;
+        }
+
+        if (shed && shedQueue_.size() >= maxShedQueue_) {
+            // The shedders are held up as well; a 503 would only come late
+            ++shedDropped_;
+            dropped = true;
+        } else if (shed) {
+            shedQueue_.push_back(std::move(entry));
+        } else {
+            queue_.push_back(std::move(entry));
+            ++accepted_;
+            peakDepth_ = std::max(peakDepth_, queue_.size());
+        }
+    }
+
+    if (dropped) {
+        // Runs on the accept thread; WorkerPoolServer closes the socket unread
+        droppingConnection = true;
+        entry.run();
+        droppingConnection = false;
+    } else if (shed) {
+        shedAvailable_.notify_one();
+    } else {
+        available_.notify_one();
+    }
+}
+
+void WorkerPool::runWorker() {
+    while (true) {
+        Task task;
+        Clock::duration waited;
+        bool expired;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [this] { return shutdown_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+
+            task = std::move(queue_.front());
+            queue_.pop_front();
+
+            waited = Clock::now() - task.enqueuedAt;
+            expired = waited > deadline_;
+            uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+            queueMicrosTotal_ += micros;
+            queueMicrosMax_ = std::max(queueMicrosMax_, micros);
+            if (expired) {
+                ++shedExpired_;
+            }
+            ++busy_;
+        }
+
+        execute(task, waited, expired);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --busy_;
+    }
+}
+
+void WorkerPool::runShedder() {
+    while (true) {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            shedAvailable_.wait(lock, [this] { return shutdown_ || !shedQueue_.empty(); });
+            if (shedQueue_.empty()) {
+                return;
+            }
+
+            task = std::move(shedQueue_.front());
+            shedQueue_.pop_front();
+        }
+
+        execute(task, Clock::now() - task.enqueuedAt, true);
+    }
+}
+
+void WorkerPool::execute(Task& task, Clock::duration waited, bool shed) {
+    sheddingConnection = shed;
+    connectionQueueTime = std::chrono::duration_cast<std::chrono::microseconds>(waited);
+    task.run();
+    sheddingConnection = false;
+    connectionQueueTime = std::chrono::microseconds(0);
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    available_.notify_all();
+    shedAvailable_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool WorkerPool::isShedding() {
+    return sheddingConnection;
+}
+
+bool WorkerPool::isDropping() {
+    return droppingConnection;
+}
+
+std::chrono::microseconds WorkerPool::takeQueueTime() {
+    auto queueTime = connectionQueueTime;
+    connectionQueueTime = std::chrono::microseconds(0);
+    return queueTime;
+}
+
+void WorkerPool::writeOverloadResponse(httplib::Response& res) const {
+    json error = {
+        {"error", "Service overloaded, retry later"},
+        {"status", 503},
+        {"timestamp", getCurrentTimestamp()}
+    };
+    res.status = 503;
+    res.set_header("Retry-After", std::to_string(retryAfterSeconds_));
+    // Frees the shed thread as soon as the client has the response
+    res.set_header("Connection", "close");
+    res.set_content(error.dump(), "application/json");
+}
+
+json WorkerPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t dequeued = accepted_ - queue_.size();
+
+    return json{
+        {"threads", threadCount_},
+        {"busy", busy_},
+        {"queue_depth", queue_.size()},
+        {"queue_peak", peakDepth_},
+        {"queue_limit", maxQueue_},
+        {"queue_deadline_ms", deadline_.count()},
+        {"accepted", accepted_},
+        {"shed_backlog", shedQueue_.size()},
+        {"shed_limit", maxShedQueue_},
+        {"shed_full", shedFull_},
+        {"shed_stale", shedStale_},
+        {"shed_expired", shedExpired_},
+        {"shed_dropped", shedDropped_},
+        {"avg_queue_us", dequeued > 0 ? queueMicrosTotal_ / dequeued : 0},
+        {"max_queue_us", queueMicrosMax_}
+    };
+}
+
+WorkerPoolServer::WorkerPoolServer(std::shared_ptr<WorkerPool> pool) : pool_(std::move(pool)) {
+    new_task_queue = [pool = pool_] { return WorkerPool::makeTaskQueue(pool); };
+}
+
+bool WorkerPoolServer::process_and_close_socket(httplib::socket_t sock) {
+    auto processRequest = [this](httplib::Stream& strm, bool closeConnection, bool& connectionClosed) {
+        return process_request(strm, closeConnection, connectionClosed, nullptr);
+    };
+    bool ret = false;
+
+    if (WorkerPool::isDropping()) {
+        // Closed before anything is read
+    } else if (WorkerPool::isShedding()) {
+        // One request, and a slow client gives up the shed thread quickly.
+        // httplib waits for the first byte in whole seconds.
+        auto timeout = pool_->shedTimeout().count();
+        time_t sec = timeout / 1000;
+        time_t usec = (timeout % 1000) * 1000;
+        time_t firstByteSec = (timeout + 999) / 1000;
+        ret = httplib::detail::process_server_socket(
+            svr_sock_, sock, 1, firstByteSec, sec, usec, sec, usec, processRequest);
+    } else {
+        ret = httplib::detail::process_server_socket(
+            svr_sock_, sock, keep_alive_max_count_, keep_alive_timeout_sec_,
+            read_timeout_sec_, read_timeout_usec_, write_timeout_sec_, write_timeout_usec_,
+            processRequest);
+    }
+
+    httplib::detail::shutdown_socket(sock);
+    httplib::detail::close_socket(sock);
+    return ret;
+}
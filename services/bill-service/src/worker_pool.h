@@ -0,0 +1,109 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// HTTP worker threads with a bounded backlog, replacing httplib's default
+// pool whose queue grows without limit. A new connection is shed when the
+// backlog is full or its oldest entry has already waited past the deadline;
+// a connection that only reaches a worker after the deadline is shed too.
+//
+// httplib's TaskQueue cannot refuse a connection, so shed connections are
+// still read: they run on a separate shed thread (or, when expired, on the
+// worker that dequeued them) with isShedding() set, and the pre-routing
+// handler answers 503 before any routing, auth or database work.
+// WorkerPoolServer reads them with a short timeout. The shed backlog is
+// bounded as well; past it the connection is closed unread on the accept
+// thread.
+class WorkerPool {
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    void enqueue(std::function<void()> task);
+    // Runs what is already queued, then joins the threads
+    void shutdown();
+
+    // All three refer to the connection the calling thread is serving
+    static bool isShedding();
+    static bool isDropping();
+    // Reported once per connection; later keep-alive requests read zero
+    static std::chrono::microseconds takeQueueTime();
+
+    // Read, write and keep-alive timeout for shed connections
+    std::chrono::milliseconds shedTimeout() const { return shedTimeout_; }
+
+    void writeOverloadResponse(httplib::Response& res) const;
+    json getStats() const;
+
+    // httplib deletes the queue it is given when the server stops, so it
+    // gets an adapter and the pool stays alive for /metrics
+    static httplib::TaskQueue* makeTaskQueue(std::shared_ptr<WorkerPool> pool);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task {
+        std::function<void()> run;
+        Clock::time_point enqueuedAt;
+    };
+
+    size_t threadCount_;
+    size_t maxQueue_;
+    std::chrono::milliseconds deadline_;
+    int retryAfterSeconds_;
+    size_t maxShedQueue_;
+    std::chrono::milliseconds shedTimeout_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable shedAvailable_;
+    std::deque<Task> queue_;
+    std::deque<Task> shedQueue_;
+    std::vector<std::thread> threads_;
+    bool shutdown_ = false;
+
+    // Guarded by mutex_
+    size_t busy_ = 0;
+    size_t peakDepth_ = 0;
+    uint64_t accepted_ = 0;
+    uint64_t shedFull_ = 0;
+    uint64_t shedStale_ = 0;
+    uint64_t shedExpired_ = 0;
+    uint64_t shedDropped_ = 0;
+    uint64_t queueMicrosTotal_ = 0;
+    uint64_t queueMicrosMax_ = 0;
+
+    void runWorker();
+    void runShedder();
+    static void execute(Task& task, Clock::duration waited, bool shed);
+};
+
+// An httplib::Server fed by a WorkerPool. Connections are served as by
+// httplib, except that shed ones get the pool's short timeouts and a single
+// request, and dropped ones are closed without being read.
+class WorkerPoolServer : public httplib::Server {
+public:
+    explicit WorkerPoolServer(std::shared_ptr<WorkerPool> pool);
+
+private:
+    std::shared_ptr<WorkerPool> pool_;
+
+    // Mirrors httplib::Server::process_and_close_socket (v0.14.1), which the
+    // accept loop runs through the task queue for every connection
+    bool process_and_close_socket(httplib::socket_t sock) override;
+};
+
+#endif
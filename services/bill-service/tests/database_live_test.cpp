@@ -0,0 +1,220 @@
+// Database against a real PostgreSQL with the schema in database/scripts,
+// reached through the DB_* settings the service uses. The listings written
+// straight from result rows (writeEventsByUser, writeExpensesByEvent,
+// writeParticipantsByEvent) match json::dump() of the decoded structs byte
+// for byte, on one page and walked page by page through the cursor. The
+// event_balances ledger, kept by SQL as expenses and members change, matches
+// SplitCalculator::calculateUserBalances over the same rows, and so does the
+// versioned read behind the settlements cache, as
+// split_calculator_test pins it down. Seeds its own users and deletes them
+// again on exit. Exits with 77, which CTest
+// reports as skipped, when no PostgreSQL answers.
+//
+//   docker compose up -d postgres
+//   DB_HOST=localhost DB_PASSWORD=... ctest --test-dir build -R database-live --output-on-failure
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+#include "database.h"
+#include "json_writer.h"
+#include "models.h"
+#include "pagination.h"
+#include "split_calculator.h"
+#include "test_support.h"
+#include "utils.h"
+
+static std::string connectionString() {
+    return "host=" + getEnvVar("DB_HOST", "postgres") +
+           " port=" + getEnvVar("DB_PORT", "5432") +
+           " dbname=" + getEnvVar("DB_NAME", "bill_splitter_db") +
+           " user=" + getEnvVar("DB_USER", "billsplitter_user") +
+           " password=" + getEnvVar("DB_PASSWORD", "");
+}
+
+static std::string insertUser(pqxx::connection& conn, const std::string& email,
+                              const std::string& name, const std::string& familyName) {
+    pqxx::work txn(conn);
+    pqxx::result user = txn.exec_params(
+        "INSERT INTO users (name, family_name, email, password_hash) VALUES ($1, $2, $3, 'x') RETURNING id",
+        name, familyName, email);
+    txn.commit();
+    return user[0][0].c_str();
+}
+
+using WritePage = std::function<std::optional<PageCursor>(const PageRequest&, JsonWriter&)>;
+
+// The whole listing in one page, and page by page, against the dump of the
+// structs the same rows decode to
+static void expectListing(const WritePage& writePage, const json& expected) {
+    CHECK(expected.size() >= 3);
+
+    JsonWriter all;
+    CHECK(!writePage(PageRequest{expected.size() + 1, std::nullopt}, all));
+    CHECK(all.str() == expected.dump());
+
+    PageRequest page{2, std::nullopt};
+    size_t seen = 0;
+    for (;;) {
+        JsonWriter out;
+        auto next = writePage(page, out);
+        json rows = json::parse(out.str());
+        CHECK(rows.size() <= page.limit);
+        for (const auto& row : rows) {
+            CHECK(seen < expected.size());
+            CHECK(row.dump() == expected[seen].dump());
+            ++seen;
+        }
+        if (!next) {
+            break;
+        }
+        CHECK(rows.size() == page.limit);
+        page.after = *next;
+    }
+    CHECK(seen == expected.size());
+}
+
+static void testListings(Database& db, pqxx::connection& conn, const std::string& tag) {
+    std::string creator = insertUser(conn, tag + "-0@example.com", "Alex", "Rossi");
+    std::string guest = insertUser(conn, tag + "-1@example.com", "Sam \"Quotes\"", "O'Neil\\Back");
+    std::string friendId = insertUser(conn, tag + "-2@example.com", "Zoë", "Ünal");
+
+    Event trip = db.createEvent(creator, "Trip \"north\"", "line one\nline two\ttab", "travel",
+                                "2024-07-01T00:00:00Z", "2024-07-08T12:30:00.250Z");
+    db.createEvent(creator, "Dinner", "", "restaurant");
+    db.createEvent(creator, "Flat", "rent & bills", "shared_house");
+    db.createEvent(guest, "Guest's own", "not listed for the creator", "other");
+
+    db.addParticipant(trip.id, guest);
+    db.addParticipant(trip.id, friendId, 33.33, 1005);
+    db.createExpense(trip.id, creator, 12345, "Hotel \\ room");
+    db.createExpense(trip.id, guest, 5, "Gum");
+    db.createExpense(trip.id, friendId, 1200, "Caffè\x01");
+
+    expectListing([&](const PageRequest& page, JsonWriter& out) {
+        return db.writeEventsByUser(creator, page, out);
+    }, toJson(db.getEventsByUser(creator)));
+
+    expectListing([&](const PageRequest& page, JsonWriter& out) {
+        return db.writeExpensesByEvent(trip.id, page, out);
+    }, toJson(db.getExpensesByEvent(trip.id)));
+
+    // The creator is not a participant row, so add one more to page through
+    std::string extra = insertUser(conn, tag + "-3@example.com", "Extra", "Member");
+    db.addParticipant(trip.id, extra);
+    expectListing([&](const PageRequest& page, JsonWriter& out) {
+        return db.writeParticipantsByEvent(trip.id, page, out);
+    }, toJson(db.getParticipantsByEvent(trip.id)));
+}
+
+// What the handler computed before the ledger: the creator plus the active
+// participants, split in C++
+static std::map<std::string, int64_t> expectedBalances(Database& db, const Event& event) {
+    auto participants = db.getParticipantsByEvent(event.id);
+    Participant creator;
+    creator.userId = event.creatorId;
+    creator.status = "active";
+    participants.push_back(creator);
+    return SplitCalculator::calculateUserBalances(db.getExpensesByEvent(event.id), participants);
+}
+
+// The incrementally maintained ledger, and the ledger rebuilt from scratch;
+// the settlements handler's read sees the same rows at a version that only
+// moves when they may have changed
+static void expectLedger(Database& db, const Event& event, int64_t& version) {
+    auto expected = expectedBalances(db, event);
+    CHECK(db.getEventBalances(event.id) == expected);
+    db.rebuildEventBalances(event.id);
+    CHECK(db.getEventBalances(event.id) == expected);
+
+    auto data = db.loadEventSettlements(event.id, event.creatorId);
+    CHECK(data.access.exists && data.access.isCreator);
+    CHECK(data.balances == expected);
+    CHECK(data.version >= version);
+    version = data.version;
+}
+
+static void testLedger(Database& db, pqxx::connection& conn, const std::string& tag) {
+    std::string creator = insertUser(conn, tag + "-ledger-0@example.com", "Alex", "Rossi");
+    std::string first = insertUser(conn, tag + "-ledger-1@example.com", "Sam", "Neri");
+    std::string second = insertUser(conn, tag + "-ledger-2@example.com", "Kim", "Bianchi");
+    std::string outsider = insertUser(conn, tag + "-ledger-3@example.com", "Lee", "Verdi");
+
+    Event event = db.createEvent(creator, "Ledger", "", "other");
+    db.addParticipant(event.id, first);
+    db.addParticipant(event.id, second);
+    int64_t version = 0;
+    expectLedger(db, event, version);
+
+    // Leftover cents: 100 and 2 do not divide by three members
+    db.createExpense(event.id, creator, 100, "Leftover");
+    db.createExpense(event.id, second, 2, "Two cents");
+    db.createExpense(event.id, first, 1001, "Uneven");
+    expectLedger(db, event, version);
+    auto balances = db.getEventBalances(event.id);
+    CHECK(balances.size() == 3);
+    int64_t total = 0;
+    for (const auto& [userId, cents] : balances) {
+        total += cents;
+    }
+    CHECK(total == 0);
+
+    // A payer who is not a member is not credited; the members still owe
+    Expense foreign = db.createExpense(event.id, outsider, 1000, "Paid by an outsider");
+    expectLedger(db, event, version);
+    CHECK(db.getEventBalances(event.id).count(outsider) == 0);
+    int64_t before = version;
+    db.createExpense(event.id, first, 10, "Bumps the version");
+    expectLedger(db, event, version);
+    CHECK(version > before);
+
+    // The creator with a participant row of their own is one member, not two
+    db.addParticipant(event.id, creator);
+    expectLedger(db, event, version);
+    CHECK(db.getEventBalances(event.id).size() == 3);
+
+    // Undoing an expense and changing the members keep the two in step
+    CHECK(db.deleteExpense(foreign.id));
+    expectLedger(db, event, version);
+    CHECK(db.removeParticipant(event.id, second));
+    expectLedger(db, event, version);
+    CHECK(db.getEventBalances(event.id).count(second) == 0);
+}
+
+int main() {
+    Database db;
+    if (!db.connect()) {
+        std::printf("database_live_test: skipped, no PostgreSQL reachable\n");
+        return kSkipped;
+    }
+    pqxx::connection conn(connectionString());
+
+    std::string tag = "database-live-" + std::to_string(
+        std::chrono::system_clock::now().time_since_epoch().count());
+
+    // Checks exit the process, so clean up from atexit rather than at the end
+    static std::string cleanupTag = tag;
+    std::atexit([] {
+        try {
+            pqxx::connection cleanup(connectionString());
+            pqxx::work txn(cleanup);
+            // Events, participants, expenses and ledger rows cascade from the users
+            txn.exec_params("DELETE FROM users WHERE email LIKE $1", cleanupTag + "-%");
+            txn.commit();
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "database_live_test: cleanup failed: %s\n", e.what());
+        }
+    });
+
+    testListings(db, conn, tag);
+    testLedger(db, conn, tag);
+
+    db.disconnect();
+    std::printf("database_live_test: all checks passed\n");
+    return 0;
+}
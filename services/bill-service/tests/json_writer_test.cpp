@@ -0,0 +1,218 @@
+// JsonWriter's escaping and number formatting, and writeJson() for events,
+// expenses and participants, each checked byte for byte against what
+// json::dump() writes for the same value: list responses moved from the json
+// DOM to JsonWriter without changing a byte. Exits non-zero on the first
+// failed check.
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+#include "json_writer.h"
+#include "models.h"
+#include "pagination.h"
+#include "test_support.h"
+#include "utils.h"
+
+// JsonWriter's output for a single string value
+static std::string writeString(const std::string& value) {
+    JsonWriter out;
+    out.string(value);
+    return out.release();
+}
+
+static std::string writeAmount(int64_t cents) {
+    JsonWriter out;
+    out.amount(cents);
+    return out.release();
+}
+
+static std::string writeNumber(double value) {
+    JsonWriter out;
+    out.number(value);
+    return out.release();
+}
+
+static void testEscaping() {
+    CHECK(writeString("plain") == "\"plain\"");
+    CHECK(writeString("") == "\"\"");
+    CHECK(writeString("say \"hi\"") == "\"say \\\"hi\\\"\"");
+    CHECK(writeString("C:\\bills\\") == "\"C:\\\\bills\\\\\"");
+    CHECK(writeString("a\nb\tc\rd\be\ff") == "\"a\\nb\\tc\\rd\\be\\ff\"");
+    CHECK(writeString(std::string("nul\0byte", 8)) == "\"nul\\u0000byte\"");
+    CHECK(writeString("\x01\x1f") == "\"\\u0001\\u001f\"");
+    // Not escaped by either writer
+    CHECK(writeString("a/b\x7f") == "\"a/b\x7f\"");
+    CHECK(writeString("caffè 🍕") == "\"caffè 🍕\"");
+
+    // Every single-byte control character and the two that must be escaped
+    for (int c = 0; c < 0x80; ++c) {
+        std::string value = "x" + std::string(1, static_cast<char>(c)) + "y";
+        CHECK(writeString(value) == json(value).dump());
+    }
+
+    // Keys go through the same escaping
+    JsonWriter out;
+    out.beginObject().key("we\"ird\n").integer(1).endObject();
+    CHECK(out.str() == "{\"we\\\"ird\\n\":1}");
+    CHECK(out.str() == (json{{"we\"ird\n", 1}}).dump());
+}
+
+static void testAmounts() {
+    CHECK(writeAmount(1250) == "12.5");
+    CHECK(writeAmount(1200) == "12.0");
+    CHECK(writeAmount(1205) == "12.05");
+    CHECK(writeAmount(5) == "0.05");
+    CHECK(writeAmount(50) == "0.5");
+    CHECK(writeAmount(99) == "0.99");
+    CHECK(writeAmount(0) == "0.0");
+    CHECK(writeAmount(-5) == "-0.05");
+    CHECK(writeAmount(-99) == "-0.99");
+    CHECK(writeAmount(-1250) == "-12.5");
+    CHECK(writeAmount(100000000) == "1000000.0");
+
+    // The DOM held centsToAmount(cents) as a double
+    for (int64_t cents = -100000; cents <= 100000; ++cents) {
+        CHECK(writeAmount(cents) == json(centsToAmount(cents)).dump());
+    }
+    for (int64_t cents : {123456789LL, 999999999999LL, -4503599627370LL}) {
+        CHECK(writeAmount(cents) == json(centsToAmount(cents)).dump());
+    }
+}
+
+static void testNumbers() {
+    CHECK(writeNumber(50) == "50.0");
+    CHECK(writeNumber(0) == "0.0");
+    CHECK(writeNumber(-3) == "-3.0");
+    CHECK(writeNumber(33.5) == "33.5");
+    CHECK(writeNumber(1.0 / 3) == json(1.0 / 3).dump());
+    CHECK(writeNumber(std::numeric_limits<double>::quiet_NaN()) == "null");
+    CHECK(writeNumber(std::numeric_limits<double>::infinity()) == "null");
+
+    for (double value : {0.1, 12.5, 25.0, 33.33, 66.67, 100.0, 1e-7, 1e21, -2.5e-3}) {
+        CHECK(writeNumber(value) == json(value).dump());
+    }
+
+    JsonWriter out;
+    out.beginArray().integer(0).integer(-42).integer(std::numeric_limits<int64_t>::max())
+       .boolean(true).boolean(false).null().endArray();
+    CHECK(out.str() == "[0,-42,9223372036854775807,true,false,null]");
+}
+
+static void testNesting() {
+    JsonWriter out;
+    out.beginObject();
+    out.key("empty").beginArray().endArray();
+    out.key("list").beginArray();
+    out.beginObject().endObject();
+    out.beginObject().key("a").integer(1).key("b").beginArray().integer(2).integer(3).endArray().endObject();
+    out.endArray();
+    out.key("z").string("end");
+    out.endObject();
+    CHECK(out.str() == "{\"empty\":[],\"list\":[{},{\"a\":1,\"b\":[2,3]}],\"z\":\"end\"}");
+}
+
+static Event sampleEvent(bool full) {
+    Event event;
+    event.id = "0b6f3a57-5d0e-4c8b-9a5e-3f1c2d4e5f60";
+    event.name = "Trip to \"Lisbon\"";
+    event.description = "line one\nline two \\ tab\t";
+    event.eventType = "trip";
+    event.status = "active";
+    event.createdAt = 1717243200123;
+    event.updatedAt = 1717329600000;
+    if (full) {
+        event.creatorId = "6f1c2f0e-3b7a-4c2e-9f5d-2a8b7c6d5e4f";
+        event.startDate = 1719792000000;
+        event.endDate = 1720396800999;
+        event.creator = UserSummary{"Alex", "Rossi", "alex.rossi@example.com"};
+    }
+    return event;
+}
+
+static Expense sampleExpense(bool full, int64_t cents) {
+    Expense expense;
+    expense.id = "9a8b7c6d-5e4f-4a3b-8c2d-1e0f9a8b7c6d";
+    expense.eventId = "0b6f3a57-5d0e-4c8b-9a5e-3f1c2d4e5f60";
+    expense.payerId = "6f1c2f0e-3b7a-4c2e-9f5d-2a8b7c6d5e4f";
+    expense.amountCents = cents;
+    expense.description = "Dinner \xc3\xa0 la carte";
+    expense.splitType = "equal";
+    expense.expenseDate = 1717250000000;
+    expense.createdAt = 1717250000456;
+    if (full) {
+        expense.payer = UserSummary{"Alex", "Rossi", ""};
+    }
+    return expense;
+}
+
+static Participant sampleParticipant(bool full) {
+    Participant participant;
+    participant.id = "1c2d3e4f-5a6b-4c7d-8e9f-0a1b2c3d4e5f";
+    participant.eventId = "0b6f3a57-5d0e-4c8b-9a5e-3f1c2d4e5f60";
+    participant.userId = "2d3e4f5a-6b7c-4d8e-9f0a-1b2c3d4e5f6a";
+    participant.status = "active";
+    participant.joinedAt = 1717243300000;
+    if (full) {
+        participant.sharePercentage = 33.33;
+        participant.customAmountCents = 1005;
+        participant.user = UserSummary{"Sam", "O'Neil", "sam@example.com"};
+    }
+    return participant;
+}
+
+template <typename T>
+static std::string written(const T& item) {
+    JsonWriter out;
+    writeJson(out, item);
+    return out.release();
+}
+
+static void testModels() {
+    for (bool full : {false, true}) {
+        CHECK(written(sampleEvent(full)) == toJson(sampleEvent(full)).dump());
+        CHECK(written(sampleParticipant(full)) == toJson(sampleParticipant(full)).dump());
+        for (int64_t cents : {0LL, 5LL, 1250LL, 123456LL}) {
+            CHECK(written(sampleExpense(full, cents)) == toJson(sampleExpense(full, cents)).dump());
+        }
+    }
+}
+
+// The whole list response, as ExpensesController::getExpensesByEvent writes
+// it, against the DOM response the handler used to dump
+static void testListResponse() {
+    std::vector<Expense> expenses = {sampleExpense(true, 1250), sampleExpense(false, 5), sampleExpense(true, 0)};
+    PageCursor next{1717250000000000, expenses.back().id};
+
+    for (bool lastPage : {true, false}) {
+        JsonWriter out;
+        out.beginObject();
+        out.key("expenses").beginArray();
+        for (const auto& expense : expenses) {
+            writeJson(out, expense);
+        }
+        out.endArray();
+        writeNextCursor(out, lastPage ? std::nullopt : std::optional<PageCursor>(next));
+        writeSuccessFields(out);
+        out.endObject();
+
+        json response = createSuccessResponse();
+        response["timestamp"] = json::parse(out.str())["timestamp"];
+        response["expenses"] = toJson(expenses);
+        response["next_cursor"] = lastPage ? json(nullptr) : json(encodeCursor(next));
+        CHECK(out.str() == response.dump());
+    }
+}
+
+int main() {
+    testEscaping();
+    testAmounts();
+    testNumbers();
+    testNesting();
+    testModels();
+    testListResponse();
+
+    std::printf("json_writer_test: all checks passed\n");
+    return 0;
+}
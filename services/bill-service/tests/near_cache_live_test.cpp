@@ -0,0 +1,81 @@
+// RedisClient's near cache against a real Redis (7.x, as in docker-compose),
+// reached through REDIS_HOST/REDIS_PORT: a write from another client evicts
+// the cached value, and killing the companion connection that holds CLIENT
+// TRACKING clears the cache and re-establishes tracking instead of serving
+// stale values until REDIS_NEAR_CACHE_TTL_MS. Exits with 77, which CTest
+// reports as skipped, when no Redis answers.
+//
+//   docker compose up -d redis
+//   REDIS_HOST=localhost ctest --test-dir build -R near-cache-live --output-on-failure
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "redis_client.h"
+#include "redis_nodes.h"
+#include "redis_test_support.h"
+
+static uint64_t resyncs(RedisClient& redis) {
+    return redis.getStats()["near_cache_resyncs"].get<uint64_t>();
+}
+
+static uint64_t hits(RedisClient& redis) {
+    return redis.getStats()["near_cache"]["hits"].get<uint64_t>();
+}
+
+// Reads key until it is served from memory
+static void fill(RedisClient& redis, const std::string& key, const std::string& expected) {
+    CHECK(eventually([&] {
+        uint64_t before = hits(redis);
+        CHECK(redis.getCache(key) == expected);
+        return hits(redis) > before;
+    }));
+}
+
+int main() {
+    // Long enough that only an invalidation can evict a cached value
+    setenv("REDIS_NEAR_CACHE", "true", 1);
+    setenv("REDIS_NEAR_CACHE_TTL_MS", "60000", 1);
+    setenv("REDIS_NEAR_CACHE_PING_MS", "200", 1);
+
+    auto redis = connectSingleNodeOrSkip("near_cache_live_test");
+    RawRedis raw(loadRedisNodes().front());
+    CHECK(raw.ok());
+
+    std::string suffix = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::string key = "near-cache-live-" + suffix;
+    std::string cacheKey = RedisClient::cacheKey(key);
+
+    CHECK(eventually([&] { return resyncs(*redis) >= 1 && redis->getStats()["near_cache_active"].get<bool>(); }));
+
+    // A write from another client reaches the near cache as an invalidation
+    CHECK(redis->setCache(key, "first", 60));
+    fill(*redis, key, "first");
+    raw.command("SET %b %b", cacheKey, "second");
+    CHECK(eventually([&] { return redis->getCache(key) == "second"; }));
+
+    // Killing the connection that holds CLIENT TRACKING ends tracking on the
+    // server; the client must notice, drop what it cached and track again
+    fill(*redis, key, "second");
+    auto tracking = raw.trackingClients();
+    CHECK(tracking.size() == 1);
+    raw.command("CLIENT KILL ID %b", tracking.front());
+    raw.command("SET %b %b", cacheKey, "third");
+    CHECK(eventually([&] { return redis->getCache(key) == "third"; }));
+
+    CHECK(eventually([&] { return resyncs(*redis) >= 2 && redis->getStats()["near_cache_active"].get<bool>(); }));
+    CHECK(raw.trackingClients().size() == 1);
+    CHECK(raw.trackingClients().front() != tracking.front());
+
+    // ...and invalidations flow again over the new pair of connections
+    fill(*redis, key, "third");
+    raw.command("SET %b %b", cacheKey, "fourth");
+    CHECK(eventually([&] { return redis->getCache(key) == "fourth"; }));
+
+    raw.del(cacheKey);
+
+    std::printf("near_cache_live_test: all checks passed\n");
+    return 0;
+}
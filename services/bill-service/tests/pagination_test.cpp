@@ -0,0 +1,156 @@
+// Cursor encoding and the limit/cursor query parameters of the list
+// endpoints. Runs twice under CTest: with PAGE_UNPAGED_LISTS unset, a request
+// without either parameter is unpaged as for mobile builds released before
+// pagination; with PAGE_UNPAGED_LISTS=false it gets PAGE_SIZE_DEFAULT rows.
+// Exits non-zero on the first failed check.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "pagination.h"
+#include "test_support.h"
+#include "utils.h"
+
+static const std::string kId = "0b6f3a57-5d0e-4c8b-9a5e-3f1c2d4e5f60";
+
+// Independent of pagination.cpp, for payloads encodeCursor cannot produce
+static std::string base64Url(const std::string& input) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string output;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (unsigned char c : input) {
+        buffer = (buffer << 8) | c;
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            output += alphabet[(buffer >> bits) & 0x3f];
+        }
+    }
+    if (bits > 0) {
+        output += alphabet[(buffer << (6 - bits)) & 0x3f];
+    }
+    return output;
+}
+
+static bool decodes(const std::string& token) {
+    PageCursor cursor;
+    return decodeCursor(token, cursor);
+}
+
+static void testCursorRoundTrip() {
+    for (int64_t sortKey : {int64_t{0}, int64_t{1}, int64_t{1717243200123456}, INT64_MAX}) {
+        PageCursor cursor{sortKey, kId};
+        std::string token = encodeCursor(cursor);
+        CHECK(token.find_first_of("+/=") == std::string::npos);  // URL-safe, unpadded
+
+        PageCursor decoded;
+        CHECK(decodeCursor(token, decoded));
+        CHECK(decoded.sortKey == sortKey);
+        CHECK(decoded.id == kId);
+    }
+
+    // Upper-case UUIDs are still UUIDs
+    PageCursor upper{42, "0B6F3A57-5D0E-4C8B-9A5E-3F1C2D4E5F60"};
+    PageCursor decoded;
+    CHECK(decodeCursor(encodeCursor(upper), decoded));
+    CHECK(decoded.id == upper.id);
+}
+
+static void testBadCursors() {
+    // Not base64url
+    CHECK(!decodes(""));
+    CHECK(!decodes("!!!!"));
+    CHECK(!decodes("abc def"));
+    CHECK(!decodes("YWJj+/"));
+    CHECK(!decodes(encodeCursor({42, kId}) + "="));
+
+    // Too long to be a cursor, even though it decodes
+    CHECK(!decodes(std::string(129, 'A')));
+    CHECK(!decodes(encodeCursor({42, kId + std::string(64, 'a')})));
+
+    // Decodes, but is not "<sortKey>:<uuid>"
+    CHECK(base64Url("42:" + kId) == encodeCursor({42, kId}));
+    CHECK(decodes(base64Url("42:" + kId)));
+    CHECK(!decodes(base64Url("12345")));
+    CHECK(!decodes(base64Url(":" + kId)));
+    CHECK(!decodes(base64Url("abc:" + kId)));
+    CHECK(!decodes(base64Url("42x:" + kId)));
+    CHECK(!decodes(base64Url("+42:" + kId)));
+    CHECK(!decodes(base64Url("99999999999999999999:" + kId)));  // overflows int64
+    CHECK(!decodes(encodeCursor({42, "not-a-uuid"})));
+    CHECK(!decodes(encodeCursor({42, kId + ":extra"})));
+    CHECK(!decodes(encodeCursor({42, ""})));
+
+    // Negative sort keys are never issued
+    CHECK(!decodes(encodeCursor({-1, kId})));
+    CHECK(!decodes(encodeCursor({INT64_MIN, kId})));
+}
+
+static void testLimits(bool unpagedLists) {
+    PageRequest page;
+    std::string error;
+
+    // No parameters: the whole list for old clients, otherwise the default page
+    CHECK(parsePageRequest("", "", page, error));
+    CHECK(page.limit == (unpagedLists ? kUnpagedLimit : size_t{20}));
+    CHECK(!page.after);
+
+    // A cursor alone pages with the default size either way
+    std::string token = encodeCursor({1717243200123456, kId});
+    CHECK(parsePageRequest("", token, page, error));
+    CHECK(page.limit == 20);
+    CHECK(page.after && page.after->sortKey == 1717243200123456 && page.after->id == kId);
+
+    CHECK(parsePageRequest("1", "", page, error));
+    CHECK(page.limit == 1);
+    CHECK(!page.after);
+    CHECK(parsePageRequest("50", token, page, error));
+    CHECK(page.limit == 50);
+    CHECK(page.after);
+
+    for (const char* limit : {"0", "51", "1000000", "abc", "-1", "+5", " 5", "5 ", "5abc", "2.5",
+                              "99999999999999999999999"}) {
+        error.clear();
+        CHECK(!parsePageRequest(limit, "", page, error));
+        CHECK(error == "limit must be between 1 and 50");
+    }
+
+    for (const std::string& cursor : {std::string("garbage!"), base64Url("12345")}) {
+        error.clear();
+        CHECK(!parsePageRequest("10", cursor, page, error));
+        CHECK(error == "Invalid cursor");
+        CHECK(!parsePageRequest("", cursor, page, error));
+    }
+}
+
+static void testNextCursor() {
+    JsonWriter last;
+    last.beginObject();
+    writeNextCursor(last, std::nullopt);
+    last.endObject();
+    CHECK(last.str() == "{\"next_cursor\":null}");
+
+    PageCursor cursor{7, kId};
+    JsonWriter more;
+    more.beginObject();
+    writeNextCursor(more, cursor);
+    more.endObject();
+    CHECK(more.str() == "{\"next_cursor\":\"" + encodeCursor(cursor) + "\"}");
+}
+
+int main() {
+    // parsePageRequest reads these once, on its first call
+    setenv("PAGE_SIZE_DEFAULT", "20", 1);
+    setenv("PAGE_SIZE_MAX", "50", 1);
+    bool unpagedLists = getEnvVar("PAGE_UNPAGED_LISTS", "true") == "true";
+
+    testCursorRoundTrip();
+    testBadCursors();
+    testLimits(unpagedLists);
+    testNextCursor();
+
+    std::printf("pagination_test: all checks passed (unpaged lists %s)\n", unpagedLists ? "on" : "off");
+    return 0;
+}
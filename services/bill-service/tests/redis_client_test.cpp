@@ -0,0 +1,187 @@
+// RedisClient's token, cache and revocation paths against the in-memory
+// backend, so they run without a Redis server. Exits non-zero on the first
+// failed check.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "memory_backend.h"
+#include "redis_client.h"
+#include "revocation_filter.h"
+#include "test_support.h"
+
+static std::shared_ptr<RedisClient> makeClient() {
+    auto redis = std::make_shared<RedisClient>(std::make_shared<MemoryBackend>());
+    CHECK(redis->connect());
+    return redis;
+}
+
+static int64_t epochSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void testTokens() {
+    auto redis = makeClient();
+
+    CHECK(redis->getToken("t1").empty());
+    CHECK(!redis->tokenExists("t1"));
+
+    CHECK(redis->setToken("t1", "{\"userId\":\"u1\"}", 60));
+    CHECK(redis->tokenExists("t1"));
+    CHECK(redis->getToken("t1") == "{\"userId\":\"u1\"}");
+    CHECK(redis->lookupToken("t1") == "{\"userId\":\"u1\"}");
+    CHECK(redis->lookupToken("t1", 120) == "{\"userId\":\"u1\"}");
+
+    CHECK(redis->deleteToken("t1"));
+    CHECK(!redis->deleteToken("t1"));
+    CHECK(redis->lookupToken("t1").empty());
+}
+
+static void testTokenExpiry() {
+    auto redis = makeClient();
+
+    CHECK(redis->setToken("short", "a", 1));
+    CHECK(redis->setToken("sliding", "b", 1));
+    // Raised to 3s, so it outlives the 1s token set alongside it
+    CHECK(redis->lookupToken("sliding", 3) == "b");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    CHECK(redis->lookupToken("short").empty());
+    CHECK(!redis->tokenExists("short"));
+    CHECK(redis->lookupToken("sliding") == "b");
+}
+
+static void testTokenInvalidation() {
+    auto redis = makeClient();
+
+    std::vector<std::string> invalidated;
+    int resyncs = 0;
+    redis->startTokenInvalidation(
+        [&](const std::string& token) { invalidated.push_back(token); },
+        [&] { ++resyncs; });
+    CHECK(resyncs == 1);
+
+    redis->setToken("gone", "x", 60);
+    redis->setCache("not-a-token", "y", 60);
+    redis->deleteToken("gone");
+    redis->deleteCache("not-a-token");
+    CHECK(invalidated == std::vector<std::string>{"gone"});
+
+    redis->stopTokenInvalidation();
+    redis->setToken("quiet", "x", 60);
+    redis->deleteToken("quiet");
+    CHECK(invalidated.size() == 1);
+}
+
+static void testCache() {
+    auto redis = makeClient();
+
+    CHECK(redis->getCache("k").empty());
+    CHECK(redis->setCache("k", "value", 60));
+    CHECK(redis->getCache("k") == "value");
+    // Tokens and cache entries live in separate key prefixes
+    CHECK(redis->getToken("k").empty());
+    CHECK(redis->deleteCache("k"));
+    CHECK(redis->getCache("k").empty());
+}
+
+static void testCacheObjects() {
+    json value = {{"event", "e1"}, {"balances", {{"u1", 12.5}, {"u2", -12.5}}}, {"count", 2}};
+
+    for (const char* encoding : {"msgpack", "cbor", "json"}) {
+        setenv("REDIS_CACHE_ENCODING", encoding, 1);
+        auto redis = makeClient();
+
+        CHECK(!redis->getCacheObject("obj"));
+        CHECK(redis->setCacheObject("obj", value, 60));
+        auto decoded = redis->getCacheObject("obj");
+        CHECK(decoded && *decoded == value);
+    }
+
+    // Entries written under one encoding still decode under another
+    auto backend = std::make_shared<MemoryBackend>();
+    setenv("REDIS_CACHE_ENCODING", "cbor", 1);
+    RedisClient writer(backend);
+    CHECK(writer.setCacheObject("shared", value, 60));
+    setenv("REDIS_CACHE_ENCODING", "json", 1);
+    RedisClient reader(backend);
+    auto decoded = reader.getCacheObject("shared");
+    CHECK(decoded && *decoded == value);
+    unsetenv("REDIS_CACHE_ENCODING");
+
+    // A payload without a known tag byte is a miss, not an exception
+    CHECK(reader.setCache("shared", "garbage", 60));
+    CHECK(!reader.getCacheObject("shared"));
+}
+
+static void testRevokedTokens() {
+    auto redis = makeClient();
+    std::string live(64, 'a');
+    std::string lapsed(64, 'b');
+
+    auto digests = redis->getRevokedTokens();
+    CHECK(digests && digests->empty());
+    CHECK(redis->isTokenRevoked(live) == std::optional<bool>(false));
+
+    CHECK(redis->revokeToken(live, epochSeconds() + 3600));
+    digests = redis->getRevokedTokens();
+    CHECK(digests && *digests == std::vector<std::string>{live});
+    CHECK(redis->isTokenRevoked(live) == std::optional<bool>(true));
+
+    // Entries past their exp are not reported and are pruned on the next write
+    CHECK(redis->revokeToken(lapsed, epochSeconds() - 10));
+    digests = redis->getRevokedTokens();
+    CHECK(digests && *digests == std::vector<std::string>{live});
+    CHECK(redis->isTokenRevoked(lapsed) == std::optional<bool>(false));
+}
+
+static void testRevocationFilter() {
+    auto redis = makeClient();
+    std::string revoked(32, '\x11');
+    std::string other(32, '\x22');
+
+    // Hex digests as the auth service writes them
+    CHECK(redis->revokeToken(std::string(64, '1'), epochSeconds() + 3600));
+
+    // Later syncs report from the filter's thread
+    std::mutex reportedMutex;
+    std::vector<std::string> reported;
+    RevocationFilter filter(redis, std::chrono::milliseconds(50), 0.001);
+    filter.start([&](const std::string& digest) {
+        std::lock_guard<std::mutex> lock(reportedMutex);
+        reported.push_back(digest);
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(reportedMutex);
+        CHECK(!reported.empty() && reported.front() == revoked);
+    }
+    CHECK(filter.isRevoked(revoked));
+    CHECK(!filter.isRevoked(other));
+
+    // A later revocation is picked up by the next sync
+    CHECK(redis->revokeToken(std::string(64, '2'), epochSeconds() + 3600));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(filter.isRevoked(other));
+
+    filter.stop();
+}
+
+int main() {
+    testTokens();
+    testTokenExpiry();
+    testTokenInvalidation();
+    testCache();
+    testCacheObjects();
+    testRevokedTokens();
+    testRevocationFilter();
+
+    std::printf("redis_client_test: all checks passed\n");
+    return 0;
+}
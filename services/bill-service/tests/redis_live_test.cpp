@@ -0,0 +1,58 @@
+// RedisClient's server-side paths against a real Redis (7.x, as in
+// docker-compose), reached through REDIS_HOST/REDIS_PORT or REDIS_NODES.
+// Covers the sliding-TTL lookup script, including the NOSCRIPT reload after
+// SCRIPT FLUSH. Exits with 77, which CTest reports as skipped, when no Redis
+// answers.
+//
+//   docker compose up -d redis
+//   REDIS_HOST=localhost ctest --test-dir build -R redis-live --output-on-failure
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "redis_client.h"
+#include "redis_nodes.h"
+#include "redis_test_support.h"
+
+int main() {
+    // One node is enough; the test keys are all checked on the node that holds them
+    auto redis = connectSingleNodeOrSkip("redis_live_test");
+    RawRedis raw(loadRedisNodes().front());
+    CHECK(raw.ok());
+
+    std::string suffix = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::string expiring = "live-test-expiring-" + suffix;
+    std::string persistent = "live-test-persistent-" + suffix;
+
+    // The script raises a short TTL to the sliding TTL
+    CHECK(redis->setToken(expiring, "session", 5));
+    CHECK(redis->lookupToken(expiring, 60) == "session");
+    long long ttl = raw.integer("TTL token:%b", expiring);
+    CHECK(ttl > 50 && ttl <= 60);
+
+    // ...and never lowers one that is already longer
+    CHECK(redis->lookupToken(expiring, 10) == "session");
+    CHECK(raw.integer("TTL token:%b", expiring) > 50);
+
+    // Keys without an expiry stay persistent
+    raw.command("SET token:%b session", persistent);
+    CHECK(redis->lookupToken(persistent, 60) == "session");
+    CHECK(raw.integer("TTL token:%b", persistent) == -1);
+
+    // Unknown tokens are a miss, not an error
+    CHECK(redis->lookupToken("live-test-missing-" + suffix, 60).empty());
+
+    // After a flush EVALSHA answers NOSCRIPT and the client falls back to EVAL
+    raw.command("SCRIPT FLUSH");
+    CHECK(redis->lookupToken(expiring, 120) == "session");
+    CHECK(raw.integer("TTL token:%b", expiring) > 110);
+    // EVAL cached the script again under the same digest
+    CHECK(redis->lookupToken(expiring, 180) == "session");
+    CHECK(raw.integer("TTL token:%b", expiring) > 170);
+
+    raw.integer("DEL token:%b", expiring);
+    raw.integer("DEL token:%b", persistent);
+
+    std::printf("redis_live_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+// RedisHashRing against tests/fixtures/redis_ring.json, the key -> node table
+// the auth service's ring (services/auth-service/src/redis_ring.js) is also
+// tested against, so the two services cannot drift apart on where a token:*
+// key lives. Also checks {tag} placement and that only ~1/N of the keys move
+// when a node is added. Takes the fixture path as its only argument; exits
+// non-zero on the first failed check.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "redis_nodes.h"
+#include "test_support.h"
+
+using json = nlohmann::json;
+
+static std::vector<RedisNode> parseNodes(const json& addresses) {
+    std::vector<RedisNode> nodes;
+    for (const auto& address : addresses) {
+        std::string entry = address.get<std::string>();
+        size_t colon = entry.rfind(':');
+        nodes.push_back(RedisNode{entry.substr(0, colon), std::stoi(entry.substr(colon + 1))});
+    }
+    return nodes;
+}
+
+static void testFixture(const json& rings) {
+    CHECK(rings.is_array() && !rings.empty());
+
+    for (const auto& ring : rings) {
+        RedisHashRing hashRing(parseNodes(ring["nodes"]));
+        CHECK(hashRing.size() == ring["nodes"].size());
+        CHECK(!ring["keys"].empty());
+
+        for (const auto& [key, node] : ring["keys"].items()) {
+            size_t actual = hashRing.nodeFor(key);
+            if (actual != node.get<size_t>()) {
+                std::fprintf(stderr, "key \"%s\": expected node %zu, got %zu\n",
+                             key.c_str(), node.get<size_t>(), actual);
+            }
+            CHECK(actual == node.get<size_t>());
+        }
+    }
+}
+
+static void testTags() {
+    RedisHashRing ring({{"redis-a", 6379}, {"redis-b", 6379}, {"redis-c", 6379}});
+
+    CHECK(ring.nodeFor("{event-1}:balances") == ring.nodeFor("event-1"));
+    CHECK(ring.nodeFor("prefix{event-1}suffix") == ring.nodeFor("event-1"));
+    // Only the first tag counts; empty tags are covered by the fixture
+    CHECK(ring.nodeFor("{a}{b}") == ring.nodeFor("a"));
+
+    // A single node takes every key
+    RedisHashRing single({{"redis", 6379}});
+    CHECK(single.nodeFor("token:anything") == 0);
+}
+
+static void testRebalance() {
+    std::vector<RedisNode> three = {{"redis-a", 6379}, {"redis-b", 6379}, {"redis-c", 6379}};
+    std::vector<RedisNode> four = three;
+    four.push_back({"redis-d", 6379});
+    RedisHashRing before(three);
+    RedisHashRing after(four);
+
+    int moved = 0;
+    const int keys = 10000;
+    for (int i = 0; i < keys; ++i) {
+        std::string key = "token:" + std::to_string(i);
+        size_t node = after.nodeFor(key);
+        if (node != before.nodeFor(key)) {
+            // Keys only ever move to the new node
+            CHECK(node == 3);
+            ++moved;
+        }
+    }
+    // About a quarter of the keys, with room for the ring's unevenness
+    CHECK(moved > keys / 8 && moved < keys * 3 / 8);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s fixtures/redis_ring.json\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream file(argv[1]);
+    CHECK(file);
+    testFixture(json::parse(file));
+    testTags();
+    testRebalance();
+
+    std::printf("redis_ring_test: all checks passed\n");
+    return 0;
+}
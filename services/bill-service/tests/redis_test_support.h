@@ -0,0 +1,110 @@
+#ifndef REDIS_TEST_SUPPORT_H
+#define REDIS_TEST_SUPPORT_H
+
+// Helpers for the tests that run against live Redis servers
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <hiredis/hiredis.h>
+#include "redis_client.h"
+#include "redis_nodes.h"
+#include "test_support.h"
+#include "utils.h"
+
+// A plain connection to one node, for reading and writing keys behind the
+// clients' backs. Arguments are passed binary-safe: use %b in the format.
+class RawRedis {
+public:
+    explicit RawRedis(const RedisNode& node) {
+        struct timeval timeout = {1, 0};
+        context_ = redisConnectWithTimeout(node.host.c_str(), node.port, timeout);
+        std::string password = getEnvVar("REDIS_PASSWORD", "");
+        if (ok() && !password.empty()) {
+            freeReplyObject(redisCommand(context_, "AUTH %b", password.data(), password.size()));
+        }
+    }
+    ~RawRedis() {
+        if (context_) {
+            redisFree(context_);
+        }
+    }
+
+    RawRedis(const RawRedis&) = delete;
+    RawRedis& operator=(const RawRedis&) = delete;
+
+    bool ok() const { return context_ && !context_->err; }
+
+    // The reply's string, the value of a two-element array reply (CONFIG GET),
+    // or empty; an error reply fails the test
+    std::string string(const char* format, const std::string& arg = "", const std::string& arg2 = "") {
+        auto* reply = static_cast<redisReply*>(
+            redisCommand(context_, format, arg.data(), arg.size(), arg2.data(), arg2.size()));
+        CHECK(reply && reply->type != REDIS_REPLY_ERROR);
+        std::string value = reply->type == REDIS_REPLY_ARRAY && reply->elements == 2
+            ? std::string(reply->element[1]->str, reply->element[1]->len)
+            : reply->str ? std::string(reply->str, reply->len) : "";
+        freeReplyObject(reply);
+        return value;
+    }
+
+    void command(const char* format, const std::string& arg = "", const std::string& arg2 = "") {
+        string(format, arg, arg2);
+    }
+
+    long long integer(const char* format, const std::string& arg) {
+        auto* reply = static_cast<redisReply*>(redisCommand(context_, format, arg.data(), arg.size()));
+        CHECK(reply && reply->type == REDIS_REPLY_INTEGER);
+        long long value = reply->integer;
+        freeReplyObject(reply);
+        return value;
+    }
+
+    // Empty when the key is missing
+    std::string get(const std::string& key) { return string("GET %b", key); }
+    void set(const std::string& key, const std::string& value) { command("SET %b %b EX 60", key, value); }
+    void del(const std::string& key) { command("DEL %b", key); }
+
+    // Ids of the connections with CLIENT TRACKING on (flag t in CLIENT LIST)
+    std::vector<std::string> trackingClients() {
+        std::vector<std::string> ids;
+        std::istringstream clients(string("CLIENT LIST TYPE normal"));
+        std::string line;
+        while (std::getline(clients, line)) {
+            size_t flags = line.find(" flags=");
+            if (flags == std::string::npos) {
+                continue;
+            }
+            size_t flagsEnd = line.find(' ', flags + 1);
+            if (line.substr(flags + 7, flagsEnd - flags - 7).find('t') == std::string::npos) {
+                continue;
+            }
+            size_t idEnd = line.find(' ');
+            ids.push_back(line.substr(3, idEnd - 3));  // "id=<n> ..."
+        }
+        return ids;
+    }
+
+private:
+    redisContext* context_ = nullptr;
+};
+
+// The single-server live tests start here: a RedisClient connected with the
+// current environment, or exit kSkipped when REDIS_NODES names several
+// servers or none answers
+inline std::shared_ptr<RedisClient> connectSingleNodeOrSkip(const char* test) {
+    if (loadRedisNodes().size() > 1) {
+        std::printf("%s: skipped, needs a single REDIS_HOST\n", test);
+        std::exit(kSkipped);
+    }
+
+    auto redis = std::make_shared<RedisClient>();
+    if (!redis->connect()) {
+        std::printf("%s: skipped, no Redis reachable\n", test);
+        std::exit(kSkipped);
+    }
+    return redis;
+}
+
+#endif
@@ -0,0 +1,132 @@
+// SplitCalculator's side of the contract the balance ledger SQL
+// (Statements::LedgerApplyExpense and LedgerRebuild) also implements: an
+// expense is split equally over the distinct members, leftover cents go to
+// the first members by user id whatever order they arrive in, and only a
+// payer who is a member is credited. database_live_test checks the SQL
+// against this. Exits non-zero on the first failed check.
+
+#include <cstdio>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "models.h"
+#include "split_calculator.h"
+#include "test_support.h"
+
+// Lower-case UUIDs, as PostgreSQL prints them, listed in sorted order
+static const std::string kA = "0a000000-0000-4000-8000-000000000000";
+static const std::string kB = "5b000000-0000-4000-8000-000000000000";
+static const std::string kC = "9c000000-0000-4000-8000-000000000000";
+static const std::string kD = "fd000000-0000-4000-8000-000000000000";
+
+static Expense expense(const std::string& payerId, int64_t cents) {
+    Expense result;
+    result.payerId = payerId;
+    result.amountCents = cents;
+    result.splitType = "equal";
+    return result;
+}
+
+static std::vector<Participant> members(const std::vector<std::string>& userIds) {
+    std::vector<Participant> result;
+    for (const auto& userId : userIds) {
+        Participant participant;
+        participant.userId = userId;
+        participant.status = "active";
+        result.push_back(participant);
+    }
+    return result;
+}
+
+static int64_t sum(const std::map<std::string, int64_t>& balances) {
+    return std::accumulate(balances.begin(), balances.end(), int64_t{0},
+                           [](int64_t total, const auto& entry) { return total + entry.second; });
+}
+
+static void testLeftoverCents() {
+    // 100 cents over three members: 34, 33, 33, the extra cent on the lowest id
+    for (const auto& order : std::vector<std::vector<std::string>>{{kA, kB, kC}, {kC, kA, kB}, {kB, kC, kA}}) {
+        auto shares = SplitCalculator::calculateExpenseShares(100, "equal", order);
+        CHECK(shares.size() == 3);
+        std::map<std::string, int64_t> byUser;
+        for (const auto& share : shares) {
+            byUser[share.userId] = share.amountCents;
+        }
+        CHECK(byUser[kA] == 34);
+        CHECK(byUser[kB] == 33);
+        CHECK(byUser[kC] == 33);
+    }
+
+    // Two leftover cents over four members go to the two lowest ids
+    auto shares = SplitCalculator::calculateExpenseShares(1002, "equal", {kD, kC, kB, kA});
+    std::map<std::string, int64_t> byUser;
+    for (const auto& share : shares) {
+        byUser[share.userId] = share.amountCents;
+    }
+    CHECK(byUser[kA] == 251);
+    CHECK(byUser[kB] == 251);
+    CHECK(byUser[kC] == 250);
+    CHECK(byUser[kD] == 250);
+
+    // Fewer cents than members
+    shares = SplitCalculator::calculateExpenseShares(2, "equal", {kC, kB, kA});
+    byUser.clear();
+    for (const auto& share : shares) {
+        byUser[share.userId] = share.amountCents;
+    }
+    CHECK(byUser[kA] == 1);
+    CHECK(byUser[kB] == 1);
+    CHECK(byUser[kC] == 0);
+
+    // Balances: the payer is credited in full and owes their own share
+    auto balances = SplitCalculator::calculateUserBalances({expense(kC, 100)}, members({kC, kB, kA}));
+    CHECK(balances.at(kA) == -34);
+    CHECK(balances.at(kB) == -33);
+    CHECK(balances.at(kC) == 67);
+    CHECK(sum(balances) == 0);
+}
+
+static void testPayerNotMember() {
+    // Nobody is credited for the payment, the members still owe their shares
+    auto balances = SplitCalculator::calculateUserBalances({expense(kD, 1000)}, members({kA, kB, kC}));
+    CHECK(balances.size() == 3);
+    CHECK(balances.count(kD) == 0);
+    CHECK(balances.at(kA) == -334);
+    CHECK(balances.at(kB) == -333);
+    CHECK(balances.at(kC) == -333);
+    CHECK(sum(balances) == -1000);
+}
+
+static void testCreatorAlsoParticipant() {
+    // The creator is added as a member next to the participant rows; if they
+    // also have a row of their own they still count once
+    auto once = SplitCalculator::calculateUserBalances({expense(kA, 900)}, members({kA, kB, kC}));
+    auto twice = SplitCalculator::calculateUserBalances({expense(kA, 900)}, members({kB, kA, kC, kA}));
+    CHECK(once == twice);
+    CHECK(twice.size() == 3);
+    CHECK(twice.at(kA) == 600);
+    CHECK(twice.at(kB) == -300);
+    CHECK(twice.at(kC) == -300);
+}
+
+static void testSplitTypeWithoutShares() {
+    // The ledger always splits equally; so do balances, which pass no shares
+    auto equal = SplitCalculator::calculateUserBalances({expense(kB, 1001)}, members({kA, kB, kC}));
+    Expense custom = expense(kB, 1001);
+    custom.splitType = "custom";
+    Expense percentage = expense(kB, 1001);
+    percentage.splitType = "percentage";
+    CHECK(SplitCalculator::calculateUserBalances({custom}, members({kA, kB, kC})) == equal);
+    CHECK(SplitCalculator::calculateUserBalances({percentage}, members({kA, kB, kC})) == equal);
+}
+
+int main() {
+    testLeftoverCents();
+    testPayerNotMember();
+    testCreatorAlsoParticipant();
+    testSplitTypeWithoutShares();
+
+    std::printf("split_calculator_test: all checks passed\n");
+    return 0;
+}
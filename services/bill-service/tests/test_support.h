@@ -0,0 +1,40 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+// Shared by the test executables: each is a plain main() that exits non-zero
+// on the first failed CHECK, or with kSkipped when what it needs is missing.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        if (!(condition)) {                                                       \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                         #condition);                                             \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+// CTest reports this exit code as skipped (SKIP_RETURN_CODE in CMakeLists.txt)
+inline constexpr int kSkipped = 77;
+
+inline constexpr std::chrono::seconds kEventTimeout{3};
+
+// Polls until done() holds or timeout passes
+inline bool eventually(const std::function<bool()>& done,
+                       std::chrono::milliseconds timeout = kEventTimeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+#endif
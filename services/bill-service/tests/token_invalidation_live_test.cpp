@@ -0,0 +1,154 @@
+// The token:* keyspace subscriber against a real Redis, reached through
+// REDIS_HOST/REDIS_PORT: deletions and expirations reach onInvalidate, a
+// dropped subscriber connection resubscribes and calls onResync, and
+// AuthMiddleware stops serving a cached token once its session is deleted.
+// Needs keyspace notifications on the server (Kgxe, as docker-compose starts
+// it) and leaves its configuration alone. Exits with 77, which CTest reports
+// as skipped, when no Redis answers or notifications are off.
+//
+//   docker compose up -d redis
+//   REDIS_HOST=localhost ctest --test-dir build -R token-invalidation-live --output-on-failure
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <jwt-cpp/jwt.h>
+#include "auth_middleware.h"
+#include "redis_client.h"
+#include "redis_nodes.h"
+#include "redis_test_support.h"
+#include "utils.h"
+
+// What the subscriber reported, filled from its thread
+class Events {
+public:
+    void invalidated(const std::string& token) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tokens_.insert(token);
+        changed_.notify_all();
+    }
+
+    void resynced() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++resyncs_;
+        changed_.notify_all();
+    }
+
+    bool waitForToken(const std::string& token) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return changed_.wait_for(lock, kEventTimeout, [&] { return tokens_.count(token) > 0; });
+    }
+
+    bool waitForResyncs(int count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return changed_.wait_for(lock, kEventTimeout, [&] { return resyncs_ >= count; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::set<std::string> tokens_;
+    int resyncs_ = 0;
+};
+
+static void testSubscriber(RawRedis& raw, const std::string& suffix) {
+    auto redis = std::make_shared<RedisClient>();
+    CHECK(redis->connect());
+
+    Events events;
+    redis->startTokenInvalidation(
+        [&events](const std::string& token) { events.invalidated(token); },
+        [&events] { events.resynced(); });
+    CHECK(events.waitForResyncs(1));
+
+    // A DEL, as the auth service does on logout
+    std::string deleted = "live-deleted-" + suffix;
+    CHECK(redis->setToken(deleted, "session", 60));
+    CHECK(raw.integer("DEL token:%b", deleted) == 1);
+    CHECK(events.waitForToken(deleted));
+
+    // An expiry, reported once Redis actually removes the key
+    std::string expired = "live-expired-" + suffix;
+    CHECK(redis->setToken(expired, "session", 60));
+    CHECK(raw.integer("PEXPIRE token:%b 1", expired) == 1);
+    CHECK(events.waitForToken(expired));
+
+    // Dropping the subscriber's connection makes it resubscribe and resync,
+    // and deletions after that are still reported
+    raw.command("CLIENT KILL TYPE pubsub");
+    CHECK(events.waitForResyncs(2));
+    std::string afterReconnect = "live-reconnected-" + suffix;
+    CHECK(redis->setToken(afterReconnect, "session", 60));
+    CHECK(raw.integer("DEL token:%b", afterReconnect) == 1);
+    CHECK(events.waitForToken(afterReconnect));
+
+    redis->stopTokenInvalidation();
+}
+
+static void testAuthMiddleware(RawRedis& raw) {
+    // Long enough that only the invalidation can evict the cached token
+    setenv("AUTH_MODE", "session", 1);
+    setenv("TOKEN_CACHE_TTL_MS", "60000", 1);
+
+    auto redis = std::make_shared<RedisClient>();
+    CHECK(redis->connect());
+    AuthMiddleware auth(redis);
+    auth.startTokenInvalidation();
+
+    std::string userId = "6f1c2f0e-3b7a-4c2e-9f5d-2a8b7c6d5e4f";
+    std::string email = "alex.rossi@example.com";
+    std::string token = jwt::create()
+        .set_type("JWT")
+        .set_payload_claim("userId", jwt::claim(userId))
+        .set_payload_claim("email", jwt::claim(email))
+        .set_expires_at(std::chrono::system_clock::now() + std::chrono::hours(1))
+        .sign(jwt::algorithm::hs256{getEnvVar("JWT_SECRET", "your_super_secure_jwt_secret_key_min_32_chars")});
+    CHECK(redis->setToken(token, json{{"userId", userId}, {"email", email}}.dump(), 3600));
+
+    httplib::Request req;
+    req.headers.emplace("Authorization", "Bearer " + token);
+    httplib::Response res;
+    RequestContext context;
+
+    // Subscribing clears the cache, so wait for that before filling it
+    CHECK(eventually([&] { return redis->getStats()["token_subscriber_resyncs"].get<uint64_t>() >= 1; }));
+    CHECK(eventually([&] {
+        CHECK(auth.requireAuth(req, res, context));
+        return auth.getAuthStats()["cached"]["count"].get<uint64_t>() >= 1;
+    }));
+
+    CHECK(raw.integer("DEL token:%b", token) == 1);
+    CHECK(eventually([&] { return !auth.requireAuth(req, res, context); }));
+    CHECK(res.status == 401);
+
+    redis->stopTokenInvalidation();
+}
+
+int main() {
+    auto probe = connectSingleNodeOrSkip("token_invalidation_live_test");
+    RawRedis raw(loadRedisNodes().front());
+    CHECK(raw.ok());
+
+    // The same test as RedisClient::checkKeyspaceNotifications
+    std::string flags = raw.string("CONFIG GET notify-keyspace-events");
+    bool keyspace = flags.find('K') != std::string::npos;
+    bool events = flags.find('A') != std::string::npos ||
+                  (flags.find('g') != std::string::npos && flags.find('x') != std::string::npos);
+    if (!keyspace || !events) {
+        std::printf("token_invalidation_live_test: skipped, notify-keyspace-events is \"%s\", needs Kgxe\n",
+                    flags.c_str());
+        return kSkipped;
+    }
+
+    std::string suffix = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    testSubscriber(raw, suffix);
+    testAuthMiddleware(raw);
+
+    std::printf("token_invalidation_live_test: all checks passed\n");
+    return 0;
+}
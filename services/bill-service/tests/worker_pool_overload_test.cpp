@@ -0,0 +1,111 @@
+// Drives a WorkerPool at about 2.5x its capacity from a single accepting
+// thread, as httplib's accept loop does, and checks that requests which get
+// a worker still finish within the queue deadline plus their service time:
+// the backlog is shed instead of growing. Shed connections are modelled as
+// slow clients so the shed backlog fills and further connections are dropped.
+// Exits non-zero on the first failed check. The bounds are wall-clock, so
+// CTest runs it only when configured with BILL_SERVICE_PERF_TESTS:
+//
+//   ctest --test-dir build -L perf --output-on-failure
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "test_support.h"
+#include "worker_pool.h"
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+static constexpr int kWorkers = 4;
+static constexpr int kDeadlineMs = 50;
+static constexpr int kShedLimit = 8;
+static constexpr milliseconds kServiceTime{10};
+static constexpr milliseconds kSlowClient{20};
+static constexpr milliseconds kArrivalInterval{1};
+static constexpr milliseconds kDuration{2000};
+// Room for thread wake-ups and sleep overshoot on a loaded CI machine
+static constexpr milliseconds kSlack{50};
+
+static double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+int main() {
+    setenv("HTTP_WORKER_THREADS", std::to_string(kWorkers).c_str(), 1);
+    setenv("HTTP_QUEUE_MAX", "16", 1);
+    setenv("HTTP_QUEUE_DEADLINE_MS", std::to_string(kDeadlineMs).c_str(), 1);
+    setenv("HTTP_SHED_THREADS", "1", 1);
+    setenv("HTTP_SHED_QUEUE_MAX", std::to_string(kShedLimit).c_str(), 1);
+
+    WorkerPool pool;
+
+    std::mutex latenciesMutex;
+    std::vector<double> latenciesMs;
+    std::atomic<int> shed{0};
+    std::atomic<int> dropped{0};
+    int offered = 0;
+    size_t peakShedBacklog = 0;
+
+    auto start = Clock::now();
+    for (auto next = start; next - start < kDuration; next += kArrivalInterval) {
+        std::this_thread::sleep_until(next);
+        auto enqueuedAt = Clock::now();
+        pool.enqueue([&, enqueuedAt] {
+            if (WorkerPool::isDropping()) {
+                ++dropped;
+                return;
+            }
+            if (WorkerPool::isShedding()) {
+                ++shed;
+                std::this_thread::sleep_for(kSlowClient);
+                return;
+            }
+            std::this_thread::sleep_for(kServiceTime);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - enqueuedAt).count();
+            std::lock_guard<std::mutex> lock(latenciesMutex);
+            latenciesMs.push_back(ms);
+        });
+        ++offered;
+
+        if (offered % 50 == 0) {
+            peakShedBacklog = std::max(peakShedBacklog, pool.getStats()["shed_backlog"].get<size_t>());
+        }
+    }
+    pool.shutdown();
+
+    json stats = pool.getStats();
+    int served = static_cast<int>(latenciesMs.size());
+    double p50 = percentile(latenciesMs, 0.50);
+    double p99 = percentile(latenciesMs, 0.99);
+    double bound = std::chrono::duration<double, std::milli>(
+        milliseconds(kDeadlineMs) + kServiceTime + kSlack).count();
+
+    std::printf("offered %d, served %d, shed %d, dropped %d\n", offered, served, shed.load(), dropped.load());
+    std::printf("served latency p50 %.1fms p99 %.1fms max %.1fms (bound %.0fms)\n",
+                p50, p99, percentile(latenciesMs, 1.0), bound);
+
+    // Every connection was served, answered 503 or closed
+    CHECK(served + shed.load() + dropped.load() == offered);
+    // Overload was real, and the workers kept at least half their capacity busy
+    CHECK(shed.load() > 0);
+    CHECK(served >= kWorkers * (kDuration / kServiceTime) / 2);
+    CHECK(p99 <= bound);
+
+    // A single slow shed thread cannot keep up, so the shed backlog hits its limit
+    CHECK(dropped.load() > 0);
+    CHECK(peakShedBacklog <= static_cast<size_t>(kShedLimit));
+    CHECK(stats["shed_dropped"].get<int>() == dropped.load());
+    CHECK(stats["shed_limit"].get<int>() == kShedLimit);
+    CHECK(stats["shed_backlog"].get<int>() == 0);
+
+    std::printf("worker_pool_overload_test: all checks passed\n");
+    return 0;
+}
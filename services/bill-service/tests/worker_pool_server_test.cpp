@@ -0,0 +1,162 @@
+// Runs a WorkerPoolServer with one worker and a one-slot queue on loopback,
+// with the same pre-routing 503 as main.cpp. With the worker busy and the
+// queue full, a request is shed and answered 503 with Retry-After; a shed
+// client that sends nothing is closed after the shed timeout; and with the
+// shed thread and shed backlog both taken, a connection is closed unread.
+// Exits non-zero on the first failed check.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <httplib.h>
+#include "test_support.h"
+#include "worker_pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kShedTimeoutMs = 2000;
+
+// A connection that never sends a request
+static int connectSilent(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(fd >= 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    return fd;
+}
+
+// Blocks while the handler for /slow is held
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        opened_.wait(lock, [this] { return open_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        opened_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable opened_;
+    bool open_ = false;
+};
+
+int main() {
+    setenv("HTTP_WORKER_THREADS", "1", 1);
+    setenv("HTTP_QUEUE_MAX", "1", 1);
+    setenv("HTTP_QUEUE_DEADLINE_MS", "10000", 1);
+    setenv("HTTP_RETRY_AFTER", "3", 1);
+    setenv("HTTP_SHED_THREADS", "1", 1);
+    setenv("HTTP_SHED_QUEUE_MAX", "1", 1);
+    setenv("HTTP_SHED_TIMEOUT_MS", std::to_string(kShedTimeoutMs).c_str(), 1);
+
+    auto pool = std::make_shared<WorkerPool>();
+    WorkerPoolServer server(pool);
+    Gate gate;
+
+    server.set_pre_routing_handler([pool](const httplib::Request&, httplib::Response& res) {
+        if (WorkerPool::isShedding()) {
+            pool->writeOverloadResponse(res);
+            return httplib::Server::HandlerResponse::Handled;
+        }
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+    server.Get("/slow", [&gate](const httplib::Request&, httplib::Response& res) {
+        gate.wait();
+        res.set_content("slow", "text/plain");
+    });
+    server.Get("/fast", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content("fast", "text/plain");
+    });
+
+    int port = server.bind_to_any_port("127.0.0.1");
+    CHECK(port > 0);
+    std::thread listener([&server] { server.listen_after_bind(); });
+    while (!server.is_running()) {
+        std::this_thread::yield();
+    }
+
+    auto stat = [&pool](const char* name) { return pool->getStats()[name].get<size_t>(); };
+
+    // One request holds the worker, the next fills the queue
+    int slowStatus[2] = {0, 0};
+    std::thread slow[2];
+    for (int i = 0; i < 2; ++i) {
+        slow[i] = std::thread([&slowStatus, port, i] {
+            httplib::Client client("127.0.0.1", port);
+            auto res = client.Get("/slow");
+            slowStatus[i] = res ? res->status : -1;
+        });
+        CHECK(eventually([&] { return stat("busy") + stat("queue_depth") == static_cast<size_t>(i + 1); }));
+    }
+
+    // Shed: answered by the pre-routing handler on the shed thread
+    {
+        httplib::Client client("127.0.0.1", port);
+        auto res = client.Get("/fast");
+        CHECK(res);
+        CHECK(res->status == 503);
+        CHECK(res->get_header_value("Retry-After") == "3");
+        CHECK(res->get_header_value("Connection") == "close");
+        CHECK(stat("shed_full") == 1);
+    }
+
+    // A silent shed client holds the shed thread until the shed timeout...
+    auto heldAt = Clock::now();
+    int silent = connectSilent(port);
+    CHECK(eventually([&] { return stat("shed_full") == 2 && stat("shed_backlog") == 0; }));
+    // ...a second one waits in the shed backlog...
+    int waiting = connectSilent(port);
+    CHECK(eventually([&] { return stat("shed_backlog") == 1; }));
+
+    // ...so the next connection is closed without a response
+    {
+        httplib::Client client("127.0.0.1", port);
+        auto res = client.Get("/fast");
+        CHECK(!res);
+        CHECK(stat("shed_dropped") == 1);
+    }
+
+    // The silent client is closed once the shed timeout has passed, not held
+    // for the keep-alive timeout
+    struct timeval timeout = {5, 0};
+    setsockopt(silent, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char byte;
+    CHECK(::recv(silent, &byte, 1, 0) == 0);
+    auto held = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - heldAt);
+    CHECK(held.count() < kShedTimeoutMs + 1500);
+    ::close(silent);
+    ::close(waiting);
+
+    // The requests that got a worker or a queue slot are still served
+    gate.open();
+    for (auto& thread : slow) {
+        thread.join();
+    }
+    CHECK(slowStatus[0] == 200);
+    CHECK(slowStatus[1] == 200);
+    CHECK(stat("accepted") == 2);
+
+    server.stop();
+    listener.join();
+
+    std::printf("worker_pool_server_test: all checks passed\n");
+    return 0;
+}